@@ -207,6 +207,9 @@ namespace os
         ///< Abort @ref Serial::transfer()
         abort_transfer = (0x1AUL << CONFIG_Pos),
 
+        ///< Next @ref Serial::receive() is circular (optional)
+        enable_rx_circular = (0x1BUL << CONFIG_Pos),
+
         ///< Disable Transmitter
         disable_tx = (0x25UL << CONFIG_Pos),
 
@@ -432,6 +435,9 @@ namespace os
 
         ///< RI  state changed (optional)
         ri = (1UL << 13),
+
+        ///< Circular receive reached half of the buffer (optional)
+        receive_half_complete = (1UL << 14),
       };
 
       // ====================================================================
@@ -511,6 +517,11 @@ namespace os
 
         ///< Signal RI change event.
         bool event_ri :1;
+
+        // Extensions, not present in ARM CMSIS.
+
+        ///< supports circular receive, with half complete events.
+        bool receive_circular :1;
       };
 
 #pragma GCC diagnostic pop
@@ -579,6 +590,13 @@ namespace os
        * @param [out] data  Pointer to buffer for data to receive from USART receiver
        * @param [in] num   Number of data items to receive
        * @return      Execution status
+       * @details
+       * After `Control::enable_rx_circular`, the receiver does not
+       * stop at the end of the buffer, it continues from the
+       * beginning, until aborted; the `receive_half_complete` and
+       * `receive_complete` events are signalled at the middle and
+       * at the end of the buffer, and `get_rx_count()` returns the
+       * position in the buffer.
        */
       return_t
       receive (void* data, std::size_t num) noexcept;
@@ -603,6 +621,9 @@ namespace os
       /**
        * @brief       Get received bytes count.
        * @return      number of bytes received
+       * @details
+       * In circular mode, this is the position in the buffer,
+       * which returns to 0 when the end is reached.
        */
       std::size_t
       get_rx_count (void) noexcept;
@@ -32,8 +32,11 @@
 
 // ----------------------------------------------------------------------------
 
+#include <atomic>
+#include <cassert>
 #include <cstdint>
 #include <cstddef>
+#include <cstring>
 
 // ----------------------------------------------------------------------------
 
@@ -211,6 +214,178 @@ namespace os
      */
     using circular_buffer_bytes = circular_buffer<uint8_t>;
 
+    // ========================================================================
+
+    /**
+     * @brief Lock free single producer, single consumer circular
+     *  buffer class template.
+     * @headerfile circular-buffer.h <cmsis-plus/posix-driver/circular-buffer.h>
+     * @ingroup cmsis-plus-posix-io-utils
+     * @details
+     * Same interface as `circular_buffer`, but one context (for
+     * example an interrupt) can add data at the back, while another
+     * one (for example a thread) removes data from the front,
+     * without critical sections.
+     *
+     * The positions are counters that only grow, and wrap at
+     * the size of `std::size_t`, so the length is always their
+     * difference; each is written by a single side, with
+     * release semantics, after the data was accessed.
+     *
+     * The size must be a power of two, to index the storage
+     * with a mask.
+     *
+     * The producer functions are `push_back()`, `advance_back()`
+     * and `back_contiguous_buffer()`; the consumer functions are
+     * `pop_front()`, `advance_front()` and `front_contiguous_buffer()`.
+     * The others can be called from any side; `clear()` only
+     * when neither side is active.
+     */
+    template<typename T>
+      class circular_buffer_spsc
+      {
+        // --------------------------------------------------------------------
+
+      public:
+
+        /**
+         * @brief Standard type definition.
+         */
+        using value_type = T;
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+      public:
+
+        circular_buffer_spsc (value_type* buf, std::size_t size,
+                              std::size_t high_water_mark,
+                              std::size_t low_water_mark = 0);
+
+        circular_buffer_spsc (value_type* buf, std::size_t size);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        circular_buffer_spsc (const circular_buffer_spsc&) = delete;
+        circular_buffer_spsc (circular_buffer_spsc&&) = delete;
+        circular_buffer_spsc&
+        operator= (const circular_buffer_spsc&) = delete;
+        circular_buffer_spsc&
+        operator= (circular_buffer_spsc&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        ~circular_buffer_spsc () = default;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+      public:
+
+        void
+        clear (void);
+
+        // Insert elements to the back of the buffer (producer).
+        std::size_t
+        push_back (value_type v);
+
+        std::size_t
+        push_back (const value_type* buf, std::size_t count);
+
+        std::size_t
+        advance_back (std::size_t count);
+
+        std::size_t
+        back_contiguous_buffer (value_type** ppbuf);
+
+        // Retrieve elements from the front of the buffer (consumer).
+        std::size_t
+        pop_front (value_type* buf);
+
+        std::size_t
+        pop_front (value_type* buf, std::size_t size);
+
+        std::size_t
+        advance_front (std::size_t count);
+
+        std::size_t
+        front_contiguous_buffer (value_type** ppbuf);
+
+        bool
+        empty (void) const;
+
+        bool
+        full (void) const;
+
+        bool
+        above_high_water_mark (void) const;
+
+        bool
+        below_high_water_mark (void) const;
+
+        bool
+        above_low_water_mark (void) const;
+
+        bool
+        below_low_water_mark (void) const;
+
+        std::size_t
+        length (void) const;
+
+        std::size_t
+        size (void) const;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+      private:
+
+        /**
+         * @cond ignore
+         */
+
+        value_type* const buf_;
+        std::size_t const mask_;
+        std::size_t const high_water_mark_;
+        std::size_t const low_water_mark_;
+
+        // Total number of elements added; written by the producer.
+        std::atomic<std::size_t> back_
+          { 0 };
+
+        // Total number of elements removed; written by the consumer.
+        std::atomic<std::size_t> front_
+          { 0 };
+
+        /**
+         * @endcond
+         */
+      };
+
+    /**
+     * @brief Lock free single producer, single consumer circular
+     *  buffer of bytes.
+     * @headerfile circular-buffer.h <cmsis-plus/posix-driver/circular-buffer.h>
+     * @ingroup cmsis-plus-posix-io-utils
+     */
+    using circular_buffer_spsc_bytes = circular_buffer_spsc<uint8_t>;
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
@@ -566,6 +741,252 @@ namespace os
                            high_water_mark_, low_water_mark_);
       }
 
+
+    // ========================================================================
+
+    template<typename T>
+      circular_buffer_spsc<T>::circular_buffer_spsc (
+          value_type* buf, std::size_t siz, std::size_t high_water_mark,
+          std::size_t low_water_mark) :
+          buf_ (buf), //
+          mask_ (siz - 1), //
+          high_water_mark_ (high_water_mark <= siz ? high_water_mark : siz), //
+          low_water_mark_ (low_water_mark)
+      {
+        assert ((siz != 0) && ((siz & (siz - 1)) == 0));
+        assert (low_water_mark_ <= high_water_mark_);
+      }
+
+    template<typename T>
+      circular_buffer_spsc<T>::circular_buffer_spsc (value_type* buf,
+                                                     std::size_t siz) :
+          circular_buffer_spsc
+            { buf, siz, siz, 0 }
+      {
+        ;
+      }
+
+    // ------------------------------------------------------------------------
+
+    template<typename T>
+      void
+      circular_buffer_spsc<T>::clear (void)
+      {
+        back_.store (0, std::memory_order_relaxed);
+        front_.store (0, std::memory_order_relaxed);
+      }
+
+    template<typename T>
+      inline std::size_t
+      circular_buffer_spsc<T>::length (void) const
+      {
+        // Read the front first, it cannot pass the back.
+        std::size_t front = front_.load (std::memory_order_acquire);
+        return back_.load (std::memory_order_acquire) - front;
+      }
+
+    template<typename T>
+      inline std::size_t
+      circular_buffer_spsc<T>::size (void) const
+      {
+        return mask_ + 1;
+      }
+
+    template<typename T>
+      inline bool
+      circular_buffer_spsc<T>::empty (void) const
+      {
+        return (length () == 0);
+      }
+
+    template<typename T>
+      inline bool
+      circular_buffer_spsc<T>::full (void) const
+      {
+        return (length () >= size ());
+      }
+
+    template<typename T>
+      inline bool
+      circular_buffer_spsc<T>::above_high_water_mark (void) const
+      {
+        // Allow for water mark to be size.
+        return (length () >= high_water_mark_);
+      }
+
+    template<typename T>
+      inline bool
+      circular_buffer_spsc<T>::below_high_water_mark (void) const
+      {
+        return !above_high_water_mark ();
+      }
+
+    template<typename T>
+      inline bool
+      circular_buffer_spsc<T>::above_low_water_mark (void) const
+      {
+        return !below_low_water_mark ();
+      }
+
+    template<typename T>
+      inline bool
+      circular_buffer_spsc<T>::below_low_water_mark (void) const
+      {
+        // Allow for water mark to be 0.
+        return (length () <= low_water_mark_);
+      }
+
+    // ------------------------------------------------------------------------
+
+    template<typename T>
+      std::size_t
+      circular_buffer_spsc<T>::push_back (value_type v)
+      {
+        std::size_t back = back_.load (std::memory_order_relaxed);
+        if (back - front_.load (std::memory_order_acquire) > mask_)
+          {
+            return 0; // Full.
+          }
+
+        buf_[back & mask_] = v;
+        back_.store (back + 1, std::memory_order_release);
+        return 1;
+      }
+
+    // Return the actual number of elements, if not enough space for all.
+    template<typename T>
+      std::size_t
+      circular_buffer_spsc<T>::push_back (const value_type* buf,
+                                          std::size_t count)
+      {
+        assert (buf != nullptr);
+
+        std::size_t back = back_.load (std::memory_order_relaxed);
+        std::size_t space = size ()
+            - (back - front_.load (std::memory_order_acquire));
+        std::size_t len = (count < space) ? count : space;
+        if (len == 0)
+          {
+            return 0;
+          }
+
+        std::size_t pos = back & mask_;
+        std::size_t first = size () - pos;
+        if (first > len)
+          {
+            first = len;
+          }
+        std::memcpy (buf_ + pos, buf, first * sizeof(value_type));
+        std::memcpy (buf_, buf + first, (len - first) * sizeof(value_type));
+
+        back_.store (back + len, std::memory_order_release);
+        return len;
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer_spsc<T>::advance_back (std::size_t count)
+      {
+        std::size_t back = back_.load (std::memory_order_relaxed);
+        std::size_t space = size ()
+            - (back - front_.load (std::memory_order_acquire));
+        std::size_t adjust = (count < space) ? count : space;
+
+        back_.store (back + adjust, std::memory_order_release);
+        return adjust;
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer_spsc<T>::back_contiguous_buffer (value_type** ppbuf)
+      {
+        assert (ppbuf != nullptr);
+
+        std::size_t back = back_.load (std::memory_order_relaxed);
+        std::size_t space = size ()
+            - (back - front_.load (std::memory_order_acquire));
+        std::size_t pos = back & mask_;
+
+        *ppbuf = buf_ + pos;
+
+        std::size_t len = size () - pos;
+        return (len < space) ? len : space;
+      }
+
+    // ------------------------------------------------------------------------
+
+    template<typename T>
+      std::size_t
+      circular_buffer_spsc<T>::pop_front (value_type* buf)
+      {
+        assert (buf != nullptr);
+
+        std::size_t front = front_.load (std::memory_order_relaxed);
+        if (back_.load (std::memory_order_acquire) == front)
+          {
+            return 0; // Empty.
+          }
+
+        *buf = buf_[front & mask_];
+        front_.store (front + 1, std::memory_order_release);
+        return 1;
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer_spsc<T>::pop_front (value_type* buf, std::size_t siz)
+      {
+        assert (buf != nullptr);
+
+        std::size_t front = front_.load (std::memory_order_relaxed);
+        std::size_t avail = back_.load (std::memory_order_acquire) - front;
+        std::size_t len = (siz < avail) ? siz : avail;
+        if (len == 0)
+          {
+            return 0;
+          }
+
+        std::size_t pos = front & mask_;
+        std::size_t first = size () - pos;
+        if (first > len)
+          {
+            first = len;
+          }
+        std::memcpy (buf, buf_ + pos, first * sizeof(value_type));
+        std::memcpy (buf + first, buf_, (len - first) * sizeof(value_type));
+
+        front_.store (front + len, std::memory_order_release);
+        return len;
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer_spsc<T>::advance_front (std::size_t count)
+      {
+        std::size_t front = front_.load (std::memory_order_relaxed);
+        std::size_t avail = back_.load (std::memory_order_acquire) - front;
+        std::size_t adjust = (count < avail) ? count : avail;
+
+        front_.store (front + adjust, std::memory_order_release);
+        return adjust;
+      }
+
+    template<typename T>
+      std::size_t
+      circular_buffer_spsc<T>::front_contiguous_buffer (value_type** ppbuf)
+      {
+        assert (ppbuf != nullptr);
+
+        std::size_t front = front_.load (std::memory_order_relaxed);
+        std::size_t avail = back_.load (std::memory_order_acquire) - front;
+        std::size_t pos = front & mask_;
+
+        *ppbuf = buf_ + pos;
+
+        std::size_t len = size () - pos;
+        return (len < avail) ? len : avail;
+      }
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
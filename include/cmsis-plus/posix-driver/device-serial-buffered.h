@@ -34,10 +34,19 @@
 
 #include <cmsis-plus/rtos/os.h>
 
-#include <cmsis-plus/posix-io/device-char.h>
+#include <cmsis-plus/posix-io/tty.h>
 #include <cmsis-plus/posix-driver/circular-buffer.h>
+#include <cmsis-plus/posix-driver/frame-codec.h>
 #include <cmsis-plus/driver/serial.h>
 
+#include <cmsis-plus/posix/sys/uio.h>
+#include <cmsis-plus/posix/termios.h>
+
+#include <fcntl.h>
+#include <cstring>
+#include <cassert>
+#include <cerrno>
+
 // ----------------------------------------------------------------------------
 
 // TODO: (multiline)
@@ -55,12 +64,18 @@ namespace os
 #pragma GCC diagnostic ignored "-Wpadded"
 
     /**
-     * @brief Buffered serial driver class template.
-     * @headerfile circular-buffer.h <cmsis-plus/posix-driver/circular-buffer.h>
+     * @brief Buffered serial driver implementation class template.
+     * @headerfile device-serial-buffered.h <cmsis-plus/posix-driver/device-serial-buffered.h>
      * @ingroup cmsis-plus-posix-io-driver
+     * @details
+     * A terminal device on top of a CMSIS-like serial driver
+     * (usart or usb cdc acm), with a receive buffer and an
+     * optional transmit buffer, both shared with the driver
+     * interrupts, which are excluded with the `CS` critical
+     * section.
      */
     template<typename CS>
-      class device_serial_buffered : public os::posix::device_char
+      class device_serial_buffered_impl : public tty_impl
       {
         using critical_section = CS;
 
@@ -73,29 +88,91 @@ namespace os
 
       public:
 
-        device_serial_buffered (const char* device_name,
-                                os::driver::Serial* driver,
-                                os::posix::circular_buffer_bytes* rx_buf,
-                                os::posix::circular_buffer_bytes* tx_buf);
+        device_serial_buffered_impl (
+            os::driver::Serial* driver,
+            os::posix::circular_buffer_bytes* rx_buf,
+            os::posix::circular_buffer_bytes* tx_buf);
 
         /**
          * @cond ignore
          */
 
         // The rule of five.
-        device_serial_buffered (const device_serial_buffered&) = delete;
-        device_serial_buffered (device_serial_buffered&&) = delete;
-        device_serial_buffered&
-        operator= (const device_serial_buffered&) = delete;
-        device_serial_buffered&
-        operator= (device_serial_buffered&&) = delete;
+        device_serial_buffered_impl (const device_serial_buffered_impl&) =
+            delete;
+        device_serial_buffered_impl (device_serial_buffered_impl&&) = delete;
+        device_serial_buffered_impl&
+        operator= (const device_serial_buffered_impl&) = delete;
+        device_serial_buffered_impl&
+        operator= (device_serial_buffered_impl&&) = delete;
 
         /**
          * @endcond
          */
 
         virtual
-        ~device_serial_buffered ();
+        ~device_serial_buffered_impl ();
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+      public:
+
+        /**
+         * @brief Get the received bytes, without copying them.
+         * @param [out] iov Array of two elements, set to the segments
+         *  of the receive buffer before and after the wrap; the
+         *  second one may be empty.
+         * @return The number of bytes in both segments, or -1 if
+         *  an error occurred.
+         * @details
+         * Wait for at least one byte, like `read()`. The bytes are
+         * not removed from the buffer, they must be released
+         * with `rx_consume()`.
+         *
+         * If the buffer gets full, received bytes are lost; keep up
+         * with the data rate when parsing in place. With a circular
+         * receiver the oldest bytes are overwritten, including
+         * peeked ones, which is reported by `rx_consume()`.
+         */
+        ssize_t
+        rx_peek (struct iovec* iov);
+
+        /**
+         * @brief Release bytes from the front of the receive buffer.
+         * @param [in] count Number of bytes.
+         * @retval 0 if successful.
+         * @retval -1 if there are fewer bytes in the buffer (`EINVAL`),
+         *  or if some of the bytes returned by `rx_peek()` were
+         *  overwritten by the receiver meanwhile (`EIO`).
+         * @details
+         * The overwritten bytes were already dropped, only the
+         * rest of the `count` bytes are released.
+         */
+        int
+        rx_consume (std::size_t count);
+
+        /**
+         * @brief Decode the received bytes into frames.
+         * @param [in] codec Reference to codec.
+         * @return The number of frames passed to the codec handler
+         *  (0 if only a partial frame was received), or -1 if
+         *  an error occurred.
+         * @details
+         * Wait for bytes like `rx_peek()`, decode them directly
+         * from the receive buffer, then release them. If the
+         * receiver overwrote some of them meanwhile, the decoded
+         * frames may be corrupted and -1 is returned (`EIO`).
+         */
+        ssize_t
+        rx_decode (frame_codec& codec);
 
         /**
          * @}
@@ -113,7 +190,7 @@ namespace os
         // interrupt context.
 
         static void
-        signal_event (device_serial_buffered* object, uint32_t event);
+        signal_event (device_serial_buffered_impl* object, uint32_t event);
 
         /**
          * @}
@@ -125,7 +202,9 @@ namespace os
          * @{
          */
 
-      protected:
+      public:
+
+        // Implementations
 
         virtual int
         do_vopen (const char* path, int oflag, std::va_list args) override;
@@ -139,23 +218,73 @@ namespace os
         virtual ssize_t
         do_write (const void* buf, std::size_t nbyte) override;
 
+        /**
+         * @brief Get or set the file status flags.
+         * @details
+         * `F_GETFL` and `F_SETFL` are supported; only `O_NONBLOCK`
+         * can be changed. In non-blocking mode, reads and writes
+         * that would wait fail with `EAGAIN`; writes without a
+         * transmit buffer still wait for the transfer to complete.
+         */
+        virtual int
+        do_vfcntl (int cmd, std::va_list args) override;
+
 #if 0
         virtual ssize_t
         do_writev (const struct iovec* iov, int iovcnt) override;
+#endif
 
         virtual int
         do_vioctl (int request, std::va_list args) override;
 
-        virtual int
-        do_vfcntl (int cmd, va_list args) override;
-#endif
-
         virtual bool
         do_is_opened (void) override;
 
         virtual bool
         do_is_connected (void) override;
 
+        virtual int
+        do_poll (int events) override;
+
+        /**
+         * @brief Read from the source directly into the transmit buffer.
+         * @details
+         * Without a transmit buffer, the generic transfer is used.
+         */
+        virtual ssize_t
+        do_sendfile (io& in, off_t* offset, std::size_t count) override;
+
+        /**
+         * @brief Get the read parameters.
+         * @details
+         * Only `c_cc[VMIN]` and `c_cc[VTIME]` are set.
+         */
+        virtual int
+        do_tcgetattr (struct termios* ptio) override;
+
+        /**
+         * @brief Set the read parameters.
+         * @details
+         * Only `c_cc[VMIN]` and `c_cc[VTIME]` (tenths of a second)
+         * are used, the changes are immediate. Reads behave like
+         * a terminal in non canonical mode; the default is `VMIN=1`,
+         * `VTIME=0`, i.e. return as soon as some bytes are available.
+         */
+        virtual int
+        do_tcsetattr (int options, const struct termios* ptio) override;
+
+        virtual int
+        do_tcflush (int queue_selector) override;
+
+        virtual int
+        do_tcsendbreak (int duration) override;
+
+        /**
+         * @brief Wait for the transmit buffer to be sent.
+         */
+        virtual int
+        do_tcdrain (void) override;
+
         /**
          * @}
          */
@@ -181,7 +310,16 @@ namespace os
         os::posix::circular_buffer_bytes* tx_buf_ = nullptr;
 
         std::size_t rx_count_ = 0; //
+        // Bytes dropped on overflow, total and at the last rx_peek().
+        std::size_t rx_dropped_ = 0;
+        std::size_t rx_peeked_ = 0;
         bool volatile tx_busy_ = false;
+        bool rx_circular_ = false;
+        // The end of the buffer was passed before its event.
+        bool rx_wrapped_ = false;
+        bool volatile nonblock_ = false;
+        cc_t rx_min_ = 1;
+        cc_t rx_time_ = 0;
         bool volatile is_connected_ = false;
         bool volatile is_opened_ = false;
         // Padding!
@@ -194,6 +332,15 @@ namespace os
 
 #pragma GCC diagnostic pop
 
+    /**
+     * @brief Buffered serial driver class template.
+     * @headerfile device-serial-buffered.h <cmsis-plus/posix-driver/device-serial-buffered.h>
+     * @ingroup cmsis-plus-posix-io-driver
+     */
+    template<typename CS>
+      using device_serial_buffered =
+      tty_implementable<device_serial_buffered_impl<CS>>;
+
   } /* namespace posix */
 } /* namespace os */
 
@@ -206,18 +353,16 @@ namespace os
     // ------------------------------------------------------------------------
 
     template<typename CS>
-      device_serial_buffered<CS>::device_serial_buffered (
-          const char* device_name, //
+      device_serial_buffered_impl<CS>::device_serial_buffered_impl (
           os::driver::Serial* driver, os::posix::circular_buffer_bytes* rx_buf,
           os::posix::circular_buffer_bytes* tx_buf) :
           //
-          device_char (device_name), // Construct parent.
           driver_ (driver), //
           rx_buf_ (rx_buf), //
           tx_buf_ (tx_buf) //
       {
-        trace::printf ("%s(\"%s\",%p,%p,%p) %p\n", __func__, device_name,
-                       driver, rx_buf, tx_buf, this);
+        trace::printf ("%s(%p,%p,%p) %p\n", __func__, driver, rx_buf, tx_buf,
+                       this);
 
         assert (rx_buf != nullptr);
 
@@ -228,7 +373,7 @@ namespace os
       }
 
     template<typename CS>
-      device_serial_buffered<CS>::~device_serial_buffered ()
+      device_serial_buffered_impl<CS>::~device_serial_buffered_impl ()
       {
         trace::printf ("%s() %p\n", __func__, this);
 
@@ -244,8 +389,8 @@ namespace os
 
     template<typename CS>
       int
-      device_serial_buffered<CS>::do_vopen (const char* path, int oflag,
-                                            std::va_list args)
+      device_serial_buffered_impl<CS>::do_vopen (const char* path, int oflag,
+                                                 std::va_list args)
       {
         if (is_opened_)
           {
@@ -263,10 +408,14 @@ namespace os
             tx_sem_.reset ();
 
             is_opened_ = true;
+            nonblock_ = ((oflag & O_NONBLOCK) != 0);
 
             // Clear buffers.
             rx_buf_->clear ();
             rx_count_ = 0;
+            rx_dropped_ = 0;
+            rx_peeked_ = 0;
+            rx_wrapped_ = false;
 
             if (tx_buf_ != nullptr)
               {
@@ -330,6 +479,13 @@ namespace os
         uint8_t* pbuf;
         std::size_t nbyte = rx_buf_->back_contiguous_buffer (&pbuf);
 
+        // If possible, receive continuously in the entire buffer
+        // (it was cleared above), without gaps to re-arm it.
+        rx_circular_ = capa.receive_circular
+            && (driver_->control (
+                os::driver::serial::Control::enable_rx_circular)
+                == os::driver::RETURN_OK);
+
         result = driver_->receive (pbuf, nbyte);
         if (result != os::driver::RETURN_OK)
           {
@@ -345,21 +501,54 @@ namespace os
 
     template<typename CS>
       bool
-      device_serial_buffered<CS>::do_is_opened (void)
+      device_serial_buffered_impl<CS>::do_is_opened (void)
       {
         return is_opened_;
       }
 
     template<typename CS>
       bool
-      device_serial_buffered<CS>::do_is_connected (void)
+      device_serial_buffered_impl<CS>::do_is_connected (void)
       {
         return is_connected_;
       }
 
     template<typename CS>
       int
-      device_serial_buffered<CS>::do_close (void)
+      device_serial_buffered_impl<CS>::do_poll (int events)
+      {
+        if (!is_connected_)
+          {
+            return POLLHUP;
+          }
+
+        int ret = 0;
+        if ((events & (POLLIN | POLLRDNORM)) && !rx_buf_->empty ())
+          {
+            ret |= (POLLIN | POLLRDNORM);
+          }
+        if (events & (POLLOUT | POLLWRNORM))
+          {
+            bool writable;
+            if (tx_buf_ != nullptr)
+              {
+                writable = !tx_buf_->full ();
+              }
+            else
+              {
+                writable = !driver_->get_status ().is_tx_busy ();
+              }
+            if (writable)
+              {
+                ret |= (POLLOUT | POLLWRNORM);
+              }
+          }
+        return ret;
+      }
+
+    template<typename CS>
+      int
+      device_serial_buffered_impl<CS>::do_close (void)
       {
 
         if (is_connected_)
@@ -406,28 +595,97 @@ namespace os
 
     template<typename CS>
       ssize_t
-      device_serial_buffered<CS>::do_read (void* buf, std::size_t nbyte)
+      device_serial_buffered_impl<CS>::do_read (void* buf, std::size_t nbyte)
       {
         // TODO: implement cases when 0 must be returned
-        // (disconnects, timeouts).
+        // (disconnects).
+        uint8_t* p = static_cast<uint8_t*> (buf);
+        std::size_t min = (rx_min_ < nbyte) ? rx_min_ : nbyte;
+        std::size_t total = 0;
+        bool timed_out = false;
         while (true)
           {
-            std::size_t count;
               {
                 // ----- Enter critical section -------------------------------
                 critical_section cs;
 
-                count = rx_buf_->pop_front (static_cast<uint8_t*> (buf), nbyte);
+                total += rx_buf_->pop_front (p + total, nbyte - total);
                 // ----- Exit critical section --------------------------------
               }
-            if (count > 0)
+            if ((total > 0 && total >= min) || timed_out)
               {
                 // Actual number of chars received in buffer.
-                return count;
+                return static_cast<ssize_t> (total);
               }
-            if (!is_connected_)
+            if (nonblock_ || !is_connected_)
               {
-                errno = EIO;
+                if (total > 0)
+                  {
+                    return static_cast<ssize_t> (total);
+                  }
+                errno = nonblock_ ? EAGAIN : EIO;
+                return -1;
+              }
+            if (rx_time_ == 0)
+              {
+                if (rx_min_ == 0)
+                  {
+                    return 0; // Polling.
+                  }
+                // Block and wait for bytes to arrive.
+                rx_sem_.wait ();
+              }
+            else if (rx_min_ == 0 || total > 0)
+              {
+                // Wait for the first byte (VMIN=0) or for the next
+                // one (inter-byte timer), at most VTIME tenths of second.
+                os::rtos::result_t res = rx_sem_.timed_wait (
+                    os::rtos::clock_systick::ticks_cast (
+                        static_cast<uint32_t> (rx_time_) * 100000u));
+                timed_out = (res == ETIMEDOUT);
+              }
+            else
+              {
+                // The inter-byte timer starts after the first byte.
+                rx_sem_.wait ();
+              }
+          }
+      }
+
+    template<typename CS>
+      ssize_t
+      device_serial_buffered_impl<CS>::rx_peek (struct iovec* iov)
+      {
+        assert (iov != nullptr);
+
+        while (true)
+          {
+            uint8_t* pbuf;
+            std::size_t len;
+            std::size_t count;
+              {
+                // ----- Enter critical section -------------------------------
+                critical_section cs;
+
+                len = rx_buf_->length ();
+                count = rx_buf_->front_contiguous_buffer (&pbuf);
+                rx_peeked_ = rx_dropped_;
+                // ----- Exit critical section --------------------------------
+              }
+            if (len > 0)
+              {
+                iov[0].iov_base = pbuf;
+                iov[0].iov_len = count;
+
+                // After the wrap, the rest is at the beginning.
+                iov[1].iov_base = const_cast<uint8_t*> (&(*rx_buf_)[0]);
+                iov[1].iov_len = len - count;
+
+                return static_cast<ssize_t> (len);
+              }
+            if (nonblock_ || !is_connected_)
+              {
+                errno = nonblock_ ? EAGAIN : EIO;
                 return -1;
               }
             // Block and wait for bytes to arrive.
@@ -435,9 +693,129 @@ namespace os
           }
       }
 
+    template<typename CS>
+      int
+      device_serial_buffered_impl<CS>::rx_consume (std::size_t count)
+      {
+        // ----- Enter critical section ---------------------------------------
+        critical_section cs;
+
+        std::size_t dropped = rx_dropped_ - rx_peeked_;
+        rx_peeked_ = rx_dropped_;
+        if (dropped > 0)
+          {
+            // The front was moved by an overflow after rx_peek().
+            if (count > dropped)
+              {
+                rx_buf_->advance_front (count - dropped);
+              }
+            errno = EIO;
+            return -1;
+          }
+
+        if (count > rx_buf_->length ())
+          {
+            errno = EINVAL;
+            return -1;
+          }
+        rx_buf_->advance_front (count);
+
+        return 0;
+        // ----- Exit critical section ----------------------------------------
+      }
+
+    template<typename CS>
+      ssize_t
+      device_serial_buffered_impl<CS>::rx_decode (frame_codec& codec)
+      {
+        struct iovec iov[2];
+        ssize_t len = rx_peek (iov);
+        if (len < 0)
+          {
+            return -1;
+          }
+
+        std::size_t frames = codec.decode (iov, 2);
+        if (rx_consume (static_cast<std::size_t> (len)) < 0)
+          {
+            return -1;
+          }
+
+        return static_cast<ssize_t> (frames);
+      }
+
+    template<typename CS>
+      int
+      device_serial_buffered_impl<CS>::do_tcgetattr (struct termios* ptio)
+      {
+        assert (ptio != nullptr);
+
+        std::memset (ptio, 0, sizeof(struct termios));
+        ptio->c_cc[VMIN] = rx_min_;
+        ptio->c_cc[VTIME] = rx_time_;
+
+        return 0;
+      }
+
+    template<typename CS>
+      int
+      device_serial_buffered_impl<CS>::do_tcsetattr (
+          int options, const struct termios* ptio)
+      {
+        assert (ptio != nullptr);
+
+        rx_min_ = ptio->c_cc[VMIN];
+        rx_time_ = ptio->c_cc[VTIME];
+
+        // Wake up a waiting read, to use the new values.
+        rx_sem_.post ();
+
+        return 0;
+      }
+
+    template<typename CS>
+      int
+      device_serial_buffered_impl<CS>::do_tcflush (int queue_selector)
+      {
+        errno = ENOSYS; // Not implemented
+        return -1;
+      }
+
+    template<typename CS>
+      int
+      device_serial_buffered_impl<CS>::do_tcsendbreak (int duration)
+      {
+        errno = ENOSYS; // Not implemented
+        return -1;
+      }
+
+    template<typename CS>
+      int
+      device_serial_buffered_impl<CS>::do_tcdrain (void)
+      {
+        if (tx_buf_ == nullptr)
+          {
+            // Writes return after the transfer completes.
+            return 0;
+          }
+
+        // TODO: what if flow control prevents this?
+        while (!tx_buf_->empty ())
+          {
+            if (!is_connected_)
+              {
+                errno = EIO;
+                return -1;
+              }
+            tx_sem_.wait ();
+          }
+        return 0;
+      }
+
     template<typename CS>
       ssize_t
-      device_serial_buffered<CS>::do_write (const void* buf, std::size_t nbyte)
+      device_serial_buffered_impl<CS>::do_write (const void* buf,
+                                                 std::size_t nbyte)
       {
         std::size_t count;
 
@@ -499,17 +877,17 @@ namespace os
 //                  }
                 if (count == nbyte)
                   {
-                    return nbyte;
+                    return static_cast<ssize_t> (nbyte);
                   }
 
-                if (!is_connected_)
+                if (!is_connected_ || nonblock_)
                   {
                     if (count > 0)
                       {
-                        return count;
+                        return static_cast<ssize_t> (count);
                       }
 
-                    errno = EIO;
+                    errno = nonblock_ ? EAGAIN : EIO;
                     return -1;
                   }
 
@@ -549,9 +927,16 @@ namespace os
                   {
                     break;
                   }
+                if (nonblock_)
+                  {
+                    errno = EAGAIN;
+                    return -1;
+                  }
                 tx_sem_.wait ();
               }
 
+            // The user buffer is used by the driver, so wait for the
+            // transfer to complete, even in non-blocking mode.
             if ((driver_->send (buf, nbyte)) == os::driver::RETURN_OK)
               {
                 for (;;)
@@ -573,54 +958,270 @@ namespace os
               }
             else
               {
-                count = -1;
                 errno = EIO;
+                return -1;
               }
           }
 
         // Actual number of bytes transmitted from buffer.
-        return count;
+        return static_cast<ssize_t> (count);
       }
 
-#if 0
     template<typename CS>
-    ssize_t
-    device_serial_buffered<CS>::do_writev (const struct iovec* iov, int iovcnt)
+      ssize_t
+      device_serial_buffered_impl<CS>::do_sendfile (io& in, off_t* offset,
+                                                    std::size_t count)
       {
-        errno = ENOSYS; // Not implemented
-        return -1;
+        if (tx_buf_ == nullptr)
+          {
+            errno = ENOSYS; // Use the generic transfer.
+            return -1;
+          }
+
+        std::size_t total = 0;
+        while (total < count)
+          {
+            uint8_t* pbuf;
+            std::size_t nb;
+              {
+                // ----- Enter critical section -------------------------------
+                critical_section cs;
+
+                nb = tx_buf_->back_contiguous_buffer (&pbuf);
+                // ----- Exit critical section --------------------------------
+              }
+
+            ssize_t nread = 0;
+            if (nb > 0)
+              {
+                if (nb > count - total)
+                  {
+                    nb = count - total;
+                  }
+
+                // Only the back is changed, the interrupt uses the front.
+                if (offset != nullptr)
+                  {
+                    nread = in.pread (pbuf, nb, *offset);
+                  }
+                else
+                  {
+                    nread = in.read (pbuf, nb);
+                  }
+                if (nread < 0)
+                  {
+                    if (total > 0)
+                      {
+                        break;
+                      }
+                    return -1;
+                  }
+
+                  {
+                    // ----- Enter critical section ---------------------------
+                    critical_section cs;
+
+                    tx_buf_->advance_back (static_cast<std::size_t> (nread));
+                    // ----- Exit critical section ----------------------------
+                  }
+                if (offset != nullptr)
+                  {
+                    *offset += nread;
+                  }
+                total += static_cast<std::size_t> (nread);
+              }
+
+            os::driver::serial::Status status;
+              {
+                // ----- Enter critical section -------------------------------
+                critical_section cs;
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Waggregate-return"
+                status = driver_->get_status ();
+#pragma GCC diagnostic pop
+
+                // ----- Exit critical section --------------------------------
+              }
+            if (!status.tx_busy)
+              {
+                uint8_t* pfront;
+                std::size_t nf;
+                  {
+                    // ----- Enter critical section ---------------------------
+                    critical_section cs;
+
+                    nf = tx_buf_->front_contiguous_buffer (&pfront);
+                    // ----- Exit critical section ----------------------------
+                  }
+                if (nf > 0)
+                  {
+                    if (driver_->send (pfront, nf) != os::driver::RETURN_OK)
+                      {
+                        errno = EIO;
+                        return -1;
+                      }
+                  }
+              }
+
+            if ((nb > 0) && (static_cast<std::size_t> (nread) < nb))
+              {
+                break; // Short read, no more data for now.
+              }
+
+            if (nb == 0)
+              {
+                if (!is_connected_ || nonblock_)
+                  {
+                    if (total > 0)
+                      {
+                        break;
+                      }
+                    errno = nonblock_ ? EAGAIN : EIO;
+                    return -1;
+                  }
+
+                // Block and wait for buffer to be freed.
+                tx_sem_.wait ();
+              }
+          }
+
+        return static_cast<ssize_t> (total);
       }
 
     template<typename CS>
-    int
-    device_serial_buffered<CS>::do_vioctl (int request, std::va_list args)
+      int
+      device_serial_buffered_impl<CS>::do_vfcntl (int cmd, std::va_list args)
+      {
+        switch (cmd)
+          {
+          case F_GETFL:
+            return O_RDWR | (nonblock_ ? O_NONBLOCK : 0);
+
+          case F_SETFL:
+            nonblock_ = ((va_arg(args, int) & O_NONBLOCK) != 0);
+            return 0;
+
+          default:
+            errno = EINVAL;
+            return -1;
+          }
+      }
+
+#if 0
+    template<typename CS>
+    ssize_t
+    device_serial_buffered_impl<CS>::do_writev (const struct iovec* iov,
+                                                int iovcnt)
       {
         errno = ENOSYS; // Not implemented
         return -1;
       }
+#endif
 
     template<typename CS>
-    int
-    device_serial_buffered<CS>::do_vfcntl (int cmd, std::va_list args)
+      int
+      device_serial_buffered_impl<CS>::do_vioctl (int request,
+                                                  std::va_list args)
       {
         errno = ENOSYS; // Not implemented
         return -1;
       }
-#endif
 
     // ------------------------------------------------------------------------
 
     template<typename CS>
       void
-      device_serial_buffered<CS>::signal_event (device_serial_buffered* object,
-                                                uint32_t event)
+      device_serial_buffered_impl<CS>::signal_event (
+          device_serial_buffered_impl* object, uint32_t event)
       {
         if (!object->is_opened_)
           {
             // After close(), ignore interrupts.
             return;
           }
-        if ((event
+        if (object->rx_circular_)
+          {
+            if ((event
+                & (os::driver::serial::Event::receive_half_complete
+                    | os::driver::serial::Event::receive_complete
+                    | os::driver::serial::Event::rx_framing_error
+                    | os::driver::serial::Event::rx_timeout)))
+              {
+                // The receiver continues from the beginning of the
+                // buffer by itself; only follow its position. The
+                // timeout (idle line) delivers partial data.
+                std::size_t size = object->rx_buf_->size ();
+                std::size_t pos = object->driver_->get_rx_count ();
+
+                // The position alone is ambiguous when it did not move
+                // back, so the end of the buffer is also identified by
+                // the `receive_complete` event, unless the position
+                // already passed it at a previous event.
+                bool wrapped = (pos < object->rx_count_);
+                if (event & os::driver::serial::Event::receive_complete)
+                  {
+                    if (object->rx_wrapped_)
+                      {
+                        object->rx_wrapped_ = wrapped;
+                      }
+                    else
+                      {
+                        wrapped = true;
+                      }
+                  }
+                else if (wrapped)
+                  {
+                    object->rx_wrapped_ = true;
+                  }
+
+                std::size_t count;
+                if (wrapped)
+                  {
+                    count = size - object->rx_count_ + pos;
+                  }
+                else
+                  {
+                    count = pos - object->rx_count_;
+                  }
+                object->rx_count_ = pos;
+                if (count > size)
+                  {
+                    // Overrun: the receiver went around the buffer
+                    // more than once, so only the last buffer is still
+                    // available, starting at the receiver position.
+                    // Drop all the old content and move both the front
+                    // and the back to the position, then mark the
+                    // buffer full.
+                    std::size_t length = object->rx_buf_->length ();
+                    object->rx_dropped_ += object->rx_buf_->advance_front (
+                        length) + count - size;
+                    object->rx_buf_->advance_back (count - size);
+                    object->rx_buf_->advance_front (count - size);
+                    object->rx_buf_->advance_back (size);
+                  }
+                else
+                  {
+                    // On overflow, the oldest bytes were overwritten;
+                    // drop them, to keep the back in sync with the
+                    // receiver, and count them for rx_consume().
+                    std::size_t space = size - object->rx_buf_->length ();
+                    if (count > space)
+                      {
+                        object->rx_dropped_ +=
+                            object->rx_buf_->advance_front (count - space);
+                      }
+                    object->rx_buf_->advance_back (count);
+                  }
+
+                if (count > 0)
+                  {
+                    object->rx_sem_.post ();
+                    object->notify_readiness ();
+                  }
+              }
+          }
+        else if ((event
             & (os::driver::serial::Event::receive_complete
                 | os::driver::serial::Event::rx_framing_error
                 | os::driver::serial::Event::rx_timeout)))
@@ -658,6 +1259,7 @@ namespace os
               {
                 // Immediately wake up, do not wait to reach any water mark.
                 object->rx_sem_.post ();
+                object->notify_readiness ();
               }
           }
         if (event & os::driver::serial::Event::tx_complete)
@@ -686,12 +1288,14 @@ namespace os
                   {
                     // Wake up thread, to come and send more bytes.
                     object->tx_sem_.post ();
+                    object->notify_readiness ();
                   }
               }
             else
               {
                 // No buffer, wake up the thread to return from write().
                 object->tx_sem_.post ();
+                object->notify_readiness ();
               }
           }
         if (event & os::driver::serial::Event::dcd)
@@ -713,6 +1317,9 @@ namespace os
 
                 // Cancel write.
                 object->tx_sem_.post ();
+
+                // Report the hang-up to poll()/select().
+                object->notify_readiness ();
               }
           }
         if (event & os::driver::serial::Event::cts)
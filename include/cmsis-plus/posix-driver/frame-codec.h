@@ -0,0 +1,545 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_DRIVER_FRAME_CODEC_H_
+#define CMSIS_PLUS_POSIX_DRIVER_FRAME_CODEC_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#include <cstddef>
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+struct iovec;
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Frame codec base class.
+     * @headerfile frame-codec.h <cmsis-plus/posix-driver/frame-codec.h>
+     * @ingroup cmsis-plus-posix-io-utils
+     * @details
+     * Split a stream of bytes received from a serial device into
+     * frames, and pass each frame to a handler.
+     *
+     * The bytes are processed in runs, not one by one; frames
+     * that do not need any change are passed in place, from the
+     * input, the others are assembled in the buffer given to
+     * the constructor.
+     *
+     * An optional check function (for example a CRC computed
+     * by a hardware unit) is called before the handler; frames
+     * that fail the check, that are malformed, or that do not fit
+     * in the buffer, are dropped and counted as errors.
+     */
+    class frame_codec
+    {
+      // ----------------------------------------------------------------------
+
+    public:
+
+      /**
+       * @brief Type of the function called with each frame.
+       * @details
+       * The frame is valid only during the call.
+       */
+      using handler_t = void (*) (void* arg, const uint8_t* frame,
+          std::size_t len);
+
+      /**
+       * @brief Type of the function that checks a frame.
+       * @return `true` if the frame is valid.
+       */
+      using check_t = bool (*) (void* arg, const uint8_t* frame,
+          std::size_t len);
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      frame_codec (uint8_t* buf, std::size_t size, handler_t handler,
+                   void* arg = nullptr);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      frame_codec (const frame_codec&) = delete;
+      frame_codec (frame_codec&&) = delete;
+      frame_codec&
+      operator= (const frame_codec&) = delete;
+      frame_codec&
+      operator= (frame_codec&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~frame_codec ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Decode received bytes.
+       * @param [in] data Pointer to bytes.
+       * @param [in] len Number of bytes.
+       * @return The number of frames passed to the handler.
+       * @details
+       * Partial frames are kept for the next call.
+       */
+      std::size_t
+      decode (const void* data, std::size_t len);
+
+      /**
+       * @brief Decode received bytes from several buffers.
+       * @param [in] iov Array of buffers, for example the segments
+       *  returned by `device_serial_buffered::rx_peek()`.
+       * @param [in] iovcnt Number of buffers.
+       * @return The number of frames passed to the handler.
+       */
+      std::size_t
+      decode (const struct iovec* iov, int iovcnt);
+
+      /**
+       * @brief Encode a frame.
+       * @param [in] data Pointer to frame.
+       * @param [in] len Length of frame.
+       * @param [out] buf Pointer to output buffer.
+       * @param [in] size Size of output buffer.
+       * @return The number of bytes in the output buffer, or 0 if
+       *  it is too small.
+       */
+      std::size_t
+      encode (const void* data, std::size_t len, void* buf,
+              std::size_t size) const;
+
+      /**
+       * @brief Set the function that checks the frames.
+       * @param [in] check Pointer to function, or `nullptr`.
+       * @param [in] arg Argument passed to function.
+       */
+      void
+      checker (check_t check, void* arg = nullptr);
+
+      /**
+       * @brief Drop the partial frame, if any.
+       */
+      void
+      reset (void);
+
+      /**
+       * @brief Get the number of dropped frames.
+       */
+      std::size_t
+      errors (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Private Member Functions
+       * @{
+       */
+
+    protected:
+
+      virtual std::size_t
+      do_decode (const uint8_t* data, std::size_t len) = 0;
+
+      virtual std::size_t
+      do_encode (const uint8_t* data, std::size_t len, uint8_t* buf,
+                 std::size_t size) const = 0;
+
+      virtual void
+      do_reset (void);
+
+      // Add bytes to the frame; on overflow the frame is marked bad.
+      void
+      append (const uint8_t* data, std::size_t len);
+
+      // End the frame in the buffer, or the given one (in place);
+      // return true if passed to the handler.
+      bool
+      finish (void);
+
+      bool
+      finish (const uint8_t* frame, std::size_t len);
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      uint8_t* buf_;
+      std::size_t size_;
+      std::size_t len_ = 0;
+
+      handler_t handler_;
+      void* handler_arg_;
+
+      check_t check_ = nullptr;
+      void* check_arg_ = nullptr;
+
+      std::size_t errors_ = 0;
+
+      // Set when the frame is malformed or too long.
+      bool bad_ = false;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief SLIP frame codec (RFC 1055).
+     * @headerfile frame-codec.h <cmsis-plus/posix-driver/frame-codec.h>
+     * @ingroup cmsis-plus-posix-io-utils
+     * @details
+     * Frames end with 0xC0; 0xC0 and 0xDB in the data are
+     * escaped. Empty frames are ignored. Encoding needs at most
+     * `2 * len + 2` bytes.
+     */
+    class slip_codec : public frame_codec
+    {
+      // ----------------------------------------------------------------------
+
+    public:
+
+      static constexpr uint8_t end = 0xC0;
+      static constexpr uint8_t esc = 0xDB;
+      static constexpr uint8_t esc_end = 0xDC;
+      static constexpr uint8_t esc_esc = 0xDD;
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      slip_codec (uint8_t* buf, std::size_t size, handler_t handler,
+                  void* arg = nullptr);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      slip_codec (const slip_codec&) = delete;
+      slip_codec (slip_codec&&) = delete;
+      slip_codec&
+      operator= (const slip_codec&) = delete;
+      slip_codec&
+      operator= (slip_codec&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~slip_codec () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      virtual std::size_t
+      do_decode (const uint8_t* data, std::size_t len) override;
+
+      virtual std::size_t
+      do_encode (const uint8_t* data, std::size_t len, uint8_t* buf,
+                 std::size_t size) const override;
+
+      virtual void
+      do_reset (void) override;
+
+      // ----------------------------------------------------------------------
+    private:
+
+      /**
+       * @cond ignore
+       */
+
+      bool escaped_ = false;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief COBS frame codec.
+     * @headerfile frame-codec.h <cmsis-plus/posix-driver/frame-codec.h>
+     * @ingroup cmsis-plus-posix-io-utils
+     * @details
+     * Consistent Overhead Byte Stuffing; frames end with 0x00,
+     * which does not appear in the encoded data. Encoding needs
+     * at most `len + len / 254 + 2` bytes.
+     */
+    class cobs_codec : public frame_codec
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      cobs_codec (uint8_t* buf, std::size_t size, handler_t handler,
+                  void* arg = nullptr);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      cobs_codec (const cobs_codec&) = delete;
+      cobs_codec (cobs_codec&&) = delete;
+      cobs_codec&
+      operator= (const cobs_codec&) = delete;
+      cobs_codec&
+      operator= (cobs_codec&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~cobs_codec () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      virtual std::size_t
+      do_decode (const uint8_t* data, std::size_t len) override;
+
+      virtual std::size_t
+      do_encode (const uint8_t* data, std::size_t len, uint8_t* buf,
+                 std::size_t size) const override;
+
+      virtual void
+      do_reset (void) override;
+
+      // ----------------------------------------------------------------------
+    private:
+
+      /**
+       * @cond ignore
+       */
+
+      // Data bytes left in the current block.
+      std::size_t remaining_ = 0;
+
+      bool started_ = false;
+      // A zero follows the current block, unless the frame ends.
+      bool zero_pending_ = false;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Length prefixed frame codec.
+     * @headerfile frame-codec.h <cmsis-plus/posix-driver/frame-codec.h>
+     * @ingroup cmsis-plus-posix-io-utils
+     * @details
+     * Each frame starts with its length, on 1 to 4 bytes, big
+     * endian. Frames longer than the buffer are skipped. There
+     * are no delimiters, so after a transmission error the stream
+     * must be resynchronised, for example with `reset()` after
+     * a timeout.
+     */
+    class length_prefix_codec : public frame_codec
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      length_prefix_codec (uint8_t* buf, std::size_t size,
+                           handler_t handler, void* arg = nullptr,
+                           std::size_t prefix = 2);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      length_prefix_codec (const length_prefix_codec&) = delete;
+      length_prefix_codec (length_prefix_codec&&) = delete;
+      length_prefix_codec&
+      operator= (const length_prefix_codec&) = delete;
+      length_prefix_codec&
+      operator= (length_prefix_codec&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~length_prefix_codec () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      virtual std::size_t
+      do_decode (const uint8_t* data, std::size_t len) override;
+
+      virtual std::size_t
+      do_encode (const uint8_t* data, std::size_t len, uint8_t* buf,
+                 std::size_t size) const override;
+
+      virtual void
+      do_reset (void) override;
+
+      // ----------------------------------------------------------------------
+    private:
+
+      /**
+       * @cond ignore
+       */
+
+      std::size_t prefix_;
+      std::size_t prefix_count_ = 0;
+      // Payload bytes left in the current frame.
+      std::size_t remaining_ = 0;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline std::size_t
+    frame_codec::decode (const void* data, std::size_t len)
+    {
+      return do_decode (static_cast<const uint8_t*> (data), len);
+    }
+
+    inline std::size_t
+    frame_codec::encode (const void* data, std::size_t len, void* buf,
+                         std::size_t size) const
+    {
+      return do_encode (static_cast<const uint8_t*> (data), len,
+                        static_cast<uint8_t*> (buf), size);
+    }
+
+    inline void
+    frame_codec::checker (check_t check, void* arg)
+    {
+      check_ = check;
+      check_arg_ = arg;
+    }
+
+    inline std::size_t
+    frame_codec::errors (void) const
+    {
+      return errors_;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_DRIVER_FRAME_CODEC_H_ */
@@ -0,0 +1,1089 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_CACHE_H_
+#define CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_CACHE_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix-io/block-device.h>
+#include <cmsis-plus/utils/lists.h>
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Number of sequential streams tracked for read-ahead.
+ */
+#if !defined(OS_INTEGER_POSIX_IO_BLOCK_DEVICE_CACHE_STREAMS)
+#define OS_INTEGER_POSIX_IO_BLOCK_DEVICE_CACHE_STREAMS (2)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    class block_device_cache_impl;
+
+    // ========================================================================
+
+    /**
+     * @brief Block device cache class.
+     * @headerfile block-device-cache.h <cmsis-plus/posix-io/block-device-cache.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * A write-back cache of logical blocks, stacked on top of
+     * any block device (physical device or partition).
+     *
+     * Blocks are looked up in a hash table, the least recently
+     * used buffer is reused on misses, and dirty buffers are written
+     * back to the parent when evicted, on `sync()` and on `close()`.
+     *
+     * Sequential reads are detected (up to
+     * `OS_INTEGER_POSIX_IO_BLOCK_DEVICE_CACHE_STREAMS` interleaved
+     * streams, for example several files read at the same time)
+     * and the following blocks are prefetched with a single
+     * multi-block read. The read-ahead window grows while the
+     * prefetched blocks are used and shrinks when they are evicted
+     * unused.
+     */
+    class block_device_cache : public block_device
+    {
+      // ----------------------------------------------------------------------
+
+    public:
+
+      /**
+       * @brief Cache statistics.
+       */
+      class statistics
+      {
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        void
+        clear (void);
+
+        /**
+         * @}
+         */
+
+        /**
+         * @name Public Member Variables
+         * @{
+         */
+
+        /**
+         * @brief Number of blocks served from the cache.
+         */
+        std::size_t hits = 0;
+
+        /**
+         * @brief Number of blocks read from the parent.
+         */
+        std::size_t misses = 0;
+
+        /**
+         * @brief Number of valid buffers reused for other blocks.
+         */
+        std::size_t evictions = 0;
+
+        /**
+         * @brief Number of dirty blocks written to the parent.
+         */
+        std::size_t write_backs = 0;
+
+        /**
+         * @brief Number of blocks prefetched by read-ahead.
+         */
+        std::size_t read_ahead_blocks = 0;
+
+        /**
+         * @brief Number of prefetched blocks later read.
+         */
+        std::size_t read_ahead_hits = 0;
+
+        /**
+         * @brief Number of prefetched blocks evicted unused.
+         */
+        std::size_t read_ahead_wasted = 0;
+
+        /**
+         * @}
+         */
+      };
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      block_device_cache (block_device_cache_impl& impl, const char* name);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      block_device_cache (const block_device_cache&) = delete;
+      block_device_cache (block_device_cache&&) = delete;
+      block_device_cache&
+      operator= (const block_device_cache&) = delete;
+      block_device_cache&
+      operator= (block_device_cache&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~block_device_cache ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Write back all dirty buffers and forget all blocks.
+       * @par Parameters
+       *  None.
+       * @retval 0 if successful.
+       * @retval -1 if a write back failed; errno is set.
+       */
+      virtual int
+      invalidate (void);
+
+      /**
+       * @brief Set the maximum read-ahead window.
+       * @param [in] nblocks Maximum number of blocks to prefetch;
+       *  0 disables read-ahead.
+       * @par Returns
+       *  Nothing.
+       * @details
+       * The window is limited to half the number of buffers.
+       */
+      void
+      read_ahead (std::size_t nblocks);
+
+      class statistics&
+      statistics (void);
+
+      // ----------------------------------------------------------------------
+      // Support functions.
+
+      block_device_cache_impl&
+      impl (void) const;
+
+      /**
+       * @}
+       */
+    };
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    class block_device_cache_impl : public block_device_impl
+    {
+      // ----------------------------------------------------------------------
+
+      friend block_device_cache;
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      block_device_cache_impl (block_device& parent, std::size_t nbuffers);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      block_device_cache_impl (const block_device_cache_impl&) = delete;
+      block_device_cache_impl (block_device_cache_impl&&) = delete;
+      block_device_cache_impl&
+      operator= (const block_device_cache_impl&) = delete;
+      block_device_cache_impl&
+      operator= (block_device_cache_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~block_device_cache_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual int
+      do_vioctl (int request, std::va_list args) override;
+
+      virtual int
+      do_vopen (const char* path, int oflag, std::va_list args) override;
+
+      virtual ssize_t
+      do_read_block (void* buf, blknum_t blknum, std::size_t nblocks) override;
+
+      virtual ssize_t
+      do_write_block (const void* buf, blknum_t blknum, std::size_t nblocks)
+          override;
+
+      virtual int
+      do_discard (blknum_t blknum, std::size_t nblocks) override;
+
+      virtual void
+      do_sync (void) override;
+
+      virtual int
+      do_close (void) override;
+
+      // ----------------------------------------------------------------------
+
+      int
+      invalidate (void);
+
+      void
+      read_ahead (std::size_t nblocks);
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      class buffer
+      {
+      public:
+
+        utils::double_list_links lru_links_;
+        buffer* hash_next_ = nullptr;
+        uint8_t* data_ = nullptr;
+        blknum_t blknum_ = 0;
+        bool dirty_ = false;
+        // Prefetched and not yet read.
+        bool ahead_ = false;
+      };
+
+      class stream
+      {
+      public:
+
+        // The block expected to be read next.
+        blknum_t next_ = 0;
+        // The first block not yet prefetched.
+        blknum_t ahead_end_ = 0;
+        std::size_t window_ = 0;
+        bool active_ = false;
+      };
+
+      using buffers_list = utils::intrusive_list<buffer,
+      utils::double_list_links, &buffer::lru_links_>;
+
+      std::size_t
+      hash (blknum_t blknum) const;
+
+      buffer*
+      find (blknum_t blknum);
+
+      buffer*
+      lookup (blknum_t blknum);
+
+      void
+      hash_link (buffer* b);
+
+      void
+      hash_unlink (buffer* b);
+
+      buffer*
+      allocate_buffer (blknum_t blknum);
+
+      void
+      release_buffer (buffer* b);
+
+      int
+      write_back (buffer* b);
+
+      int
+      write_back_all (void);
+
+      void
+      prefetch (blknum_t blknum, std::size_t nblocks, std::size_t ahead_hits);
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      block_device& parent_;
+
+      std::size_t num_buffers_;
+      std::size_t hash_mask_;
+
+      buffer* buffers_ = nullptr;
+      buffer** hash_table_ = nullptr;
+
+      uint8_t* arena_ = nullptr;
+      std::size_t arena_block_size_bytes_ = 0;
+
+      // Buffers with valid content, least recently used first.
+      buffers_list lru_list_;
+      // Buffers without content.
+      buffers_list free_list_;
+
+      stream streams_[OS_INTEGER_POSIX_IO_BLOCK_DEVICE_CACHE_STREAMS];
+      std::size_t next_stream_ = 0;
+
+      std::size_t read_ahead_max_blocks_;
+
+      // Staging area for the multi-block prefetch reads.
+      uint8_t* ahead_buffer_ = nullptr;
+      std::size_t ahead_buffer_size_bytes_ = 0;
+
+      class block_device_cache::statistics statistics_;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+    // ========================================================================
+
+    template<typename T = block_device_cache_impl>
+      class block_device_cache_implementable : public block_device_cache
+      {
+        // --------------------------------------------------------------------
+
+      public:
+
+        using value_type = T;
+
+        // --------------------------------------------------------------------
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+      public:
+
+        template<typename ... Args>
+          block_device_cache_implementable (const char* name,
+                                            block_device& parent,
+                                            Args&&... args);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        block_device_cache_implementable (
+            const block_device_cache_implementable&) = delete;
+        block_device_cache_implementable (block_device_cache_implementable&&) = delete;
+        block_device_cache_implementable&
+        operator= (const block_device_cache_implementable&) = delete;
+        block_device_cache_implementable&
+        operator= (block_device_cache_implementable&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        virtual
+        ~block_device_cache_implementable ();
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+      public:
+
+        // Support functions.
+
+        value_type&
+        impl (void) const;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        // Include the implementation as a member.
+        value_type impl_instance_;
+
+        /**
+         * @endcond
+         */
+      };
+
+    // ========================================================================
+
+    template<typename T, typename L>
+      class block_device_cache_lockable : public block_device_cache
+      {
+        // --------------------------------------------------------------------
+
+      public:
+
+        using value_type = T;
+        using lockable_type = L;
+
+        // --------------------------------------------------------------------
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+      public:
+
+        template<typename ... Args>
+          block_device_cache_lockable (const char* name, block_device& parent,
+                                       lockable_type& locker, Args&&... args);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        block_device_cache_lockable (const block_device_cache_lockable&) = delete;
+        block_device_cache_lockable (block_device_cache_lockable&&) = delete;
+        block_device_cache_lockable&
+        operator= (const block_device_cache_lockable&) = delete;
+        block_device_cache_lockable&
+        operator= (block_device_cache_lockable&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        virtual
+        ~block_device_cache_lockable () override;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+      public:
+
+        virtual int
+        close (void) override;
+
+        virtual ssize_t
+        read (void* buf, std::size_t nbyte) override;
+
+        virtual ssize_t
+        write (const void* buf, std::size_t nbyte) override;
+
+        virtual ssize_t
+        writev (const struct iovec* iov, int iovcnt) override;
+
+        virtual ssize_t
+        readv (const struct iovec* iov, int iovcnt) override;
+
+        virtual ssize_t
+        pread (void* buf, std::size_t nbyte, off_t offset) override;
+
+        virtual ssize_t
+        pwrite (const void* buf, std::size_t nbyte, off_t offset) override;
+
+        virtual ssize_t
+        preadv (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+        virtual ssize_t
+        pwritev (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+        virtual void*
+        mmap (std::size_t length, int prot, int flags, off_t offset) override;
+
+        virtual int
+        munmap (void* addr, std::size_t length) override;
+
+        virtual int
+        vioctl (int request, std::va_list args) override;
+
+        virtual ssize_t
+        read_block (void* buf, blknum_t blknum, std::size_t nblocks = 1)
+            override;
+
+        virtual ssize_t
+        write_block (const void* buf, blknum_t blknum, std::size_t nblocks = 1)
+            override;
+
+        virtual ssize_t
+        readv_block (const struct iovec* iov, int iovcnt, blknum_t blknum)
+            override;
+
+        virtual ssize_t
+        writev_block (const struct iovec* iov, int iovcnt, blknum_t blknum)
+            override;
+
+        virtual int
+        discard_blocks (blknum_t blknum, std::size_t nblocks) override;
+
+        virtual void
+        sync (void) override;
+
+        virtual int
+        invalidate (void) override;
+
+        // --------------------------------------------------------------------
+        // Support functions.
+
+        value_type&
+        impl (void) const;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        // Include the implementation as a member.
+        value_type impl_instance_;
+
+        lockable_type& locker_;
+
+        /**
+         * @endcond
+         */
+      };
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wweak-template-vtables"
+#endif
+
+    extern template class block_device_cache_implementable<
+        block_device_cache_impl> ;
+
+#pragma GCC diagnostic pop
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline void
+    block_device_cache::statistics::clear (void)
+    {
+      hits = 0;
+      misses = 0;
+      evictions = 0;
+      write_backs = 0;
+      read_ahead_blocks = 0;
+      read_ahead_hits = 0;
+      read_ahead_wasted = 0;
+    }
+
+    // ========================================================================
+
+    inline void
+    block_device_cache::read_ahead (std::size_t nblocks)
+    {
+      impl ().read_ahead (nblocks);
+    }
+
+    inline class block_device_cache::statistics&
+    block_device_cache::statistics (void)
+    {
+      return impl ().statistics_;
+    }
+
+    inline block_device_cache_impl&
+    block_device_cache::impl (void) const
+    {
+      return static_cast<block_device_cache_impl&> (impl_);
+    }
+
+    // ========================================================================
+
+    template<typename T>
+      template<typename ... Args>
+        block_device_cache_implementable<T>::block_device_cache_implementable (
+            const char* name, block_device& parent, Args&&... args) :
+            block_device_cache
+              { impl_instance_, name }, //
+            impl_instance_
+              { parent, std::forward<Args>(args)... }
+        {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+          trace::printf ("block_device_cache_implementable::%s(\"%s\")=@%p\n",
+                         __func__, name_, this);
+#endif
+        }
+
+    template<typename T>
+      block_device_cache_implementable<T>::~block_device_cache_implementable ()
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_implementable::%s() @%p %s\n",
+                       __func__, this, name_);
+#endif
+      }
+
+    template<typename T>
+      typename block_device_cache_implementable<T>::value_type&
+      block_device_cache_implementable<T>::impl (void) const
+      {
+        return static_cast<value_type&> (impl_);
+      }
+
+    // ========================================================================
+
+    template<typename T, typename L>
+      template<typename ... Args>
+        block_device_cache_lockable<T, L>::block_device_cache_lockable (
+            const char* name, block_device& parent, lockable_type& locker,
+            Args&&... args) :
+            block_device_cache
+              { impl_instance_, name }, //
+            impl_instance_
+              { parent, std::forward<Args>(args)... }, //
+            locker_ (locker)
+        {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+          trace::printf ("block_device_cache_lockable::%s(\"%s\")=@%p\n",
+                         __func__, name_, this);
+#endif
+        }
+
+    template<typename T, typename L>
+      block_device_cache_lockable<T, L>::~block_device_cache_lockable ()
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s() @%p %s\n", __func__,
+                       this, name_);
+#endif
+      }
+
+    // ------------------------------------------------------------------------
+
+    template<typename T, typename L>
+      int
+      block_device_cache_lockable<T, L>::close (void)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s() @%p\n", __func__,
+                       this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::close ();
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_cache_lockable<T, L>::read (void* buf, std::size_t nbyte)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s(0x0%X, %u) @%p\n",
+                       __func__, buf, nbyte, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::read (buf, nbyte);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_cache_lockable<T, L>::write (const void* buf,
+                                                std::size_t nbyte)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s(0x0%X, %u) @%p\n",
+                       __func__, buf, nbyte, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::write (buf, nbyte);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_cache_lockable<T, L>::writev (const struct iovec* iov,
+                                                 int iovcnt)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s(0x0%X, %d) @%p\n",
+                       __func__, iov, iovcnt, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::writev (iov, iovcnt);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_cache_lockable<T, L>::readv (const struct iovec* iov,
+                                                int iovcnt)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s(0x0%X, %d) @%p\n",
+                       __func__, iov, iovcnt, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::readv (iov, iovcnt);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_cache_lockable<T, L>::pread (void* buf, std::size_t nbyte,
+                                                off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s(0x0%X, %u, %d) @%p\n",
+                       __func__, buf, nbyte, offset, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::pread (buf, nbyte, offset);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_cache_lockable<T, L>::pwrite (const void* buf,
+                                                 std::size_t nbyte,
+                                                 off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s(0x0%X, %u, %d) @%p\n",
+                       __func__, buf, nbyte, offset, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::pwrite (buf, nbyte, offset);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_cache_lockable<T, L>::preadv (const struct iovec* iov,
+                                                 int iovcnt, off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s(0x0%X, %d, %d) @%p\n",
+                       __func__, iov, iovcnt, offset, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::preadv (iov, iovcnt, offset);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_cache_lockable<T, L>::pwritev (const struct iovec* iov,
+                                                  int iovcnt, off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s(0x0%X, %d, %d) @%p\n",
+                       __func__, iov, iovcnt, offset, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::pwritev (iov, iovcnt, offset);
+      }
+
+    template<typename T, typename L>
+      void*
+      block_device_cache_lockable<T, L>::mmap (std::size_t length, int prot,
+                                               int flags, off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s(%u, %d) @%p\n",
+                       __func__, length, offset, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::mmap (length, prot, flags, offset);
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_cache_lockable<T, L>::munmap (void* addr, std::size_t length)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s(%p, %u) @%p\n",
+                       __func__, addr, length, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::munmap (addr, length);
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_cache_lockable<T, L>::vioctl (int request,
+                                                 std::va_list args)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s(%d) @%p\n", __func__,
+                       request, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::vioctl (request, args);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_cache_lockable<T, L>::read_block (void* buf,
+                                                     blknum_t blknum,
+                                                     std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s(%p, %u, %u) @%p\n",
+                       __func__, buf, blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::read_block (buf, blknum, nblocks);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_cache_lockable<T, L>::write_block (const void* buf,
+                                                      blknum_t blknum,
+                                                      std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s(%p, %u, %u) @%p\n",
+                       __func__, buf, blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::write_block (buf, blknum, nblocks);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_cache_lockable<T, L>::readv_block (const struct iovec* iov,
+                                                      int iovcnt,
+                                                      blknum_t blknum)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s(%p, %d, %u) @%p\n",
+                       __func__, iov, iovcnt, blknum, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::readv_block (iov, iovcnt, blknum);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_cache_lockable<T, L>::writev_block (const struct iovec* iov,
+                                                       int iovcnt,
+                                                       blknum_t blknum)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s(%p, %d, %u) @%p\n",
+                       __func__, iov, iovcnt, blknum, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::writev_block (iov, iovcnt, blknum);
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_cache_lockable<T, L>::discard_blocks (blknum_t blknum,
+                                                         std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s(%u, %u) @%p\n",
+                       __func__, blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::discard_blocks (blknum, nblocks);
+      }
+
+    template<typename T, typename L>
+      void
+      block_device_cache_lockable<T, L>::sync (void)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s() @%p\n", __func__,
+                       this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::sync ();
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_cache_lockable<T, L>::invalidate (void)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+        trace::printf ("block_device_cache_lockable::%s() @%p\n", __func__,
+                       this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_cache::invalidate ();
+      }
+
+    template<typename T, typename L>
+      typename block_device_cache_lockable<T, L>::value_type&
+      block_device_cache_lockable<T, L>::impl (void) const
+      {
+        return static_cast<value_type&> (impl_);
+      }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_CACHE_H_ */
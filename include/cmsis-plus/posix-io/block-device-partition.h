@@ -179,6 +179,30 @@ namespace os
       do_write_block (const void* buf, blknum_t blknum, std::size_t nblocks)
           override;
 
+      virtual ssize_t
+      do_readv_block (const struct iovec* iov, int iovcnt, blknum_t blknum)
+          override;
+
+      virtual ssize_t
+      do_writev_block (const struct iovec* iov, int iovcnt, blknum_t blknum)
+          override;
+
+      virtual int
+      do_discard (blknum_t blknum, std::size_t nblocks) override;
+
+      /**
+       * @brief Map blocks in memory.
+       * @details
+       * The request is passed to the parent, so partitions of
+       * memory addressable devices are also mapped directly.
+       */
+      virtual void*
+      do_mmap (std::size_t length, int prot, int flags, off_t offset)
+          override;
+
+      virtual int
+      do_munmap (void* addr, std::size_t length) override;
+
       virtual void
       do_sync (void) override;
 
@@ -363,6 +387,17 @@ namespace os
         write_block (const void* buf, blknum_t blknum, std::size_t nblocks = 1)
             override;
 
+        virtual ssize_t
+        readv_block (const struct iovec* iov, int iovcnt, blknum_t blknum)
+            override;
+
+        virtual ssize_t
+        writev_block (const struct iovec* iov, int iovcnt, blknum_t blknum)
+            override;
+
+        virtual int
+        discard_blocks (blknum_t blknum, std::size_t nblocks) override;
+
         // --------------------------------------------------------------------
         // Support functions.
 
@@ -535,6 +570,54 @@ namespace os
         return block_device_partition::write_block (buf, blknum, nblocks);
       }
 
+    template<typename T, typename L>
+      ssize_t
+      block_device_partition_lockable<T, L>::readv_block (
+          const struct iovec* iov, int iovcnt, blknum_t blknum)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
+        trace::printf ("block_device_partition_lockable::%s(%p, %d, %u) @%p\n",
+                       __func__, iov, iovcnt, blknum, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_partition::readv_block (iov, iovcnt, blknum);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_partition_lockable<T, L>::writev_block (
+          const struct iovec* iov, int iovcnt, blknum_t blknum)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
+        trace::printf ("block_device_partition_lockable::%s(%p, %d, %u) @%p\n",
+                       __func__, iov, iovcnt, blknum, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_partition::writev_block (iov, iovcnt, blknum);
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_partition_lockable<T, L>::discard_blocks (
+          blknum_t blknum, std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
+        trace::printf ("block_device_partition_lockable::%s(%u, %u) @%p\n",
+                       __func__, blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_partition::discard_blocks (blknum, nblocks);
+      }
+
     template<typename T, typename L>
       typename block_device_partition_lockable<T, L>::value_type&
       block_device_partition_lockable<T, L>::impl (void) const
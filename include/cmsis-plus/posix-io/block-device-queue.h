@@ -0,0 +1,1039 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_QUEUE_H_
+#define CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_QUEUE_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix-io/block-device.h>
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    class block_device_queue_impl;
+
+    // ========================================================================
+
+    /**
+     * @brief Block device request queue class.
+     * @headerfile block-device-queue.h <cmsis-plus/posix-io/block-device-queue.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * An I/O elevator stacked on top of any block device.
+     *
+     * Written blocks are kept in a queue sorted by block number;
+     * rewrites of a queued block only update the queued copy.
+     * When the queue is flushed, runs of adjacent blocks are
+     * merged into multi-block writes, issued in ascending order.
+     *
+     * The queue is flushed by `sync()`, `close()`, `flush()`,
+     * when it is full, and when the oldest queued block is
+     * older than the configured timeout. The timeout is checked on
+     * each request and by `flush_expired()`, which can be
+     * called periodically, for example by a housekeeping thread.
+     *
+     * Reads are served from the queue for the queued blocks
+     * and from the parent for the rest.
+     */
+    class block_device_queue : public block_device
+    {
+      // ----------------------------------------------------------------------
+
+    public:
+
+      /**
+       * @brief Queue statistics.
+       */
+      class statistics
+      {
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        void
+        clear (void);
+
+        /**
+         * @}
+         */
+
+        /**
+         * @name Public Member Variables
+         * @{
+         */
+
+        /**
+         * @brief Number of blocks written to the queue.
+         */
+        std::size_t queued = 0;
+
+        /**
+         * @brief Number of blocks that updated an already queued block.
+         */
+        std::size_t absorbed = 0;
+
+        /**
+         * @brief Number of blocks written to the parent.
+         */
+        std::size_t written = 0;
+
+        /**
+         * @brief Number of write requests issued to the parent.
+         */
+        std::size_t transfers = 0;
+
+        /**
+         * @brief Number of queue flushes.
+         */
+        std::size_t flushes = 0;
+
+        /**
+         * @}
+         */
+      };
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      block_device_queue (block_device_queue_impl& impl, const char* name);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      block_device_queue (const block_device_queue&) = delete;
+      block_device_queue (block_device_queue&&) = delete;
+      block_device_queue&
+      operator= (const block_device_queue&) = delete;
+      block_device_queue&
+      operator= (block_device_queue&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~block_device_queue ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Write all queued blocks to the parent.
+       * @par Parameters
+       *  None.
+       * @retval 0 if successful.
+       * @retval -1 if a write failed; errno is set.
+       */
+      virtual int
+      flush (void);
+
+      /**
+       * @brief Flush the queue if the oldest block timed out.
+       * @par Parameters
+       *  None.
+       * @retval 0 if successful.
+       * @retval -1 if a write failed; errno is set.
+       */
+      virtual int
+      flush_expired (void);
+
+      class statistics&
+      statistics (void);
+
+      // ----------------------------------------------------------------------
+      // Support functions.
+
+      block_device_queue_impl&
+      impl (void) const;
+
+      /**
+       * @}
+       */
+    };
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    class block_device_queue_impl : public block_device_impl
+    {
+      // ----------------------------------------------------------------------
+
+      friend block_device_queue;
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      /**
+       * @param [in] parent The device to write to.
+       * @param [in] nslots The maximum number of queued blocks.
+       * @param [in] timeout Maximum age of the queued blocks, in
+       *  system clock ticks; 0 means no timeout.
+       */
+      block_device_queue_impl (block_device& parent, std::size_t nslots,
+                               rtos::clock::duration_t timeout = 0);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      block_device_queue_impl (const block_device_queue_impl&) = delete;
+      block_device_queue_impl (block_device_queue_impl&&) = delete;
+      block_device_queue_impl&
+      operator= (const block_device_queue_impl&) = delete;
+      block_device_queue_impl&
+      operator= (block_device_queue_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~block_device_queue_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual int
+      do_vioctl (int request, std::va_list args) override;
+
+      virtual int
+      do_vopen (const char* path, int oflag, std::va_list args) override;
+
+      virtual ssize_t
+      do_read_block (void* buf, blknum_t blknum, std::size_t nblocks) override;
+
+      virtual ssize_t
+      do_write_block (const void* buf, blknum_t blknum, std::size_t nblocks)
+          override;
+
+      virtual int
+      do_discard (blknum_t blknum, std::size_t nblocks) override;
+
+      virtual void
+      do_sync (void) override;
+
+      virtual int
+      do_close (void) override;
+
+      // ----------------------------------------------------------------------
+
+      int
+      flush (void);
+
+      int
+      flush_expired (void);
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      class slot
+      {
+      public:
+
+        uint8_t* data_ = nullptr;
+        blknum_t blknum_ = 0;
+      };
+
+      std::size_t
+      find (blknum_t blknum);
+
+      void
+      drop (blknum_t blknum, std::size_t nblocks);
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      block_device& parent_;
+
+      std::size_t num_slots_;
+      rtos::clock::duration_t timeout_;
+
+      slot* slots_ = nullptr;
+      // Queued slots, sorted by block number.
+      slot** pending_ = nullptr;
+      std::size_t num_pending_ = 0;
+      // Unused slots.
+      slot** free_ = nullptr;
+      std::size_t num_free_ = 0;
+
+      uint8_t* arena_ = nullptr;
+      std::size_t arena_block_size_bytes_ = 0;
+
+      // Staging area for the merged writes.
+      uint8_t* merge_buffer_ = nullptr;
+
+      // When the oldest queued block was queued.
+      rtos::clock::timestamp_t oldest_ = 0;
+
+      class block_device_queue::statistics statistics_;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+    // ========================================================================
+
+    template<typename T = block_device_queue_impl>
+      class block_device_queue_implementable : public block_device_queue
+      {
+        // --------------------------------------------------------------------
+
+      public:
+
+        using value_type = T;
+
+        // --------------------------------------------------------------------
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+      public:
+
+        template<typename ... Args>
+          block_device_queue_implementable (const char* name,
+                                            block_device& parent,
+                                            Args&&... args);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        block_device_queue_implementable (
+            const block_device_queue_implementable&) = delete;
+        block_device_queue_implementable (block_device_queue_implementable&&) = delete;
+        block_device_queue_implementable&
+        operator= (const block_device_queue_implementable&) = delete;
+        block_device_queue_implementable&
+        operator= (block_device_queue_implementable&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        virtual
+        ~block_device_queue_implementable ();
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+      public:
+
+        // Support functions.
+
+        value_type&
+        impl (void) const;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        // Include the implementation as a member.
+        value_type impl_instance_;
+
+        /**
+         * @endcond
+         */
+      };
+
+    // ========================================================================
+
+    template<typename T, typename L>
+      class block_device_queue_lockable : public block_device_queue
+      {
+        // --------------------------------------------------------------------
+
+      public:
+
+        using value_type = T;
+        using lockable_type = L;
+
+        // --------------------------------------------------------------------
+
+        /**
+         * @name Constructors & Destructor
+         * @{
+         */
+
+      public:
+
+        template<typename ... Args>
+          block_device_queue_lockable (const char* name, block_device& parent,
+                                       lockable_type& locker, Args&&... args);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        block_device_queue_lockable (const block_device_queue_lockable&) = delete;
+        block_device_queue_lockable (block_device_queue_lockable&&) = delete;
+        block_device_queue_lockable&
+        operator= (const block_device_queue_lockable&) = delete;
+        block_device_queue_lockable&
+        operator= (block_device_queue_lockable&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        virtual
+        ~block_device_queue_lockable () override;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+      public:
+
+        virtual int
+        close (void) override;
+
+        virtual ssize_t
+        read (void* buf, std::size_t nbyte) override;
+
+        virtual ssize_t
+        write (const void* buf, std::size_t nbyte) override;
+
+        virtual ssize_t
+        writev (const struct iovec* iov, int iovcnt) override;
+
+        virtual ssize_t
+        readv (const struct iovec* iov, int iovcnt) override;
+
+        virtual ssize_t
+        pread (void* buf, std::size_t nbyte, off_t offset) override;
+
+        virtual ssize_t
+        pwrite (const void* buf, std::size_t nbyte, off_t offset) override;
+
+        virtual ssize_t
+        preadv (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+        virtual ssize_t
+        pwritev (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+        virtual void*
+        mmap (std::size_t length, int prot, int flags, off_t offset) override;
+
+        virtual int
+        munmap (void* addr, std::size_t length) override;
+
+        virtual int
+        vioctl (int request, std::va_list args) override;
+
+        virtual ssize_t
+        read_block (void* buf, blknum_t blknum, std::size_t nblocks = 1)
+            override;
+
+        virtual ssize_t
+        write_block (const void* buf, blknum_t blknum, std::size_t nblocks = 1)
+            override;
+
+        virtual ssize_t
+        readv_block (const struct iovec* iov, int iovcnt, blknum_t blknum)
+            override;
+
+        virtual ssize_t
+        writev_block (const struct iovec* iov, int iovcnt, blknum_t blknum)
+            override;
+
+        virtual int
+        discard_blocks (blknum_t blknum, std::size_t nblocks) override;
+
+        virtual void
+        sync (void) override;
+
+        virtual int
+        flush (void) override;
+
+        virtual int
+        flush_expired (void) override;
+
+        // --------------------------------------------------------------------
+        // Support functions.
+
+        value_type&
+        impl (void) const;
+
+        /**
+         * @}
+         */
+
+        // --------------------------------------------------------------------
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        // Include the implementation as a member.
+        value_type impl_instance_;
+
+        lockable_type& locker_;
+
+        /**
+         * @endcond
+         */
+      };
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wweak-template-vtables"
+#endif
+
+    extern template class block_device_queue_implementable<
+        block_device_queue_impl> ;
+
+#pragma GCC diagnostic pop
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline void
+    block_device_queue::statistics::clear (void)
+    {
+      queued = 0;
+      absorbed = 0;
+      written = 0;
+      transfers = 0;
+      flushes = 0;
+    }
+
+    // ========================================================================
+
+    inline class block_device_queue::statistics&
+    block_device_queue::statistics (void)
+    {
+      return impl ().statistics_;
+    }
+
+    inline block_device_queue_impl&
+    block_device_queue::impl (void) const
+    {
+      return static_cast<block_device_queue_impl&> (impl_);
+    }
+
+    // ========================================================================
+
+    template<typename T>
+      template<typename ... Args>
+        block_device_queue_implementable<T>::block_device_queue_implementable (
+            const char* name, block_device& parent, Args&&... args) :
+            block_device_queue
+              { impl_instance_, name }, //
+            impl_instance_
+              { parent, std::forward<Args>(args)... }
+        {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+          trace::printf ("block_device_queue_implementable::%s(\"%s\")=@%p\n",
+                         __func__, name_, this);
+#endif
+        }
+
+    template<typename T>
+      block_device_queue_implementable<T>::~block_device_queue_implementable ()
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_implementable::%s() @%p %s\n",
+                       __func__, this, name_);
+#endif
+      }
+
+    template<typename T>
+      typename block_device_queue_implementable<T>::value_type&
+      block_device_queue_implementable<T>::impl (void) const
+      {
+        return static_cast<value_type&> (impl_);
+      }
+
+    // ========================================================================
+
+    template<typename T, typename L>
+      template<typename ... Args>
+        block_device_queue_lockable<T, L>::block_device_queue_lockable (
+            const char* name, block_device& parent, lockable_type& locker,
+            Args&&... args) :
+            block_device_queue
+              { impl_instance_, name }, //
+            impl_instance_
+              { parent, std::forward<Args>(args)... }, //
+            locker_ (locker)
+        {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+          trace::printf ("block_device_queue_lockable::%s(\"%s\")=@%p\n",
+                         __func__, name_, this);
+#endif
+        }
+
+    template<typename T, typename L>
+      block_device_queue_lockable<T, L>::~block_device_queue_lockable ()
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s() @%p %s\n", __func__,
+                       this, name_);
+#endif
+      }
+
+    // ------------------------------------------------------------------------
+
+    template<typename T, typename L>
+      int
+      block_device_queue_lockable<T, L>::close (void)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s() @%p\n", __func__,
+                       this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::close ();
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_queue_lockable<T, L>::read (void* buf, std::size_t nbyte)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s(0x0%X, %u) @%p\n",
+                       __func__, buf, nbyte, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::read (buf, nbyte);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_queue_lockable<T, L>::write (const void* buf,
+                                                std::size_t nbyte)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s(0x0%X, %u) @%p\n",
+                       __func__, buf, nbyte, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::write (buf, nbyte);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_queue_lockable<T, L>::writev (const struct iovec* iov,
+                                                 int iovcnt)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s(0x0%X, %d) @%p\n",
+                       __func__, iov, iovcnt, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::writev (iov, iovcnt);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_queue_lockable<T, L>::readv (const struct iovec* iov,
+                                                int iovcnt)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s(0x0%X, %d) @%p\n",
+                       __func__, iov, iovcnt, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::readv (iov, iovcnt);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_queue_lockable<T, L>::pread (void* buf, std::size_t nbyte,
+                                                off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s(0x0%X, %u, %d) @%p\n",
+                       __func__, buf, nbyte, offset, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::pread (buf, nbyte, offset);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_queue_lockable<T, L>::pwrite (const void* buf,
+                                                 std::size_t nbyte,
+                                                 off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s(0x0%X, %u, %d) @%p\n",
+                       __func__, buf, nbyte, offset, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::pwrite (buf, nbyte, offset);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_queue_lockable<T, L>::preadv (const struct iovec* iov,
+                                                 int iovcnt, off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s(0x0%X, %d, %d) @%p\n",
+                       __func__, iov, iovcnt, offset, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::preadv (iov, iovcnt, offset);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_queue_lockable<T, L>::pwritev (const struct iovec* iov,
+                                                  int iovcnt, off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s(0x0%X, %d, %d) @%p\n",
+                       __func__, iov, iovcnt, offset, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::pwritev (iov, iovcnt, offset);
+      }
+
+    template<typename T, typename L>
+      void*
+      block_device_queue_lockable<T, L>::mmap (std::size_t length, int prot,
+                                               int flags, off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s(%u, %d) @%p\n",
+                       __func__, length, offset, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::mmap (length, prot, flags, offset);
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_queue_lockable<T, L>::munmap (void* addr, std::size_t length)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s(%p, %u) @%p\n",
+                       __func__, addr, length, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::munmap (addr, length);
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_queue_lockable<T, L>::vioctl (int request,
+                                                 std::va_list args)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s(%d) @%p\n", __func__,
+                       request, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::vioctl (request, args);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_queue_lockable<T, L>::read_block (void* buf,
+                                                     blknum_t blknum,
+                                                     std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s(%p, %u, %u) @%p\n",
+                       __func__, buf, blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::read_block (buf, blknum, nblocks);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_queue_lockable<T, L>::write_block (const void* buf,
+                                                      blknum_t blknum,
+                                                      std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s(%p, %u, %u) @%p\n",
+                       __func__, buf, blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::write_block (buf, blknum, nblocks);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_queue_lockable<T, L>::readv_block (const struct iovec* iov,
+                                                      int iovcnt,
+                                                      blknum_t blknum)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s(%p, %d, %u) @%p\n",
+                       __func__, iov, iovcnt, blknum, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::readv_block (iov, iovcnt, blknum);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_queue_lockable<T, L>::writev_block (const struct iovec* iov,
+                                                       int iovcnt,
+                                                       blknum_t blknum)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s(%p, %d, %u) @%p\n",
+                       __func__, iov, iovcnt, blknum, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::writev_block (iov, iovcnt, blknum);
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_queue_lockable<T, L>::discard_blocks (blknum_t blknum,
+                                                         std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s(%u, %u) @%p\n",
+                       __func__, blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::discard_blocks (blknum, nblocks);
+      }
+
+    template<typename T, typename L>
+      void
+      block_device_queue_lockable<T, L>::sync (void)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s() @%p\n", __func__,
+                       this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::sync ();
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_queue_lockable<T, L>::flush (void)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s() @%p\n", __func__,
+                       this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::flush ();
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_queue_lockable<T, L>::flush_expired (void)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+        trace::printf ("block_device_queue_lockable::%s() @%p\n", __func__,
+                       this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device_queue::flush_expired ();
+      }
+
+    template<typename T, typename L>
+      typename block_device_queue_lockable<T, L>::value_type&
+      block_device_queue_lockable<T, L>::impl (void) const
+      {
+        return static_cast<value_type&> (impl_);
+      }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_QUEUE_H_ */
@@ -0,0 +1,254 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_RAM_H_
+#define CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_RAM_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix-io/block-device.h>
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief RAM block device implementation.
+     * @headerfile block-device-ram.h <cmsis-plus/posix-io/block-device-ram.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * A block device stored in memory, for scratch data and as
+     * a reference device when testing or measuring the block layer
+     * without hardware.
+     *
+     * The storage is allocated from a memory resource on the
+     * first open, and is kept, with its content, until the device
+     * is destroyed. It starts zeroed, and discarded blocks
+     * read back as zeroes.
+     *
+     * The storage can also be accessed directly, with `mmap()`.
+     *
+     * Slow media can be simulated with `latency()`, as a fixed
+     * cost for each command plus a transfer rate; multi-block
+     * and scatter/gather transfers are charged a single command.
+     */
+    class block_device_ram_impl : public block_device_impl
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      block_device_ram_impl (std::size_t block_size_bytes, blknum_t nblocks,
+                             rtos::memory::memory_resource* mr =
+                                 rtos::memory::get_default_resource ());
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      block_device_ram_impl (const block_device_ram_impl&) = delete;
+      block_device_ram_impl (block_device_ram_impl&&) = delete;
+      block_device_ram_impl&
+      operator= (const block_device_ram_impl&) = delete;
+      block_device_ram_impl&
+      operator= (block_device_ram_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~block_device_ram_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual int
+      do_vioctl (int request, std::va_list args) override;
+
+      virtual int
+      do_vopen (const char* path, int oflag, std::va_list args) override;
+
+      virtual ssize_t
+      do_read_block (void* buf, blknum_t blknum, std::size_t nblocks) override;
+
+      virtual ssize_t
+      do_write_block (const void* buf, blknum_t blknum, std::size_t nblocks)
+          override;
+
+      virtual ssize_t
+      do_readv_block (const struct iovec* iov, int iovcnt, blknum_t blknum)
+          override;
+
+      virtual ssize_t
+      do_writev_block (const struct iovec* iov, int iovcnt, blknum_t blknum)
+          override;
+
+      virtual int
+      do_discard (blknum_t blknum, std::size_t nblocks) override;
+
+      /**
+       * @brief Map blocks in memory.
+       * @details
+       * Returns a pointer to the storage, without copies,
+       * except for writable private mappings.
+       */
+      virtual void*
+      do_mmap (std::size_t length, int prot, int flags, off_t offset)
+          override;
+
+      virtual int
+      do_munmap (void* addr, std::size_t length) override;
+
+      virtual void
+      do_sync (void) override;
+
+      virtual int
+      do_close (void) override;
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @brief Simulate the timing of a slower device.
+       * @param [in] command Ticks spent for each command.
+       * @param [in] bytes_per_tick Transfer rate; 0 for infinite.
+       * @par Returns
+       *  Nothing.
+       * @details
+       * The calling thread sleeps for the simulated time;
+       * fractions of ticks are carried over to the next
+       * transfers. Both 0 (the default) disable the simulation.
+       */
+      void
+      latency (rtos::clock::duration_t command, std::size_t bytes_per_tick);
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      void
+      delay (std::size_t bytes);
+
+      uint8_t*
+      block_address (blknum_t blknum) const;
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      rtos::memory::memory_resource* mr_;
+
+      uint8_t* arena_ = nullptr;
+      std::size_t arena_size_bytes_ = 0;
+
+      rtos::clock::duration_t command_ticks_ = 0;
+      std::size_t bytes_per_tick_ = 0;
+      // Bytes transferred and not yet accounted as a full tick.
+      std::size_t pending_bytes_ = 0;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+    /**
+     * @brief RAM block device.
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    using block_device_ram = block_device_implementable<block_device_ram_impl>;
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline uint8_t*
+    block_device_ram_impl::block_address (blknum_t blknum) const
+    {
+      return arena_ + static_cast<std::size_t> (blknum)
+          * block_logical_size_bytes_;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_RAM_H_ */
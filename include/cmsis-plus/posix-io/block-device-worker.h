@@ -0,0 +1,164 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_WORKER_H_
+#define CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_WORKER_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix-io/block-device.h>
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/utils/lists.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Block device worker class.
+     * @headerfile block-device-worker.h <cmsis-plus/posix-io/block-device-worker.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * A thread which executes, in submission order, the
+     * asynchronous requests of the block devices without native
+     * asynchronous support, using their synchronous functions.
+     *
+     * A worker can serve multiple devices; it is attached to
+     * a device with `block_device::worker()`.
+     *
+     * When destroyed, the queued requests are completed before
+     * the thread terminates.
+     */
+    class block_device_worker
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      block_device_worker (const char* name,
+                           const rtos::thread::attributes& attr =
+                               rtos::thread::initializer);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      block_device_worker (const block_device_worker&) = delete;
+      block_device_worker (block_device_worker&&) = delete;
+      block_device_worker&
+      operator= (const block_device_worker&) = delete;
+      block_device_worker&
+      operator= (block_device_worker&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      ~block_device_worker ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Add a request to the queue.
+       * @param [in] req Reference to a submitted request.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      enqueue (block_device_request& req);
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      static void*
+      run (void* args);
+
+      using requests_list = utils::intrusive_list<block_device_request,
+      utils::double_list_links, &block_device_request::links_>;
+
+      requests_list requests_;
+
+      rtos::semaphore_binary sem_;
+
+      bool volatile stopping_ = false;
+
+      // Must be the last, to start after the other members are ready.
+      rtos::thread thread_;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_BLOCK_DEVICE_WORKER_H_ */
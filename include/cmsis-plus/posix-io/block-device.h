@@ -37,6 +37,8 @@
 #endif
 
 #include <cmsis-plus/posix-io/device.h>
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/utils/lists.h>
 
 // ----------------------------------------------------------------------------
 
@@ -47,6 +49,8 @@ namespace os
     // ------------------------------------------------------------------------
 
     class block_device_impl;
+    class block_device_request;
+    class block_device_worker;
 
     // ========================================================================
 
@@ -117,6 +121,90 @@ namespace os
       virtual ssize_t
       write_block (const void* buf, blknum_t blknum, std::size_t nblocks = 1);
 
+      /**
+       * @brief Read consecutive blocks into multiple buffers.
+       * @param [in] iov Array of buffer descriptors.
+       * @param [in] iovcnt Number of buffers.
+       * @param [in] blknum The first block.
+       * @return The number of blocks read, or -1 if error.
+       * @details
+       * The length of each buffer must be a multiple of
+       * the logical block size.
+       */
+      virtual ssize_t
+      readv_block (const struct iovec* iov, int iovcnt, blknum_t blknum);
+
+      /**
+       * @brief Write consecutive blocks from multiple buffers.
+       * @param [in] iov Array of buffer descriptors.
+       * @param [in] iovcnt Number of buffers.
+       * @param [in] blknum The first block.
+       * @return The number of blocks written, or -1 if error.
+       * @details
+       * The length of each buffer must be a multiple of
+       * the logical block size.
+       */
+      virtual ssize_t
+      writev_block (const struct iovec* iov, int iovcnt, blknum_t blknum);
+
+      /**
+       * @brief Inform the device that blocks are no longer used.
+       * @param [in] blknum The first block.
+       * @param [in] nblocks The number of blocks.
+       * @retval 0 if successful.
+       * @retval -1 if error; errno is set.
+       * @details
+       * The content of the discarded blocks is undefined until
+       * they are written again. Flash devices use this to
+       * erase in advance, instead of during the next write.
+       */
+      virtual int
+      discard_blocks (blknum_t blknum, std::size_t nblocks);
+
+      /**
+       * @brief Start reading blocks, without waiting for completion.
+       * @param [in] req Reference to a request not in progress.
+       * @param [out] buf Pointer to the destination buffer.
+       * @param [in] blknum The first block.
+       * @param [in] nblocks The number of blocks.
+       * @retval 0 if the request was submitted.
+       * @retval -1 if the request was not submitted; errno is set.
+       * @details
+       * The request object and the buffer must be kept
+       * until the request completes.
+       */
+      virtual int
+      submit_read_block (block_device_request& req, void* buf,
+                         blknum_t blknum, std::size_t nblocks = 1);
+
+      /**
+       * @brief Start writing blocks, without waiting for completion.
+       * @param [in] req Reference to a request not in progress.
+       * @param [in] buf Pointer to the source buffer.
+       * @param [in] blknum The first block.
+       * @param [in] nblocks The number of blocks.
+       * @retval 0 if the request was submitted.
+       * @retval -1 if the request was not submitted; errno is set.
+       * @details
+       * The request object and the buffer must be kept
+       * until the request completes.
+       */
+      virtual int
+      submit_write_block (block_device_request& req, const void* buf,
+                          blknum_t blknum, std::size_t nblocks = 1);
+
+      /**
+       * @brief Set the worker used to execute submitted requests.
+       * @param [in] wrk Pointer to a worker, or `nullptr`.
+       * @par Returns
+       *  Nothing.
+       * @details
+       * Without a worker, devices without native asynchronous
+       * support execute the requests synchronously, in submit().
+       */
+      void
+      worker (block_device_worker* wrk);
+
       // ----------------------------------------------------------------------
 
       /**
@@ -212,6 +300,25 @@ namespace os
       virtual ssize_t
       do_write (const void* buf, std::size_t nbyte) override;
 
+      virtual ssize_t
+      do_readv (const struct iovec* iov, int iovcnt) override;
+
+      virtual ssize_t
+      do_writev (const struct iovec* iov, int iovcnt) override;
+
+      virtual ssize_t
+      do_pread (void* buf, std::size_t nbyte, off_t offset) override;
+
+      virtual ssize_t
+      do_pwrite (const void* buf, std::size_t nbyte, off_t offset) override;
+
+      virtual ssize_t
+      do_preadv (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+      virtual ssize_t
+      do_pwritev (const struct iovec* iov, int iovcnt, off_t offset)
+          override;
+
       virtual off_t
       do_lseek (off_t offset, int whence) override;
 
@@ -222,6 +329,82 @@ namespace os
       do_write_block (const void* buf, blknum_t blknum,
                       std::size_t nblocks) = 0;
 
+      /**
+       * @brief Read consecutive blocks into multiple buffers.
+       * @param [in] iov Array of validated buffer descriptors.
+       * @param [in] iovcnt Number of buffers.
+       * @param [in] blknum The first block.
+       * @return The number of blocks read, or -1 if error.
+       * @details
+       * Drivers able to chain DMA descriptors should override
+       * this. The default reads each group of buffers adjacent
+       * in memory with a separate `do_read_block()` call,
+       * and stops at the first short transfer.
+       */
+      virtual ssize_t
+      do_readv_block (const struct iovec* iov, int iovcnt, blknum_t blknum);
+
+      /**
+       * @brief Write consecutive blocks from multiple buffers.
+       * @param [in] iov Array of validated buffer descriptors.
+       * @param [in] iovcnt Number of buffers.
+       * @param [in] blknum The first block.
+       * @return The number of blocks written, or -1 if error.
+       * @details
+       * The default writes each group of buffers adjacent
+       * in memory with a separate `do_write_block()` call,
+       * and stops at the first short transfer.
+       */
+      virtual ssize_t
+      do_writev_block (const struct iovec* iov, int iovcnt, blknum_t blknum);
+
+      /**
+       * @brief Inform the device that blocks are no longer used.
+       * @param [in] blknum The first block of a validated range.
+       * @param [in] nblocks The number of blocks.
+       * @retval 0 if successful.
+       * @retval -1 if error; errno is set.
+       * @details
+       * The default is not implemented (ENOSYS).
+       */
+      virtual int
+      do_discard (blknum_t blknum, std::size_t nblocks);
+
+      /**
+       * @brief Map blocks in memory.
+       * @details
+       * The offset must be a multiple of the block size; the
+       * length is rounded up to whole blocks. The default maps
+       * a private copy, read with `do_read_block()`, through
+       * the cache if the device has one.
+       *
+       * Memory addressable devices (like execute-in-place flash)
+       * should override this and `do_munmap()` to return a pointer
+       * to the content.
+       */
+      virtual void*
+      do_mmap (std::size_t length, int prot, int flags, off_t offset)
+          override;
+
+      virtual int
+      do_munmap (void* addr, std::size_t length) override;
+
+      /**
+       * @brief Start an asynchronous request.
+       * @param [in] req Reference to a validated request.
+       * @retval 0 if the request was started.
+       * @retval -1 if the request was not started; errno is set.
+       * @details
+       * Devices with native support for queued transfers should
+       * override this and call `req.complete()`, possibly from
+       * an interrupt, when done.
+       *
+       * The default passes the request to the worker, if one
+       * was set, or executes it synchronously.
+       */
+      virtual int
+      do_submit (block_device_request& req);
+
       /**
        * @}
        */
@@ -233,6 +416,11 @@ namespace os
        * @cond ignore
        */
 
+      ssize_t
+      validate_vector (const struct iovec* iov, int iovcnt, off_t offset);
+
+      block_device_worker* worker_ = nullptr;
+
       std::size_t block_logical_size_bytes_ = 0;
 
       std::size_t block_physical_size_bytes_ = 0;
@@ -244,6 +432,198 @@ namespace os
        */
     };
 
+#pragma GCC diagnostic pop
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Asynchronous block device request.
+     * @headerfile block-device.h <cmsis-plus/posix-io/block-device.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * Allocated by the caller, passed to
+     * `block_device::submit_read_block()` or
+     * `block_device::submit_write_block()`, and reusable after
+     * completion.
+     *
+     * Completion can be waited for with `wait()`, polled with
+     * `done()` or notified via a callback; the callback is
+     * invoked in the context which completes the request,
+     * possibly an interrupt service routine, before the request
+     * is marked as done, thus it cannot resubmit it.
+     */
+    class block_device_request
+    {
+      // ----------------------------------------------------------------------
+
+    public:
+
+      using blknum_t = block_device::blknum_t;
+
+      using callback_t = void (*) (block_device_request& req, void* args);
+
+      enum class operation
+        : uint8_t
+          { none = 0, read, write
+      };
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      block_device_request (callback_t callback = nullptr, void* args =
+                                nullptr);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      block_device_request (const block_device_request&) = delete;
+      block_device_request (block_device_request&&) = delete;
+      block_device_request&
+      operator= (const block_device_request&) = delete;
+      block_device_request&
+      operator= (block_device_request&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      ~block_device_request ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Wait for the request to complete.
+       * @par Parameters
+       *  None.
+       * @return The number of blocks transferred, or -1 with errno set.
+       * @details
+       * Returns immediately if the request is already done.
+       */
+      ssize_t
+      wait (void);
+
+      bool
+      done (void) const;
+
+      /**
+       * @return The number of blocks transferred, or -1.
+       */
+      ssize_t
+      result (void) const;
+
+      /**
+       * @return The errno value if the request failed, 0 otherwise.
+       */
+      int
+      error (void) const;
+
+      // ----------------------------------------------------------------------
+      // Support functions, for implementations.
+
+      /**
+       * @brief Perform the transfer synchronously.
+       * @par Parameters
+       *  None.
+       * @return The number of blocks transferred, or -1 with errno set.
+       */
+      ssize_t
+      execute (void);
+
+      /**
+       * @brief Mark the request as completed.
+       * @param [in] result The number of blocks, or -1.
+       * @param [in] error The errno value, if failed.
+       * @par Returns
+       *  Nothing.
+       * @details
+       * Can be called from interrupt service routines.
+       */
+      void
+      complete (ssize_t result, int error);
+
+      block_device&
+      device (void) const;
+
+      operation
+      op (void) const;
+
+      void*
+      buffer (void) const;
+
+      blknum_t
+      blknum (void) const;
+
+      std::size_t
+      nblocks (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    public:
+
+      /**
+       * @cond ignore
+       */
+
+      // Intrusive node used to link the request in the queues.
+      utils::double_list_links links_;
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      friend class block_device;
+
+      block_device* device_ = nullptr;
+      void* buf_ = nullptr;
+      blknum_t blknum_ = 0;
+      std::size_t nblocks_ = 0;
+
+      callback_t callback_;
+      void* args_;
+
+      ssize_t volatile result_ = 0;
+      int volatile error_ = 0;
+      bool volatile done_ = true;
+      operation op_ = operation::none;
+
+      rtos::semaphore_binary sem_;
+
+      /**
+       * @endcond
+       */
+    };
+
 #pragma GCC diagnostic pop
 
     // ========================================================================
@@ -392,6 +772,27 @@ namespace os
         virtual ssize_t
         writev (const struct iovec* iov, int iovcnt) override;
 
+        virtual ssize_t
+        readv (const struct iovec* iov, int iovcnt) override;
+
+        virtual ssize_t
+        pread (void* buf, std::size_t nbyte, off_t offset) override;
+
+        virtual ssize_t
+        pwrite (const void* buf, std::size_t nbyte, off_t offset) override;
+
+        virtual ssize_t
+        preadv (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+        virtual ssize_t
+        pwritev (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+        virtual void*
+        mmap (std::size_t length, int prot, int flags, off_t offset) override;
+
+        virtual int
+        munmap (void* addr, std::size_t length) override;
+
         virtual int
         vfcntl (int cmd, std::va_list args) override;
 
@@ -409,6 +810,17 @@ namespace os
         write_block (const void* buf, blknum_t blknum, std::size_t nblocks = 1)
             override;
 
+        virtual ssize_t
+        readv_block (const struct iovec* iov, int iovcnt, blknum_t blknum)
+            override;
+
+        virtual ssize_t
+        writev_block (const struct iovec* iov, int iovcnt, blknum_t blknum)
+            override;
+
+        virtual int
+        discard_blocks (blknum_t blknum, std::size_t nblocks) override;
+
         virtual void
         sync (void) override;
 
@@ -468,6 +880,12 @@ namespace os
       return impl ().block_physical_size_bytes_;
     }
 
+    inline void
+    block_device::worker (block_device_worker* wrk)
+    {
+      impl ().worker_ = wrk;
+    }
+
     inline block_device_impl&
     block_device::impl (void) const
     {
@@ -476,6 +894,56 @@ namespace os
 
     // ========================================================================
 
+    inline bool
+    block_device_request::done (void) const
+    {
+      return done_;
+    }
+
+    inline ssize_t
+    block_device_request::result (void) const
+    {
+      return result_;
+    }
+
+    inline int
+    block_device_request::error (void) const
+    {
+      return error_;
+    }
+
+    inline block_device&
+    block_device_request::device (void) const
+    {
+      return *device_;
+    }
+
+    inline block_device_request::operation
+    block_device_request::op (void) const
+    {
+      return op_;
+    }
+
+    inline void*
+    block_device_request::buffer (void) const
+    {
+      return buf_;
+    }
+
+    inline block_device_request::blknum_t
+    block_device_request::blknum (void) const
+    {
+      return blknum_;
+    }
+
+    inline std::size_t
+    block_device_request::nblocks (void) const
+    {
+      return nblocks_;
+    }
+
+    // ========================================================================
+
     template<typename T>
       template<typename ... Args>
         block_device_implementable<T>::block_device_implementable (
@@ -595,6 +1063,116 @@ namespace os
         return block_device::writev (iov, iovcnt);
       }
 
+    template<typename T, typename L>
+      ssize_t
+      block_device_lockable<T, L>::readv (const struct iovec* iov, int iovcnt)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        trace::printf ("block_device_lockable::%s(0x0%X, %d) @%p\n", __func__,
+                       iov, iovcnt, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device::readv (iov, iovcnt);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_lockable<T, L>::pread (void* buf, std::size_t nbyte,
+                                          off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        trace::printf ("block_device_lockable::%s(0x0%X, %u, %d) @%p\n",
+                       __func__, buf, nbyte, offset, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device::pread (buf, nbyte, offset);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_lockable<T, L>::pwrite (const void* buf, std::size_t nbyte,
+                                           off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        trace::printf ("block_device_lockable::%s(0x0%X, %u, %d) @%p\n",
+                       __func__, buf, nbyte, offset, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device::pwrite (buf, nbyte, offset);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_lockable<T, L>::preadv (const struct iovec* iov, int iovcnt,
+                                           off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        trace::printf ("block_device_lockable::%s(0x0%X, %d, %d) @%p\n",
+                       __func__, iov, iovcnt, offset, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device::preadv (iov, iovcnt, offset);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_lockable<T, L>::pwritev (const struct iovec* iov, int iovcnt,
+                                            off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        trace::printf ("block_device_lockable::%s(0x0%X, %d, %d) @%p\n",
+                       __func__, iov, iovcnt, offset, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device::pwritev (iov, iovcnt, offset);
+      }
+
+    template<typename T, typename L>
+      void*
+      block_device_lockable<T, L>::mmap (std::size_t length, int prot,
+                                         int flags, off_t offset)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        trace::printf ("block_device_lockable::%s(%u, %d) @%p\n",
+                       __func__, length, offset, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device::mmap (length, prot, flags, offset);
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_lockable<T, L>::munmap (void* addr, std::size_t length)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        trace::printf ("block_device_lockable::%s(%p, %u) @%p\n",
+                       __func__, addr, length, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device::munmap (addr, length);
+      }
+
     template<typename T, typename L>
       int
       block_device_lockable<T, L>::vfcntl (int cmd, std::va_list args)
@@ -673,6 +1251,54 @@ namespace os
         return block_device::write_block (buf, blknum, nblocks);
       }
 
+    template<typename T, typename L>
+      ssize_t
+      block_device_lockable<T, L>::readv_block (const struct iovec* iov,
+                                                int iovcnt, blknum_t blknum)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        trace::printf ("block_device_lockable::%s(%p, %d, %u) @%p\n",
+                       __func__, iov, iovcnt, blknum, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device::readv_block (iov, iovcnt, blknum);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      block_device_lockable<T, L>::writev_block (const struct iovec* iov,
+                                                 int iovcnt, blknum_t blknum)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        trace::printf ("block_device_lockable::%s(%p, %d, %u) @%p\n",
+                       __func__, iov, iovcnt, blknum, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device::writev_block (iov, iovcnt, blknum);
+      }
+
+    template<typename T, typename L>
+      int
+      block_device_lockable<T, L>::discard_blocks (blknum_t blknum,
+                                                   std::size_t nblocks)
+      {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+        trace::printf ("block_device_lockable::%s(%u, %u) @%p\n", __func__,
+                       blknum, nblocks, this);
+#endif
+
+        std::lock_guard<L> lock
+          { locker_ };
+
+        return block_device::discard_blocks (blknum, nblocks);
+      }
+
     template<typename T, typename L>
       void
       block_device_lockable<T, L>::sync (void)
@@ -143,6 +143,24 @@ extern "C"
   __attribute__((weak, alias ("__posix_opendir")))
   opendir (const char* dirname);
 
+  int __attribute__((weak, alias ("__posix_pipe")))
+  pipe (int fildes[2]);
+
+  int __attribute__((weak, alias ("__posix_poll")))
+  poll (struct pollfd fds[], nfds_t nfds, int timeout);
+
+  ssize_t __attribute__((weak, alias ("__posix_pread")))
+  pread (int fildes, void* buf, size_t nbyte, off_t offset);
+
+  ssize_t __attribute__((weak, alias ("__posix_preadv")))
+  preadv (int fildes, const struct iovec* iov, int iovcnt, off_t offset);
+
+  ssize_t __attribute__((weak, alias ("__posix_pwrite")))
+  pwrite (int fildes, const void* buf, size_t nbyte, off_t offset);
+
+  ssize_t __attribute__((weak, alias ("__posix_pwritev")))
+  pwritev (int fildes, const struct iovec* iov, int iovcnt, off_t offset);
+
   int __attribute__((weak, alias ("__posix_raise")))
   raise (int sig);
 
@@ -159,6 +177,9 @@ extern "C"
   ssize_t __attribute__((weak, alias ("__posix_readlink")))
   readlink (const char* path, char* buf, size_t bufsize);
 
+  ssize_t __attribute__((weak, alias ("__posix_readv")))
+  readv (int fildes, const struct iovec* iov, int iovcnt);
+
   ssize_t __attribute__((weak, alias ("__posix_recv")))
   recv (int socket, void* buffer, size_t length, int flags);
 
@@ -185,6 +206,9 @@ extern "C"
   ssize_t __attribute__((weak, alias ("__posix_send")))
   send (int socket, const void* buffer, size_t length, int flags);
 
+  ssize_t __attribute__((weak, alias ("__posix_sendfile")))
+  sendfile (int out_fd, int in_fd, off_t* offset, size_t count);
+
   ssize_t __attribute__((weak, alias ("__posix_sendmsg")))
   sendmsg (int socket, const struct msghdr* message, int flags);
 
@@ -210,6 +234,10 @@ extern "C"
   socketpair (int domain, int type, int protocol, int socket_vector[2]);
 #endif
 
+  ssize_t __attribute__((weak, alias ("__posix_splice")))
+  splice (int fd_in, off_t* off_in, int fd_out, off_t* off_out, size_t len,
+          unsigned int flags);
+
   int __attribute__((weak, alias ("__posix_stat")))
   stat (const char* path, struct stat* buf);
 
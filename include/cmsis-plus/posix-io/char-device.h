@@ -168,6 +168,23 @@ namespace os
       virtual void
       do_sync (void) override;
 
+      /**
+       * @brief Query the readiness.
+       * @param [in] events Mask of the events of interest.
+       * @return The mask of the events ready.
+       * @details
+       * Character devices can block, so there is no default;
+       * drivers must report the received data (POLLIN), the free
+       * transmit space (POLLOUT) and the disconnected devices
+       * (POLLHUP), without blocking.
+       *
+       * Drivers must also call `notify_readiness()`, usually from
+       * the interrupt handlers, each time one of them may have
+       * changed; otherwise threads in `poll()` are not woken up.
+       */
+      virtual int
+      do_poll (int events) override = 0;
+
       /**
        * @}
        */
@@ -0,0 +1,377 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_DENTRY_CACHE_H_
+#define CMSIS_PLUS_POSIX_IO_DENTRY_CACHE_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix-io/types.h>
+#include <cmsis-plus/utils/lists.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <sys/stat.h>
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Longest path (without the terminator) kept in the dentry cache.
+ * @details
+ * Lookups of longer paths bypass the cache.
+ */
+#if !defined(OS_INTEGER_POSIX_IO_DENTRY_PATH_MAX)
+#define OS_INTEGER_POSIX_IO_DENTRY_PATH_MAX (63)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Directory entry cache class.
+     * @headerfile dentry-cache.h <cmsis-plus/posix-io/dentry-cache.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * A fixed size cache of path lookups in a mounted file system,
+     * attached with `file_system::dentries()`.
+     *
+     * Entries are keyed by the path relative to the mount point,
+     * which identifies both the parent directory and the name.
+     * Positive entries remember the file type and an opaque
+     * cookie the file system implementation can use to find
+     * the entry again without scanning the parent directory
+     * (like a directory cluster and index); negative entries
+     * remember names known not to exist, so repeated failed
+     * lookups (like searching a path list) do not reach the
+     * media.
+     *
+     * The least recently used entry is reused when the cache
+     * is full. Entries are invalidated by the file system
+     * on `unlink()`, `rename()`, `mkdir()` and `rmdir()`;
+     * invalidating a directory also drops all entries below it.
+     *
+     * Only canonical paths are cached (absolute, without empty,
+     * `.` or `..` components and without a trailing `/`), since
+     * other spellings of the same path could not be invalidated.
+     * File systems with case insensitive names (like FAT) must
+     * construct the cache with `case_insensitive` set.
+     */
+    class dentry_cache
+    {
+      // ----------------------------------------------------------------------
+
+    public:
+
+      /**
+       * @brief Cached directory entry.
+       */
+      class entry
+      {
+      public:
+
+        /**
+         * @brief The entry is known not to exist.
+         */
+        bool negative = false;
+
+        /**
+         * @brief The file type bits (`S_IFMT`) of a positive entry.
+         */
+        mode_t mode = 0;
+
+        /**
+         * @brief Implementation specific data of a positive entry;
+         *  0 if not known.
+         */
+        uintptr_t cookie = 0;
+
+        /**
+         * @cond ignore
+         */
+
+        utils::double_list_links lru_links_;
+        entry* hash_next_ = nullptr;
+        std::size_t hash_ = 0;
+        std::size_t length_ = 0;
+        char path_[OS_INTEGER_POSIX_IO_DENTRY_PATH_MAX + 1];
+
+        /**
+         * @endcond
+         */
+      };
+
+      /**
+       * @brief Cache statistics.
+       */
+      class statistics
+      {
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        void
+        clear (void);
+
+        /**
+         * @}
+         */
+
+        /**
+         * @name Public Member Variables
+         * @{
+         */
+
+        /**
+         * @brief Number of lookups served from the cache.
+         */
+        std::size_t hits = 0;
+
+        /**
+         * @brief Number of lookups not found in the cache.
+         */
+        std::size_t misses = 0;
+
+        /**
+         * @brief Number of valid entries reused for other paths.
+         */
+        std::size_t evictions = 0;
+
+        /**
+         * @brief Number of entries dropped by invalidations.
+         */
+        std::size_t invalidations = 0;
+
+        /**
+         * @}
+         */
+      };
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      dentry_cache (std::size_t nentries, bool case_insensitive = false);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      dentry_cache (const dentry_cache&) = delete;
+      dentry_cache (dentry_cache&&) = delete;
+      dentry_cache&
+      operator= (const dentry_cache&) = delete;
+      dentry_cache&
+      operator= (dentry_cache&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      ~dentry_cache ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Find a path.
+       * @param [in] path Path relative to the mount point.
+       * @return Pointer to the entry, or `nullptr` if not cached.
+       */
+      entry*
+      lookup (const char* path);
+
+      /**
+       * @brief Remember a path.
+       * @param [in] path Path relative to the mount point.
+       * @param [in] negative `true` if the path does not exist.
+       * @param [in] mode The file type bits of an existing path.
+       * @param [in] cookie Implementation specific data, or 0.
+       * @return Pointer to the entry, or `nullptr` if the path
+       *  cannot be cached.
+       * @details
+       * An existing entry for the same path is updated, otherwise
+       * the least recently used entry is reused. Updating a positive
+       * entry with a 0 cookie keeps the previous cookie.
+       */
+      entry*
+      insert (const char* path, bool negative, mode_t mode = 0,
+              uintptr_t cookie = 0);
+
+      /**
+       * @brief Forget a path and everything below it.
+       * @param [in] path Path relative to the mount point.
+       * @par Returns
+       *  Nothing.
+       * @details
+       * If the path is not canonical, all entries are dropped.
+       */
+      void
+      invalidate (const char* path);
+
+      /**
+       * @brief Forget all paths.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      clear (void);
+
+      class statistics&
+      statistics (void);
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      using entries_list = utils::intrusive_list<entry,
+      utils::double_list_links, &entry::lru_links_>;
+
+      bool
+      canonical (const char* path, std::size_t* length) const;
+
+      std::size_t
+      hash (const char* path, std::size_t len) const;
+
+      bool
+      matches (const char* path1, const char* path2, std::size_t len) const;
+
+      entry*
+      find (const char* path, std::size_t h, std::size_t len);
+
+      void
+      hash_unlink (entry* e);
+
+      void
+      release (entry* e);
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      std::size_t num_entries_;
+      std::size_t hash_mask_;
+
+      entry* entries_ = nullptr;
+      entry** hash_table_ = nullptr;
+
+      // Valid entries, least recently used first.
+      entries_list lru_list_;
+      // Entries without content.
+      entries_list free_list_;
+
+      bool case_insensitive_;
+
+      class statistics statistics_;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline void
+    dentry_cache::statistics::clear (void)
+    {
+      *this = {};
+    }
+
+    inline class dentry_cache::statistics&
+    dentry_cache::statistics (void)
+    {
+      return statistics_;
+    }
+
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+// ----------------------------------------------------------------------------
+
+#endif /* CMSIS_PLUS_POSIX_IO_DENTRY_CACHE_H_ */
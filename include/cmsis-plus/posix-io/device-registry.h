@@ -45,6 +45,15 @@
 
 // ----------------------------------------------------------------------------
 
+/**
+ * @brief Number of buckets in the devices registry hash table.
+ */
+#if !defined(OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS)
+#define OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS (16)
+#endif
+
+// ----------------------------------------------------------------------------
+
 namespace os
 {
   namespace posix
@@ -55,6 +64,11 @@ namespace os
      * @brief Devices registry static class.
      * @headerfile device-registry.h <cmsis-plus/posix-io/device-registry.h>
      * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * Besides the list of all devices, the devices are also
+     * linked in a hash table indexed by the device name, so
+     * identifying a device is proportional to the length of the
+     * path, not to the number of devices.
      */
     template<typename T>
       class device_registry
@@ -134,6 +148,14 @@ namespace os
         utils::double_list_links, &device::registry_links_, T>;
         static device_list registry_list__;
 
+        using hash_list = utils::intrusive_list<device,
+        utils::double_list_links, &device::hash_links_, T>;
+        static hash_list hash_table__[
+            OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS];
+
+        static hash_list&
+        bucket (const char* name);
+
         /**
          * @endcond
          */
@@ -168,12 +190,18 @@ namespace os
 #endif // DEBUG
 
         registry_list__.link (*device);
+        bucket (device->name ()).link (*device);
 
         trace::printf ("Device '%s%s' linked.\n", value_type::device_prefix (),
                        device->name ());
       }
 
     /**
+     * @details
+     * The name is first searched in the hash table; if not
+     * found, all devices are checked, for the devices
+     * which redefine `match_name()` to accept other names.
+     *
      * return pointer to device or nullptr if not found.
      */
     template<typename T>
@@ -192,6 +220,14 @@ namespace os
         // The prefix was identified; try to match the rest of the path.
         auto name = path + std::strlen (prefix);
 
+        for (auto&& p : bucket (name))
+          {
+            if (p.match_name (name))
+              {
+                return static_cast<value_type*> (&p);
+              }
+          }
+
         for (auto&& p : registry_list__)
           {
             if (p.match_name (name))
@@ -208,6 +244,22 @@ namespace os
      * @cond ignore
      */
 
+    template<typename T>
+      typename device_registry<T>::hash_list&
+      device_registry<T>::bucket (const char* name)
+      {
+        return hash_table__[hash_name (name, std::strlen (name))
+            % OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS];
+      }
+
+    /**
+     * @endcond
+     */
+
+    /**
+     * @cond ignore
+     */
+
 #pragma GCC diagnostic push
 #if defined(__clang__)
 #pragma clang diagnostic ignored "-Wexit-time-destructors"
@@ -218,6 +270,11 @@ namespace os
     template<typename T>
       typename device_registry<T>::device_list device_registry<T>::registry_list__;
 
+    // Initialised to 0 by BSS.
+    template<typename T>
+      typename device_registry<T>::hash_list device_registry<T>::hash_table__[
+          OS_INTEGER_POSIX_IO_DEVICE_REGISTRY_BUCKETS];
+
 #pragma GCC diagnostic pop
 
   /**
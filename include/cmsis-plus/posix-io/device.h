@@ -183,6 +183,10 @@ namespace os
       // Must be public.
       utils::double_list_links registry_links_;
 
+      // Intrusive node used to link this device to the registry
+      // hash table bucket. Must be public.
+      utils::double_list_links hash_links_;
+
       /**
        * @endcond
        */
@@ -36,6 +36,7 @@
 #include <cmsis-plus/os-app-config.h>
 #endif
 
+#include <cmsis-plus/posix-io/shared-locker.h>
 #include <cmsis-plus/utils/lists.h>
 #include <cmsis-plus/posix/dirent.h>
 
@@ -353,6 +354,13 @@ namespace os
 
     // ========================================================================
 
+    /**
+     * @details
+     * The locker is the file system locker; when it can also be
+     * owned shared, the operations lock the file system shared
+     * and the directory exclusively, see `locker_traits`; `T`
+     * must then be safe with concurrent accesses to other objects.
+     */
     template<typename T, typename L>
       class directory_lockable : public directory
       {
@@ -362,6 +370,8 @@ namespace os
 
         using value_type = T;
         using lockable_type = L;
+        using object_locker_type =
+        typename locker_traits<L>::object_locker_type;
 
         // --------------------------------------------------------------------
 
@@ -440,6 +450,8 @@ namespace os
 
         lockable_type& locker_;
 
+        object_locker_type object_locker_;
+
         /**
          * @endcond
          */
@@ -549,8 +561,10 @@ namespace os
         trace::printf ("directory_lockable::%s() @%p\n", __func__, this);
 #endif
 
-        std::lock_guard<L> lock
+        shared_lock_guard<L> fs_lock
           { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
 
         return directory::read ();
       }
@@ -563,8 +577,10 @@ namespace os
         trace::printf ("directory_lockable::%s() @%p\n", __func__, this);
 #endif
 
-        std::lock_guard<L> lock
+        shared_lock_guard<L> fs_lock
           { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
 
         return directory::rewind ();
       }
@@ -0,0 +1,271 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_EVENT_POLL_H_
+#define CMSIS_PLUS_POSIX_IO_EVENT_POLL_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/rtos/os.h>
+#include <cmsis-plus/utils/lists.h>
+
+#include <cstdint>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Event poll class.
+     * @headerfile event-poll.h <cmsis-plus/posix-io/event-poll.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * A native equivalent of the Linux `epoll` interface.
+     *
+     * The descriptors of interest are registered once, with
+     * `add()`, and remain registered until `remove()`. When the
+     * readiness of an object changes, the notification moves the
+     * descriptor to the ready list, so `wait()` checks only
+     * the descriptors which may be ready, not all of them.
+     *
+     * In the default, level-triggered, mode, a descriptor remains
+     * in the ready list as long as it is ready; with the
+     * `edge_triggered` flag, it is reported only once after
+     * each notification.
+     *
+     * Usually one thread, the event loop, waits, but descriptors
+     * can be registered, changed and removed from other threads;
+     * a mutex protects the interests while they are checked. The
+     * functions must not be called from interrupt service routines.
+     */
+    class event_poll
+    {
+      // ----------------------------------------------------------------------
+
+    public:
+
+      /**
+       * @name Types & Constants
+       * @{
+       */
+
+      /**
+       * @brief Flag to be added to the events, to report only
+       *  the changes in readiness.
+       */
+      static constexpr uint32_t edge_triggered = 1u << 31;
+
+      /**
+       * @brief Event reported by `wait()`.
+       */
+      struct event
+      {
+        uint32_t events;
+        void* data;
+      };
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      event_poll (const char* name = nullptr);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      event_poll (const event_poll&) = delete;
+      event_poll (event_poll&&) = delete;
+      event_poll&
+      operator= (const event_poll&) = delete;
+      event_poll&
+      operator= (event_poll&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      ~event_poll ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Register a descriptor.
+       * @param [in] fildes File descriptor.
+       * @param [in] events Mask of POLLIN, POLLOUT, ... events,
+       *  possibly with `edge_triggered`.
+       * @param [in] data User data, returned with the events.
+       * @retval 0 The descriptor was registered.
+       * @retval -1 Error, with errno set to EBADF, EEXIST or ENOMEM.
+       */
+      int
+      add (int fildes, uint32_t events, void* data = nullptr);
+
+      /**
+       * @brief Change the events of a registered descriptor.
+       * @param [in] fildes File descriptor.
+       * @param [in] events Mask of events, possibly with `edge_triggered`.
+       * @param [in] data User data, returned with the events.
+       * @retval 0 The registration was changed.
+       * @retval -1 Error, with errno set to ENOENT.
+       */
+      int
+      modify (int fildes, uint32_t events, void* data = nullptr);
+
+      /**
+       * @brief Unregister a descriptor.
+       * @param [in] fildes File descriptor.
+       * @retval 0 The descriptor was unregistered.
+       * @retval -1 Error, with errno set to ENOENT.
+       */
+      int
+      remove (int fildes);
+
+      /**
+       * @brief Wait for events.
+       * @param [out] events Array where to store the events.
+       * @param [in] maxevents Size of the array.
+       * @param [in] timeout Timeout in milliseconds, negative
+       *  to wait forever, zero to not wait.
+       * @return The number of events stored, 0 on timeout,
+       *  or -1 if error.
+       */
+      int
+      wait (event* events, std::size_t maxevents, int timeout);
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      class interest : public poll_waiter
+      {
+      public:
+
+        interest (event_poll& owner, int fildes, class io* io);
+
+        // The rule of five.
+        interest (const interest&) = delete;
+        interest (interest&&) = delete;
+        interest&
+        operator= (const interest&) = delete;
+        interest&
+        operator= (interest&&) = delete;
+
+        virtual
+        ~interest () override;
+
+        virtual void
+        notify (void) override;
+
+        // Intrusive node used to link the descriptor to the interest list.
+        utils::double_list_links interest_links_;
+
+        // Intrusive node used to link the descriptor to the ready list.
+        utils::double_list_links ready_links_;
+
+        event_poll& owner_;
+        class io* io_;
+        void* data_ = nullptr;
+        uint32_t events_ = 0;
+        int fildes_;
+      };
+
+      using interest_list = utils::intrusive_list<interest,
+      utils::double_list_links, &interest::interest_links_>;
+
+      using ready_list = utils::intrusive_list<interest,
+      utils::double_list_links, &interest::ready_links_>;
+
+      interest*
+      find (int fildes);
+
+      void
+      make_ready (interest& in);
+
+      interest_list interests_;
+      ready_list ready_;
+
+      // Protects the interests against concurrent changes.
+      rtos::mutex mutex_;
+
+      rtos::semaphore_binary sem_;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_EVENT_POLL_H_ */
@@ -39,6 +39,7 @@
 #include <cmsis-plus/posix-io/types.h>
 
 #include <cstddef>
+#include <cstdint>
 #include <cassert>
 
 // ----------------------------------------------------------------------------
@@ -59,6 +60,12 @@ namespace os
      * @brief File descriptors manager static class.
      * @headerfile file-descriptors-manager.h <cmsis-plus/posix-io/file-descriptors-manager.h>
      * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * The free descriptors are kept in a bitmap, so the lowest
+     * available descriptor is found one word at a time, with a
+     * find-first-set instruction, and the number of used
+     * descriptors is maintained by `allocate()`, `assign()`
+     * and `deallocate()`.
      */
     class file_descriptors_manager
     {
@@ -145,6 +152,21 @@ namespace os
 
       static class io** descriptors_array__;
 
+      // One bit per descriptor, set when free.
+      using bitmap_word_t = uint32_t;
+      static constexpr std::size_t bitmap_word_bits__ = 32;
+
+      static bitmap_word_t* free_bitmap__;
+
+      // Descriptors in use, excluding the reserved ones.
+      static std::size_t used__;
+
+      static void
+      mark_used (std::size_t fildes);
+
+      static void
+      mark_free (std::size_t fildes);
+
       /**
        * @endcond
        */
@@ -168,6 +190,12 @@ namespace os
       return size__;
     }
 
+    inline size_t
+    file_descriptors_manager::used (void)
+    {
+      return reserved__ + used__;
+    }
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
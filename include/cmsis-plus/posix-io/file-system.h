@@ -38,6 +38,8 @@
 
 #include <cmsis-plus/posix-io/file.h>
 #include <cmsis-plus/posix-io/directory.h>
+#include <cmsis-plus/posix-io/dentry-cache.h>
+#include <cmsis-plus/posix-io/block-device.h>
 
 #include <cmsis-plus/utils/lists.h>
 
@@ -45,6 +47,7 @@
 
 #include <mutex>
 #include <cstdarg>
+#include <cassert>
 #include <sys/stat.h>
 #include <utime.h>
 
@@ -52,6 +55,13 @@
 
 #define FF_MOUNT_FLAGS_HAS_VOLUME   (1)
 
+/**
+ * @brief Number of buckets in the mount points hash table.
+ */
+#if !defined(OS_INTEGER_POSIX_IO_MOUNT_BUCKETS)
+#define OS_INTEGER_POSIX_IO_MOUNT_BUCKETS (8)
+#endif
+
 // ----------------------------------------------------------------------------
 
 namespace os
@@ -291,6 +301,40 @@ namespace os
       virtual int
       statvfs (struct statvfs* buf);
 
+      /**
+       * @brief Attach a directory entry cache.
+       * @param [in] cache Pointer to the cache, or `nullptr` to
+       *  detach it.
+       * @par Returns
+       *  Nothing.
+       * @details
+       * The cache is cleared, and from now on path lookups known
+       * to fail are answered without calling the implementation.
+       * The same cache must not be shared by several file systems.
+       */
+      void
+      dentries (dentry_cache* cache);
+
+      dentry_cache*
+      dentries (void) const;
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+      /**
+       * @brief Get the I/O statistics.
+       * @par Parameters
+       *  None.
+       * @return A reference to the statistics of the file system.
+       * @details
+       * The reads and writes of all files are added here;
+       * the other operations are the metadata operations, like
+       * `open()`, `stat()`, `mkdir()`, `unlink()` or `sync()`.
+       */
+      io_statistics&
+      statistics (void);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
     public:
 
       // ----------------------------------------------------------------------
@@ -362,6 +406,23 @@ namespace os
       // ----------------------------------------------------------------------
     protected:
 
+      /**
+       * @cond ignore
+       */
+
+      bool
+      cached_negative (const char* path);
+
+      void
+      cache_result (const char* path, int ret, mode_t mode);
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
       /**
        * @cond ignore
        */
@@ -376,6 +437,8 @@ namespace os
 
       const char* mounted_path_ = nullptr;
 
+      std::size_t mounted_path_length_ = 0;
+
       /**
        * @endcond
        */
@@ -392,6 +455,10 @@ namespace os
       // Must be public. The constructor clears the pointers.
       utils::double_list_links mount_manager_links_;
 
+      // Intrusive node used to link this file system to the
+      // mount points hash table bucket.
+      utils::double_list_links mount_hash_links_;
+
       /**
        * @endcond
        */
@@ -408,6 +475,15 @@ namespace os
       utils::double_list_links, &file_system::mount_manager_links_>;
       static mounted_list mounted_list__;
 
+      // Mount points indexed by the first component of the path.
+      using mounted_hash_list = utils::intrusive_list<file_system,
+      utils::double_list_links, &file_system::mount_hash_links_>;
+      static mounted_hash_list mounted_hash__[
+          OS_INTEGER_POSIX_IO_MOUNT_BUCKETS];
+
+      static mounted_hash_list&
+      mounted_bucket (const char* path);
+
       static file_system* mounted_root__;
 
       /**
@@ -417,6 +493,9 @@ namespace os
 
     // ========================================================================
 
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
     class file_system_impl
     {
       // ----------------------------------------------------------------------
@@ -432,6 +511,17 @@ namespace os
 
       file_system_impl (block_device& device);
 
+      /**
+       * @brief Construct a file system implementation without
+       *  a block device.
+       * @par Parameters
+       *  None.
+       * @details
+       * For file systems kept in memory; `device()` must
+       * not be used.
+       */
+      file_system_impl (void);
+
       /**
        * @cond ignore
        */
@@ -512,9 +602,87 @@ namespace os
       // ----------------------------------------------------------------------
       // Support functions.
 
+      /**
+       * @brief Get the block device.
+       * @par Parameters
+       *  None.
+       * @return Reference to the block device.
+       * @details
+       * Not available for file systems without a block device,
+       * like tmpfs; check with `has_device()` first when the
+       * file system type is not known.
+       */
       block_device&
       device (void) const;
 
+      /**
+       * @brief Check if the file system has a block device.
+       * @par Parameters
+       *  None.
+       * @retval true The file system uses a block device.
+       * @retval false The file system is kept in memory.
+       */
+      bool
+      has_device (void) const;
+
+      /**
+       * @brief Check if the file system can be used.
+       * @par Parameters
+       *  None.
+       * @retval true The block device is opened, or there is
+       *  no block device.
+       * @retval false The block device is not opened.
+       */
+      bool
+      device_ready (void) const;
+
+      /**
+       * @brief Get the directory entry cache.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the cache, or `nullptr` if none attached.
+       * @details
+       * Implementations can use the cookie of positive entries
+       * to locate directory entries without scanning the parent
+       * directory, and should store it with `insert()` when
+       * a lookup is resolved. The cookie must identify the
+       * directory entry itself, since the cached entries are
+       * only invalidated when names are added or removed.
+       */
+      dentry_cache*
+      dentries (void) const;
+
+      /**
+       * @brief Inform the device that blocks were freed.
+       * @param [in] blknum The first block.
+       * @param [in] nblocks The number of blocks.
+       * @retval 0 if successful or not supported by the device.
+       * @retval -1 if error; errno is set.
+       * @details
+       * To be called by the implementations when the clusters
+       * of a deleted or truncated file are released.
+       */
+      int
+      discard_blocks (block_device::blknum_t blknum, std::size_t nblocks);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+      /**
+       * @brief Record an operation of the file system.
+       * @param [in] begin The high resolution time of the start.
+       * @param [in] ret The result of the operation.
+       * @par Returns
+       *  Nothing.
+       * @details
+       * The counters are shared by all threads which own
+       * the file system shared, so they are updated in a
+       * scheduler critical section.
+       */
+      void
+      account_other (rtos::clock::timestamp_t begin, ssize_t ret);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       /**
        * @}
        */
@@ -526,15 +694,26 @@ namespace os
        * @cond ignore
        */
 
-      block_device& device_;
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      io_statistics statistics_;
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      block_device* device_ = nullptr;
 
       file_system* fs_ = nullptr;
 
+      dentry_cache* dentries_ = nullptr;
+
+      // Cleared when the device does not implement discard.
+      bool discard_supported_ = true;
+
       /**
        * @endcond
        */
     };
 
+#pragma GCC diagnostic pop
+
     // ========================================================================
 
     template<typename T>
@@ -559,6 +738,16 @@ namespace os
           file_system_implementable (const char* name, block_device& device,
                                      Args&&... args);
 
+        /**
+         * @brief Construct a file system without a block device.
+         * @details
+         * For file systems kept in memory, like tmpfs; the
+         * implementation is constructed with the remaining arguments.
+         */
+        template<typename ... Args>
+          file_system_implementable (const char* name, std::nullptr_t device,
+                                     Args&&... args);
+
         /**
          * @cond ignore
          */
@@ -615,6 +804,18 @@ namespace os
 
     // ========================================================================
 
+    /**
+     * @details
+     * When the locker can also be owned shared, metadata reads
+     * are locked shared, and the structural changes exclusively;
+     * see `locker_traits`.
+     *
+     * Choose such a locker only for implementations which are
+     * safe with concurrent metadata reads and concurrent transfers
+     * on different files; for the others, like the ChaN FatFS
+     * built without `FF_FS_REENTRANT`, keep an exclusive locker,
+     * like `rtos::mutex`.
+     */
     template<typename T, typename L>
       class file_system_lockable : public file_system
       {
@@ -638,6 +839,10 @@ namespace os
           file_system_lockable (const char* name, block_device& device,
                                 lockable_type& locker, Args&&... args);
 
+        template<typename ... Args>
+          file_system_lockable (const char* name, std::nullptr_t device,
+                                lockable_type& locker, Args&&... args);
+
         /**
          * @cond ignore
          */
@@ -791,6 +996,22 @@ namespace os
       return impl ().device ();
     }
 
+    inline dentry_cache*
+    file_system::dentries (void) const
+    {
+      return impl ().dentries_;
+    }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+    inline io_statistics&
+    file_system::statistics (void)
+    {
+      return impl ().statistics_;
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
     inline void
     file_system::add_deferred_file (file* fil)
     {
@@ -964,7 +1185,34 @@ namespace os
     inline block_device&
     file_system_impl::device (void) const
     {
-      return device_;
+      assert(device_ != nullptr);
+
+      return *device_;
+    }
+
+    inline bool
+    file_system_impl::has_device (void) const
+    {
+      return device_ != nullptr;
+    }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+    inline void
+    file_system_impl::account_other (rtos::clock::timestamp_t begin,
+                                     ssize_t ret)
+    {
+      rtos::scheduler::critical_section scs;
+
+      statistics_.other.record (begin, ret);
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+    inline dentry_cache*
+    file_system_impl::dentries (void) const
+    {
+      return dentries_;
     }
 
     // ========================================================================
@@ -984,6 +1232,22 @@ namespace os
 #endif
         }
 
+    template<typename T>
+      template<typename ... Args>
+        file_system_implementable<T>::file_system_implementable (
+            const char* name, std::nullptr_t device __attribute__((unused)),
+            Args&&... args) :
+            file_system
+              { impl_instance_, name }, //
+            impl_instance_
+              { std::forward<Args>(args)... }
+        {
+#if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
+          trace::printf ("file_system_implementable::%s(\"%s\")=@%p\n",
+                         __func__, name_, this);
+#endif
+        }
+
     template<typename T>
       file_system_implementable<T>::~file_system_implementable ()
       {
@@ -1018,6 +1282,21 @@ namespace os
 #endif
         }
 
+    template<typename T, typename L>
+      template<typename ... Args>
+        file_system_lockable<T, L>::file_system_lockable (
+            const char* name, std::nullptr_t device __attribute__((unused)),
+            lockable_type& locker, Args&&... args) :
+            file_system
+              { impl_instance_, name }, //
+            impl_instance_
+              { locker, std::forward<Args>(args)... }
+        {
+#if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
+          trace::printf ("file_system_lockable::%s()=%p\n", __func__, this);
+#endif
+        }
+
     template<typename T, typename L>
       file_system_lockable<T, L>::~file_system_lockable ()
       {
@@ -1125,7 +1404,8 @@ namespace os
       int
       file_system_lockable<T, L>::stat (const char* path, struct stat* buf)
       {
-        std::lock_guard<L> lock
+        // A metadata read, shared if possible.
+        shared_lock_guard<L> lock
           { impl_instance_.locker () };
 
         return file_system::stat (path, buf);
@@ -1178,7 +1458,8 @@ namespace os
       int
       file_system_lockable<T, L>::statvfs (struct statvfs* buf)
       {
-        std::lock_guard<L> lock
+        // A metadata read, shared if possible.
+        shared_lock_guard<L> lock
           { impl_instance_.locker () };
 
         return file_system::statvfs (buf);
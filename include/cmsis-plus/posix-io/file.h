@@ -37,6 +37,7 @@
 #endif
 
 #include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/posix-io/shared-locker.h>
 #include <cmsis-plus/utils/lists.h>
 #include <cmsis-plus/posix/utime.h>
 #include <cmsis-plus/posix/sys/statvfs.h>
@@ -223,6 +224,19 @@ namespace os
       virtual int
       do_fsync (void) = 0;
 
+      virtual ssize_t
+      do_pread (void* buf, std::size_t nbyte, off_t offset) override;
+
+      virtual ssize_t
+      do_pwrite (const void* buf, std::size_t nbyte, off_t offset) override;
+
+      virtual ssize_t
+      do_preadv (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+      virtual ssize_t
+      do_pwritev (const struct iovec* iov, int iovcnt, off_t offset)
+          override;
+
       // ----------------------------------------------------------------------
       // Support functions.
 
@@ -325,6 +339,19 @@ namespace os
 
     // ========================================================================
 
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @details
+     * The locker is the file system locker; when it can also be
+     * owned shared, the operations lock the file system shared
+     * and the file exclusively, see `locker_traits`.
+     *
+     * Shared lockers let reads and writes on different files run
+     * at the same time, so `T` must support it; otherwise use an
+     * exclusive locker, like `rtos::mutex`.
+     */
     template<typename T, typename L>
       class file_lockable : public file
       {
@@ -334,6 +361,8 @@ namespace os
 
         using value_type = T;
         using lockable_type = L;
+        using object_locker_type =
+        typename locker_traits<L>::object_locker_type;
 
         // --------------------------------------------------------------------
 
@@ -389,6 +418,27 @@ namespace os
         virtual ssize_t
         writev (const struct iovec* iov, int iovcnt) override;
 
+        virtual ssize_t
+        readv (const struct iovec* iov, int iovcnt) override;
+
+        virtual ssize_t
+        pread (void* buf, std::size_t nbyte, off_t offset) override;
+
+        virtual ssize_t
+        pwrite (const void* buf, std::size_t nbyte, off_t offset) override;
+
+        virtual ssize_t
+        preadv (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+        virtual ssize_t
+        pwritev (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+        virtual void*
+        mmap (std::size_t length, int prot, int flags, off_t offset) override;
+
+        virtual int
+        munmap (void* addr, std::size_t length) override;
+
         virtual int
         vfcntl (int cmd, std::va_list args) override;
 
@@ -404,6 +454,13 @@ namespace os
         virtual int
         fsync (void) override;
 
+        virtual int
+        setvbuf (int mode, std::size_t size = 0,
+                 rtos::memory::memory_resource* mr = nullptr) override;
+
+        virtual int
+        flush (void) override;
+
         // fstatvfs() - must not be locked, since will be locked by the
         // file system. (otherwise non-recursive mutexes will fail).
 
@@ -428,11 +485,15 @@ namespace os
 
         lockable_type& locker_;
 
+        object_locker_type object_locker_;
+
         /**
          * @endcond
          */
       };
 
+#pragma GCC diagnostic pop
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
@@ -534,8 +595,10 @@ namespace os
       ssize_t
       file_lockable<T, L>::read (void* buf, std::size_t nbyte)
       {
-        std::lock_guard<L> lock
+        shared_lock_guard<L> fs_lock
           { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
 
         return file::read (buf, nbyte);
       }
@@ -544,8 +607,10 @@ namespace os
       ssize_t
       file_lockable<T, L>::write (const void* buf, std::size_t nbyte)
       {
-        std::lock_guard<L> lock
+        shared_lock_guard<L> fs_lock
           { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
 
         return file::write (buf, nbyte);
       }
@@ -554,18 +619,110 @@ namespace os
       ssize_t
       file_lockable<T, L>::writev (const struct iovec* iov, int iovcnt)
       {
-        std::lock_guard<L> lock
+        shared_lock_guard<L> fs_lock
           { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
 
         return file::writev (iov, iovcnt);
       }
 
+    template<typename T, typename L>
+      ssize_t
+      file_lockable<T, L>::readv (const struct iovec* iov, int iovcnt)
+      {
+        shared_lock_guard<L> fs_lock
+          { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
+
+        return file::readv (iov, iovcnt);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      file_lockable<T, L>::pread (void* buf, std::size_t nbyte, off_t offset)
+      {
+        shared_lock_guard<L> fs_lock
+          { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
+
+        return file::pread (buf, nbyte, offset);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      file_lockable<T, L>::pwrite (const void* buf, std::size_t nbyte,
+                                   off_t offset)
+      {
+        shared_lock_guard<L> fs_lock
+          { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
+
+        return file::pwrite (buf, nbyte, offset);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      file_lockable<T, L>::preadv (const struct iovec* iov, int iovcnt,
+                                   off_t offset)
+      {
+        shared_lock_guard<L> fs_lock
+          { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
+
+        return file::preadv (iov, iovcnt, offset);
+      }
+
+    template<typename T, typename L>
+      ssize_t
+      file_lockable<T, L>::pwritev (const struct iovec* iov, int iovcnt,
+                                    off_t offset)
+      {
+        shared_lock_guard<L> fs_lock
+          { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
+
+        return file::pwritev (iov, iovcnt, offset);
+      }
+
+    template<typename T, typename L>
+      void*
+      file_lockable<T, L>::mmap (std::size_t length, int prot, int flags,
+                                 off_t offset)
+      {
+        shared_lock_guard<L> fs_lock
+          { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
+
+        return file::mmap (length, prot, flags, offset);
+      }
+
+    template<typename T, typename L>
+      int
+      file_lockable<T, L>::munmap (void* addr, std::size_t length)
+      {
+        shared_lock_guard<L> fs_lock
+          { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
+
+        return file::munmap (addr, length);
+      }
+
     template<typename T, typename L>
       int
       file_lockable<T, L>::vfcntl (int cmd, std::va_list args)
       {
-        std::lock_guard<L> lock
+        shared_lock_guard<L> fs_lock
           { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
 
         return file::vfcntl (cmd, args);
       }
@@ -574,8 +731,10 @@ namespace os
       int
       file_lockable<T, L>::fstat (struct stat* buf)
       {
-        std::lock_guard<L> lock
+        shared_lock_guard<L> fs_lock
           { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
 
         return file::fstat (buf);
       }
@@ -584,8 +743,10 @@ namespace os
       off_t
       file_lockable<T, L>::lseek (off_t offset, int whence)
       {
-        std::lock_guard<L> lock
+        shared_lock_guard<L> fs_lock
           { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
 
         return file::lseek (offset, whence);
       }
@@ -594,8 +755,10 @@ namespace os
       int
       file_lockable<T, L>::ftruncate (off_t length)
       {
-        std::lock_guard<L> lock
+        shared_lock_guard<L> fs_lock
           { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
 
         return file::ftruncate (length);
       }
@@ -604,12 +767,39 @@ namespace os
       int
       file_lockable<T, L>::fsync (void)
       {
-        std::lock_guard<L> lock
+        shared_lock_guard<L> fs_lock
           { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
 
         return file::fsync ();
       }
 
+    template<typename T, typename L>
+      int
+      file_lockable<T, L>::setvbuf (int mode, std::size_t size,
+                                    rtos::memory::memory_resource* mr)
+      {
+        shared_lock_guard<L> fs_lock
+          { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
+
+        return file::setvbuf (mode, size, mr);
+      }
+
+    template<typename T, typename L>
+      int
+      file_lockable<T, L>::flush (void)
+      {
+        shared_lock_guard<L> fs_lock
+          { locker_ };
+        std::lock_guard<object_locker_type> lock
+          { object_locker_ };
+
+        return file::flush ();
+      }
+
     template<typename T, typename L>
       typename file_lockable<T, L>::value_type&
       file_lockable<T, L>::impl (void) const
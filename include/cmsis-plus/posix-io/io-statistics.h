@@ -0,0 +1,283 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_IO_STATISTICS_H_
+#define CMSIS_PLUS_POSIX_IO_IO_STATISTICS_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+#include <cmsis-plus/rtos/os.h>
+
+#include <cstddef>
+#include <cstdint>
+
+// Needed for ssize_t
+#include <sys/types.h>
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Number of buckets in the latency histograms.
+ * @details
+ * Bucket `i` counts the operations that took between 2^i and
+ * 2^(i+1)-1 high resolution clock cycles; the last one
+ * also counts all longer operations.
+ */
+#if !defined(OS_INTEGER_POSIX_IO_STATISTICS_BUCKETS)
+#define OS_INTEGER_POSIX_IO_STATISTICS_BUCKETS (24)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief I/O statistics.
+     * @headerfile io-statistics.h <cmsis-plus/posix-io/io-statistics.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * Kept by all I/O objects and by the file systems when
+     * `OS_INCLUDE_POSIX_IO_STATISTICS` is defined.
+     *
+     * Durations are measured with the high resolution clock,
+     * around the calls to the implementations, thus they
+     * include the time spent in the lower layers, but not
+     * the time spent waiting for the locks.
+     *
+     * The counters are updated without locks, and concurrent
+     * updates of the same object may rarely get lost; this keeps
+     * them cheap enough to be left enabled.
+     */
+    class io_statistics
+    {
+    public:
+
+      /**
+       * @brief Counters for one kind of operations.
+       */
+      class counters
+      {
+      public:
+
+        /**
+         * @name Public Member Functions
+         * @{
+         */
+
+        /**
+         * @brief Account an operation.
+         * @param [in] begin High resolution clock timestamp
+         *  taken before the operation.
+         * @param [in] ret Number of bytes transferred, or -1 if error.
+         * @par Returns
+         *  Nothing.
+         */
+        void
+        record (rtos::clock::timestamp_t begin, ssize_t ret);
+
+        void
+        clear (void);
+
+        /**
+         * @}
+         */
+
+        /**
+         * @name Public Member Variables
+         * @{
+         */
+
+        /**
+         * @brief Number of operations, including the failed ones.
+         */
+        rtos::statistics::counter_t ops = 0;
+
+        /**
+         * @brief Number of failed operations.
+         */
+        rtos::statistics::counter_t errors = 0;
+
+        /**
+         * @brief Number of bytes transferred.
+         */
+        uint64_t bytes = 0;
+
+        /**
+         * @brief Accumulated duration, in CPU cycles.
+         */
+        rtos::statistics::duration_t cycles = 0;
+
+        /**
+         * @brief Longest operation, in CPU cycles.
+         */
+        rtos::statistics::duration_t max_cycles = 0;
+
+        /**
+         * @brief Log2 histogram of the durations.
+         */
+        uint32_t latency[OS_INTEGER_POSIX_IO_STATISTICS_BUCKETS] =
+          { };
+
+        /**
+         * @}
+         */
+      };
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      void
+      clear (void);
+
+      /**
+       * @brief Print the statistics on the trace device.
+       * @param [in] name Name of the object, to identify the report.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      report (const char* name) const;
+
+      /**
+       * @brief Tell the histogram bucket of a duration.
+       * @param [in] cycles Duration, in CPU cycles.
+       * @return The bucket index.
+       */
+      static std::size_t
+      bucket (rtos::statistics::duration_t cycles);
+
+      /**
+       * @}
+       */
+
+      /**
+       * @name Public Member Variables
+       * @{
+       */
+
+      /**
+       * @brief Data reads.
+       */
+      counters read;
+
+      /**
+       * @brief Data writes.
+       */
+      counters write;
+
+      /**
+       * @brief Other operations (like file system metadata
+       *  operations or block discards).
+       */
+      counters other;
+
+      /**
+       * @}
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline std::size_t
+    io_statistics::bucket (rtos::statistics::duration_t cycles)
+    {
+      if (cycles < 2)
+        {
+          return 0;
+        }
+
+      std::size_t n = static_cast<std::size_t> (63 - __builtin_clzll (cycles));
+      if (n >= OS_INTEGER_POSIX_IO_STATISTICS_BUCKETS)
+        {
+          return OS_INTEGER_POSIX_IO_STATISTICS_BUCKETS - 1;
+        }
+      return n;
+    }
+
+    inline void
+    io_statistics::counters::record (rtos::clock::timestamp_t begin,
+                                     ssize_t ret)
+    {
+      rtos::statistics::duration_t delta = rtos::hrclock.now () - begin;
+
+      ++ops;
+      if (ret < 0)
+        {
+          ++errors;
+        }
+      else
+        {
+          bytes += static_cast<uint64_t> (ret);
+        }
+      cycles += delta;
+      if (delta > max_cycles)
+        {
+          max_cycles = delta;
+        }
+      ++latency[bucket (delta)];
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_IO_STATISTICS_H_ */
@@ -37,6 +37,8 @@
 #endif
 
 #include <cmsis-plus/posix-io/types.h>
+#include <cmsis-plus/posix-io/io-statistics.h>
+#include <cmsis-plus/utils/lists.h>
 #include <cmsis-plus/diag/trace.h>
 
 #include <cstddef>
@@ -47,16 +49,53 @@
 
 // ----------------------------------------------------------------------------
 
+/**
+ * @brief Number of descriptors `poll()` and `select()` can wait
+ *  for without allocating memory.
+ */
+#if !defined(OS_INTEGER_POSIX_IO_POLL_LOCAL_FDS)
+#define OS_INTEGER_POSIX_IO_POLL_LOCAL_FDS (8)
+#endif
+
+/**
+ * @brief Size of the stack buffer used by `splice()` and `sendfile()`
+ *  for objects without a direct transfer.
+ */
+#if !defined(OS_INTEGER_POSIX_IO_SPLICE_BUFFER_SIZE)
+#define OS_INTEGER_POSIX_IO_SPLICE_BUFFER_SIZE (128)
+#endif
+
+/**
+ * @brief Default size of the write buffers set with `setvbuf()`.
+ */
+#if !defined(OS_INTEGER_POSIX_IO_STREAM_BUFFER_SIZE)
+#define OS_INTEGER_POSIX_IO_STREAM_BUFFER_SIZE (128)
+#endif
+
+// ----------------------------------------------------------------------------
+
 struct iovec;
+struct pollfd;
 
 namespace os
 {
+  namespace rtos
+  {
+    class semaphore;
+
+    namespace memory
+    {
+      class memory_resource;
+    } /* namespace memory */
+  } /* namespace rtos */
+
   namespace posix
   {
     // ------------------------------------------------------------------------
 
     class io;
     class io_impl;
+    class poll_waiter;
 
     class file_system;
     class socket;
@@ -73,6 +112,9 @@ namespace os
     io*
     vopen (const char* path, int oflag, std::va_list args);
 
+    int
+    poll (struct pollfd* fds, std::size_t nfds, int timeout);
+
     /**
      * @}
      */
@@ -124,7 +166,8 @@ namespace os
         block_device = 1 << 2,
         tty = 1 << 3,
         file = 1 << 4,
-        socket = 1 << 5
+        socket = 1 << 5,
+        fifo = 1 << 6
       };
 
       /**
@@ -187,6 +230,40 @@ namespace os
       virtual ssize_t
       writev (const struct iovec* iov, int iovcnt);
 
+      virtual ssize_t
+      readv (const struct iovec* iov, int iovcnt);
+
+      /**
+       * @brief Read from a given position.
+       * @param [out] buf Pointer to the destination buffer.
+       * @param [in] nbyte Number of bytes to read.
+       * @param [in] offset Position where to start reading.
+       * @return The number of bytes read, or -1 if error.
+       * @details
+       * The current offset is neither used nor changed,
+       * so the descriptor can be shared by multiple threads.
+       */
+      virtual ssize_t
+      pread (void* buf, std::size_t nbyte, off_t offset);
+
+      /**
+       * @brief Write to a given position.
+       * @param [in] buf Pointer to the source buffer.
+       * @param [in] nbyte Number of bytes to write.
+       * @param [in] offset Position where to start writing.
+       * @return The number of bytes written, or -1 if error.
+       * @details
+       * The current offset is neither used nor changed.
+       */
+      virtual ssize_t
+      pwrite (const void* buf, std::size_t nbyte, off_t offset);
+
+      virtual ssize_t
+      preadv (const struct iovec* iov, int iovcnt, off_t offset);
+
+      virtual ssize_t
+      pwritev (const struct iovec* iov, int iovcnt, off_t offset);
+
       int
       fcntl (int cmd, ...);
 
@@ -202,6 +279,133 @@ namespace os
       virtual off_t
       lseek (off_t offset, int whence);
 
+      /**
+       * @brief Query the readiness, without blocking.
+       * @param [in] events Mask of POLLIN, POLLOUT, ... events.
+       * @return The mask of the requested events which are ready,
+       *  plus POLLERR, POLLHUP or POLLNVAL, which are always reported.
+       */
+      int
+      poll (int events);
+
+      /**
+       * @brief Map the content in memory.
+       * @param [in] length Number of bytes to map.
+       * @param [in] prot Mask of `PROT_READ`, `PROT_WRITE`, ... bits.
+       * @param [in] flags `MAP_SHARED` or `MAP_PRIVATE`.
+       * @param [in] offset Position of the first byte to map.
+       * @return The address of the mapping, or `MAP_FAILED` if error.
+       * @details
+       * Memory addressable objects (like RAM disks or
+       * execute-in-place flash) return a pointer to the content
+       * itself, so it can be accessed without copies.
+       *
+       * The others return a private copy, read when mapped;
+       * in this case `MAP_SHARED` is accepted only for read-only
+       * mappings, since changes could not be written back.
+       *
+       * The mapping must be released with `munmap()`, with the
+       * same length.
+       */
+      virtual void*
+      mmap (std::size_t length, int prot, int flags, off_t offset);
+
+      /**
+       * @brief Release a mapping.
+       * @param [in] addr The address returned by `mmap()`.
+       * @param [in] length The length passed to `mmap()`.
+       * @retval 0 if successful.
+       * @retval -1 if error.
+       * @details
+       * It can be called after the object is closed.
+       */
+      virtual int
+      munmap (void* addr, std::size_t length);
+
+      /**
+       * @brief Write data read from another object.
+       * @param [in] in The source object.
+       * @param [in,out] offset Pointer to the position in the source,
+       *  updated after the transfer; `nullptr` to read from the current
+       *  offset of the source, and advance it.
+       * @param [in] count Number of bytes to transfer.
+       * @return The number of bytes written, or -1 if error.
+       * @details
+       * Objects with a direct transfer (see `io_impl::do_sendfile()`)
+       * pull the data into their own buffers; for the others the
+       * data is passed through a small stack buffer, without the
+       * overhead of separate read and write calls.
+       *
+       * Less than `count` bytes are transferred at the end of the
+       * source, or if the source has fewer bytes available.
+       */
+      ssize_t
+      sendfile (io& in, off_t* offset, std::size_t count);
+
+      /**
+       * @brief Write data read from another object, at a given position.
+       * @param [in] in The source object.
+       * @param [in,out] in_offset Pointer to the position in the source,
+       *  or `nullptr` for the current offset.
+       * @param [in,out] out_offset Pointer to the position in this
+       *  object, or `nullptr` for the current offset.
+       * @param [in] count Number of bytes to transfer.
+       * @return The number of bytes written, or -1 if error.
+       * @details
+       * Like `sendfile()`, with an optional position for the
+       * destination too. The direct transfer is used only when
+       * writing at the current offset.
+       *
+       * If not all bytes read could be written, the source
+       * position is moved back to the first byte not written;
+       * for sources which cannot seek, like pipes, the rest of
+       * the bytes read are written before returning. If this
+       * fails, the number of bytes transferred is returned,
+       * or -1 if none.
+       */
+      ssize_t
+      splice (io& in, off_t* in_offset, off_t* out_offset, std::size_t count);
+
+      /**
+       * @brief Set the buffering of the writes.
+       * @param [in] mode `_IOFBF` (fully buffered), `_IOLBF` (line
+       *  buffered) or `_IONBF` (not buffered).
+       * @param [in] size Size of the buffer, in bytes; 0 for
+       *  `OS_INTEGER_POSIX_IO_STREAM_BUFFER_SIZE`.
+       * @param [in] mr Memory resource for the buffer; `nullptr`
+       *  for the default resource.
+       * @retval 0 if successful.
+       * @retval -1 if error, with errno set to EBADF, EINVAL (not
+       *  a file or a char device, or bad mode) or ENOMEM.
+       * @details
+       * Small writes are collected in the buffer and passed to the
+       * implementation when the buffer is full, when a new line is
+       * written in line buffered mode, and by `flush()`, `close()`
+       * and `fsync()`; writes larger than the buffer are passed
+       * directly, after the buffered data.
+       *
+       * All other functions accessing the object (like `read()`,
+       * `lseek()` or `fstat()`) write the buffered data first.
+       *
+       * Errors of the automatic writes are reported by the next
+       * call; the data not written remains in the buffer.
+       *
+       * The buffer is released by `close()`.
+       */
+      virtual int
+      setvbuf (int mode, std::size_t size = 0,
+               rtos::memory::memory_resource* mr = nullptr);
+
+      /**
+       * @brief Write the buffered data.
+       * @par Parameters
+       *  None.
+       * @retval 0 if successful, or if there is no buffered data.
+       * @retval -1 if error.
+       */
+      virtual int
+      flush (void);
+
       // ----------------------------------------------------------------------
       // Support functions.
 
@@ -217,6 +421,23 @@ namespace os
       io_impl&
       impl (void) const;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+      /**
+       * @brief Get the I/O statistics.
+       * @par Parameters
+       *  None.
+       * @return A reference to the statistics of this object.
+       * @details
+       * For devices, the statistics are shared by all users;
+       * for files, each open file has its own, and the transfers
+       * are also added to the file system statistics.
+       */
+      io_statistics&
+      statistics (void);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       /**
        * @}
        */
@@ -248,6 +469,12 @@ namespace os
       io*
       alloc_file_descriptor (void);
 
+      int
+      flush_buffer (void);
+
+      void
+      free_buffer (void);
+
       /**
        * @}
        */
@@ -276,6 +503,138 @@ namespace os
 
       file_descriptor_t file_descriptor_ = no_file_descriptor;
 
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+      // Header of the write buffer, followed by the buffered bytes.
+      class write_buffer
+      {
+      public:
+
+        uint8_t*
+        data (void);
+
+        rtos::memory::memory_resource* mr;
+        std::size_t size;
+        std::size_t count;
+        int mode;
+      };
+
+#pragma GCC diagnostic pop
+
+      write_buffer* wbuf_ = nullptr;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Node linked to the wait queue of an I/O object.
+     * @headerfile io.h <cmsis-plus/posix-io/io.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * `poll()` and `select()` link one waiter to each descriptor
+     * they wait for; when the readiness of an object changes, the
+     * implementation calls `notify_readiness()`, which notifies
+     * all linked waiters.
+     *
+     * Derived classes can redefine `notify()`, for example
+     * `event_poll` moves the descriptor to its ready list.
+     */
+    class poll_waiter
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      poll_waiter (void);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      poll_waiter (const poll_waiter&) = delete;
+      poll_waiter (poll_waiter&&) = delete;
+      poll_waiter&
+      operator= (const poll_waiter&) = delete;
+      poll_waiter&
+      operator= (poll_waiter&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~poll_waiter ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Called when the readiness of the object changes.
+       * @par Returns
+       *  Nothing.
+       * @details
+       * Called from a critical section, possibly from an interrupt
+       * service routine. The default posts the semaphore.
+       */
+      virtual void
+      notify (void);
+
+      void
+      unlink (void);
+
+      // ----------------------------------------------------------------------
+      // Support functions.
+
+      void
+      semaphore (rtos::semaphore* sem);
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    public:
+
+      /**
+       * @cond ignore
+       */
+
+      // Intrusive node used to link the waiter to the io_impl.
+      utils::double_list_links links_;
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      rtos::semaphore* sem_ = nullptr;
+
       /**
        * @endcond
        */
@@ -289,6 +648,20 @@ namespace os
 
       friend class io;
 
+    public:
+
+      /**
+       * @name Types & Constants
+       * @{
+       */
+
+      using waiters_list = utils::intrusive_list<poll_waiter,
+      utils::double_list_links, &poll_waiter::links_>;
+
+      /**
+       * @}
+       */
+
       /**
        * @name Constructors & Destructor
        * @{
@@ -349,6 +722,33 @@ namespace os
       virtual ssize_t
       do_writev (const struct iovec* iov, int iovcnt);
 
+      virtual ssize_t
+      do_readv (const struct iovec* iov, int iovcnt);
+
+      /**
+       * @brief Read from a given position.
+       * @details
+       * The default is for stream devices, which
+       * cannot seek (ESPIPE).
+       */
+      virtual ssize_t
+      do_pread (void* buf, std::size_t nbyte, off_t offset);
+
+      /**
+       * @brief Write to a given position.
+       * @details
+       * The default is for stream devices, which
+       * cannot seek (ESPIPE).
+       */
+      virtual ssize_t
+      do_pwrite (const void* buf, std::size_t nbyte, off_t offset);
+
+      virtual ssize_t
+      do_preadv (const struct iovec* iov, int iovcnt, off_t offset);
+
+      virtual ssize_t
+      do_pwritev (const struct iovec* iov, int iovcnt, off_t offset);
+
       virtual int
       do_vfcntl (int cmd, std::va_list args);
 
@@ -364,6 +764,63 @@ namespace os
       virtual int
       do_close (void) = 0;
 
+      /**
+       * @brief Query the readiness.
+       * @param [in] events Mask of the events of interest.
+       * @return The mask of the events ready.
+       * @details
+       * Must not block. The default is for objects that never
+       * block, like regular files and block devices, which are
+       * always ready for both reading and writing.
+       *
+       * Implementations that can block must also call
+       * `notify_readiness()` when the state changes.
+       */
+      virtual int
+      do_poll (int events);
+
+      /**
+       * @brief Map the content in memory.
+       * @details
+       * The default reads a private copy with `do_pread()`,
+       * in memory from the default resource; bytes past the
+       * end read as zeroes. Memory addressable objects override
+       * it, together with `do_munmap()`, to return a pointer
+       * to the content.
+       */
+      virtual void*
+      do_mmap (std::size_t length, int prot, int flags, off_t offset);
+
+      /**
+       * @brief Release a mapping.
+       * @details
+       * The default releases the private copy, to the memory
+       * resource used by `do_mmap()`; addresses and lengths
+       * that do not match a copy of this object are rejected
+       * with EINVAL.
+       */
+      virtual int
+      do_munmap (void* addr, std::size_t length);
+
+      /**
+       * @brief Write data read from another object.
+       * @param [in] in The source, opened.
+       * @param [in,out] offset Position in the source, or `nullptr`.
+       * @param [in] count Number of bytes to transfer, not zero.
+       * @return The number of bytes written, or -1 if error.
+       * @details
+       * Objects with their own transmit buffers (like buffered
+       * serial ports) can override this to read from the source
+       * directly into their buffers, with `in.pread()` or `in.read()`,
+       * avoiding an intermediate copy; sources like block caches
+       * serve these reads from their own buffers.
+       *
+       * The default is not implemented (ENOSYS), and the data
+       * is passed through a buffer on the stack.
+       */
+      virtual ssize_t
+      do_sendfile (io& in, off_t* offset, std::size_t count);
+
       // ----------------------------------------------------------------------
       // Support functions.
 
@@ -373,6 +830,25 @@ namespace os
       void
       offset (off_t offset);
 
+      void
+      link_waiter (poll_waiter& waiter);
+
+      void
+      notify_readiness (void);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+      void
+      account_read (rtos::clock::timestamp_t begin, ssize_t ret);
+
+      void
+      account_write (rtos::clock::timestamp_t begin, ssize_t ret);
+
+      void
+      account_other (rtos::clock::timestamp_t begin, ssize_t ret);
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       /**
        * @}
        */
@@ -386,6 +862,40 @@ namespace os
 
       off_t offset_ = 0;
 
+      waiters_list waiters_
+        { true };
+
+      // Header of a private copy made by `do_mmap()`, stored
+      // just before it, to check and release it in `do_munmap()`.
+      struct mapping
+      {
+        // Intrusive node used to link the copy to the object.
+        utils::double_list_links links;
+
+        rtos::memory::memory_resource* resource;
+        std::size_t length;
+      };
+
+      // The offset of the copy, past the header, aligned.
+      static constexpr std::size_t mapping_offset = (sizeof(mapping)
+          + rtos::memory::memory_resource::max_align - 1)
+          / rtos::memory::memory_resource::max_align
+          * rtos::memory::memory_resource::max_align;
+
+      using mappings_list = utils::intrusive_list<mapping,
+      utils::double_list_links, &mapping::links>;
+
+      mappings_list mappings_
+        { true };
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      io_statistics statistics_;
+
+      // Statistics where the transfers are also added, if any
+      // (the file system, for files).
+      io_statistics* parent_statistics_ = nullptr;
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       /**
        * @endcond
        */
@@ -439,6 +949,30 @@ namespace os
       return impl_;
     }
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+    inline io_statistics&
+    io::statistics (void)
+    {
+      return impl ().statistics_;
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+    inline uint8_t*
+    io::write_buffer::data (void)
+    {
+      return reinterpret_cast<uint8_t*> (this + 1);
+    }
+
+    // ========================================================================
+
+    inline void
+    poll_waiter::semaphore (rtos::semaphore* sem)
+    {
+      sem_ = sem;
+    }
+
     // ========================================================================
 
     inline off_t
@@ -453,6 +987,49 @@ namespace os
       offset_ = offset;
     }
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+    inline void
+    io_impl::account_read (rtos::clock::timestamp_t begin, ssize_t ret)
+    {
+      statistics_.read.record (begin, ret);
+      if (parent_statistics_ != nullptr)
+        {
+          // Shared with the other files of the file system.
+          rtos::scheduler::critical_section scs;
+
+          parent_statistics_->read.record (begin, ret);
+        }
+    }
+
+    inline void
+    io_impl::account_write (rtos::clock::timestamp_t begin, ssize_t ret)
+    {
+      statistics_.write.record (begin, ret);
+      if (parent_statistics_ != nullptr)
+        {
+          // Shared with the other files of the file system.
+          rtos::scheduler::critical_section scs;
+
+          parent_statistics_->write.record (begin, ret);
+        }
+    }
+
+    inline void
+    io_impl::account_other (rtos::clock::timestamp_t begin, ssize_t ret)
+    {
+      statistics_.other.record (begin, ret);
+      if (parent_statistics_ != nullptr)
+        {
+          // Shared with the other files of the file system.
+          rtos::scheduler::critical_section scs;
+
+          parent_statistics_->other.record (begin, ret);
+        }
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
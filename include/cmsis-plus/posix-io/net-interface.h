@@ -85,6 +85,82 @@ namespace os
       virtual
       ~net_interface ();
 
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      const char*
+      name (void) const;
+
+      // Support functions.
+
+      net_interface_impl&
+      impl (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      const char* name_ = nullptr;
+
+      net_interface_impl& impl_;
+
+      /**
+       * @endcond
+       */
+
+      // TODO: add content
+    };
+
+    // ========================================================================
+
+    class net_interface_impl
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      net_interface_impl (void);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      net_interface_impl (const net_interface_impl&) = delete;
+      net_interface_impl (net_interface_impl&&) = delete;
+      net_interface_impl&
+      operator= (const net_interface_impl&) = delete;
+      net_interface_impl&
+      operator= (net_interface_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~net_interface_impl ();
+
       /**
        * @}
        */
@@ -92,6 +168,20 @@ namespace os
       // TODO: add content
     };
 
+    // ========================================================================
+
+    inline const char*
+    net_interface::name (void) const
+    {
+      return name_;
+    }
+
+    inline net_interface_impl&
+    net_interface::impl (void) const
+    {
+      return impl_;
+    }
+
   } /* namespace posix */
 } /* namespace os */
 
@@ -0,0 +1,634 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_PIPE_H_
+#define CMSIS_PLUS_POSIX_IO_PIPE_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/posix-driver/circular-buffer.h>
+#include <cmsis-plus/memory/block-pool.h>
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Default size of the pipe buffers, in bytes.
+ */
+#if !defined(OS_INTEGER_POSIX_IO_PIPE_SIZE)
+#define OS_INTEGER_POSIX_IO_PIPE_SIZE (512)
+#endif
+
+/**
+ * @brief Largest write guaranteed to be atomic (`PIPE_BUF`).
+ * @details
+ * Limited to the size of the pipe buffers.
+ */
+#if !defined(OS_INTEGER_POSIX_IO_PIPE_BUF)
+#define OS_INTEGER_POSIX_IO_PIPE_BUF (512)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    class pipe;
+    class pipe_impl;
+    class pipe_channel;
+    class pipe_pool;
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Pipe end implementation.
+     * @headerfile pipe.h <cmsis-plus/posix-io/pipe.h>
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    class pipe_impl : public io_impl
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @cond ignore
+       */
+
+      friend class pipe;
+      friend class pipe_channel;
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      pipe_impl (pipe_channel& channel, bool reader, int oflag);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      pipe_impl (const pipe_impl&) = delete;
+      pipe_impl (pipe_impl&&) = delete;
+      pipe_impl&
+      operator= (const pipe_impl&) = delete;
+      pipe_impl&
+      operator= (pipe_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~pipe_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual bool
+      do_is_opened (void) override;
+
+      /**
+       * @brief Read from the pipe.
+       * @details
+       * Blocks while the pipe is empty and the write end is
+       * opened; returns 0 (end of file) if the write end is closed.
+       */
+      virtual ssize_t
+      do_read (void* buf, std::size_t nbyte) override;
+
+      /**
+       * @brief Write to the pipe.
+       * @details
+       * Writes of up to `OS_INTEGER_POSIX_IO_PIPE_BUF` bytes are not
+       * interleaved with data from other writers; they wait until
+       * there is space for all bytes. Larger writes may be
+       * transferred in several parts.
+       *
+       * If the read end is closed, fails with EPIPE.
+       */
+      virtual ssize_t
+      do_write (const void* buf, std::size_t nbyte) override;
+
+      virtual off_t
+      do_lseek (off_t offset, int whence) override;
+
+      /**
+       * @brief Get or set the file status flags.
+       * @details
+       * `F_GETFL` and `F_SETFL` are supported; only `O_NONBLOCK`
+       * can be changed.
+       */
+      virtual int
+      do_vfcntl (int cmd, std::va_list args) override;
+
+      virtual int
+      do_fstat (struct stat* buf) override;
+
+      virtual int
+      do_poll (int events) override;
+
+      virtual int
+      do_close (void) override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      pipe_impl&
+      peer (void);
+
+      std::size_t
+      atomic_size (void);
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      pipe_channel& channel_;
+
+      bool reader_;
+      bool volatile opened_ = true;
+      bool nonblock_;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Pipe end.
+     * @headerfile pipe.h <cmsis-plus/posix-io/pipe.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * One end of a pipe, either the read end or the write end,
+     * created by `pipe_pool::create()`.
+     *
+     * The object is returned to the pool after both ends
+     * are closed.
+     */
+    class pipe : public io
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @cond ignore
+       */
+
+      friend class pipe_pool;
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      pipe (pipe_channel& channel, bool reader, int oflag);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      pipe (const pipe&) = delete;
+      pipe (pipe&&) = delete;
+      pipe&
+      operator= (const pipe&) = delete;
+      pipe&
+      operator= (pipe&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~pipe () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Close the pipe end.
+       * @par Parameters
+       *  None.
+       * @retval 0 if successful.
+       * @retval -1 if error.
+       * @details
+       * After both ends are closed, the object is returned to the pool,
+       * and must no longer be used.
+       */
+      virtual int
+      close (void) override;
+
+      /**
+       * @brief Get the data available in the pipe, without copying it.
+       * @param [out] pbuf Pointer to the data.
+       * @return The number of contiguous bytes available at `*pbuf`,
+       *  0 if the pipe is empty, or -1 if error.
+       * @details
+       * Never blocks. The data remains in the pipe until `consume()`;
+       * when the buffer wraps, only the part up to the end
+       * of the buffer is returned.
+       */
+      ssize_t
+      peek (const void** pbuf);
+
+      /**
+       * @brief Remove data from the pipe.
+       * @param [in] nbyte Number of bytes to remove.
+       * @return The number of bytes removed, or -1 if error.
+       */
+      ssize_t
+      consume (std::size_t nbyte);
+
+      // ----------------------------------------------------------------------
+      // Support functions.
+
+      pipe_impl&
+      impl (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      pipe_impl impl_instance_;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Pipe shared state.
+     * @headerfile pipe.h <cmsis-plus/posix-io/pipe.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * The buffer and the two ends of a pipe, stored in a block
+     * of the pool, followed by the buffer storage.
+     */
+    class pipe_channel
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @cond ignore
+       */
+
+      friend class pipe;
+      friend class pipe_impl;
+      friend class pipe_pool;
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      pipe_channel (pipe_pool& pool, uint8_t* buf, std::size_t size,
+                    int oflag);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      pipe_channel (const pipe_channel&) = delete;
+      pipe_channel (pipe_channel&&) = delete;
+      pipe_channel&
+      operator= (const pipe_channel&) = delete;
+      pipe_channel&
+      operator= (pipe_channel&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      ~pipe_channel ();
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      pipe_pool& pool_;
+
+      circular_buffer_bytes buffer_;
+
+      // Protects the buffer and the opened flags.
+      rtos::mutex mutex_
+        { "pipe" };
+
+      rtos::semaphore_binary readable_sem_
+        { "pipe-rd", 0 };
+      rtos::semaphore_binary writable_sem_
+        { "pipe-wr", 0 };
+
+      class pipe read_end_;
+      class pipe write_end_;
+
+      // Number of ends not yet closed.
+      std::size_t ends_ = 2;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief Pool of pipes.
+     * @headerfile pipe.h <cmsis-plus/posix-io/pipe.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * A fixed number of pipes, with buffers of the same size,
+     * allocated at once from a memory resource, so creating
+     * and closing pipes does not fragment the memory.
+     *
+     * The first pool constructed is also used by `pipe()`.
+     */
+    class pipe_pool : protected memory::block_pool
+    {
+      // ----------------------------------------------------------------------
+
+      /**
+       * @cond ignore
+       */
+
+      friend class pipe;
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      pipe_pool (
+          std::size_t pipes,
+          std::size_t buffer_size_bytes = OS_INTEGER_POSIX_IO_PIPE_SIZE,
+          rtos::memory::memory_resource* mr =
+              rtos::memory::get_default_resource ());
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      pipe_pool (const pipe_pool&) = delete;
+      pipe_pool (pipe_pool&&) = delete;
+      pipe_pool&
+      operator= (const pipe_pool&) = delete;
+      pipe_pool&
+      operator= (pipe_pool&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~pipe_pool () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      /**
+       * @brief Create a pipe.
+       * @param [out] ends Array where to store the read end
+       *  and the write end.
+       * @param [in] oflag `O_NONBLOCK` or 0.
+       * @retval 0 if successful.
+       * @retval -1 if error, with errno set to ENFILE (no
+       *  free pipes or file descriptors).
+       * @details
+       * Both ends are allocated file descriptors.
+       */
+      int
+      create (class pipe* ends[2], int oflag = 0);
+
+      /**
+       * @brief Get the size of the pipe buffers.
+       * @par Parameters
+       *  None.
+       * @return The size in bytes.
+       */
+      std::size_t
+      buffer_size (void) const;
+
+      /**
+       * @brief Get the pool used by `pipe()`.
+       * @par Parameters
+       *  None.
+       * @return Pointer to the pool, or `nullptr` if there are no pools.
+       */
+      static pipe_pool*
+      default_pool (void);
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      void
+      release (pipe_channel* channel);
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      rtos::memory::memory_resource* mr_;
+
+      void* arena_ = nullptr;
+      std::size_t arena_size_bytes_ = 0;
+      std::size_t buffer_size_bytes_;
+
+      static pipe_pool* default_pool__;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline pipe_impl&
+    pipe::impl (void) const
+    {
+      return static_cast<pipe_impl&> (impl_);
+    }
+
+    // ========================================================================
+
+    inline pipe_impl&
+    pipe_impl::peer (void)
+    {
+      return reader_ ? channel_.write_end_.impl () : channel_.read_end_.impl ();
+    }
+
+    // ========================================================================
+
+    inline std::size_t
+    pipe_pool::buffer_size (void) const
+    {
+      return buffer_size_bytes_;
+    }
+
+    inline pipe_pool*
+    pipe_pool::default_pool (void)
+    {
+      return default_pool__;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_PIPE_H_ */
@@ -61,11 +61,18 @@
 #define __posix_mkdir mkdir
 #define __posix_open open
 #define __posix_opendir opendir
+#define __posix_pipe pipe
+#define __posix_poll poll
+#define __posix_pread pread
+#define __posix_preadv preadv
+#define __posix_pwrite pwrite
+#define __posix_pwritev pwritev
 #define __posix_raise raise
 #define __posix_read read
 #define __posix_readdir readdir
 #define __posix_readdir_r readdir_r
 #define __posix_readlink readlink
+#define __posix_readv readv
 #define __posix_recv recv
 #define __posix_recvfrom recvfrom
 #define __posix_recvmsg recvmsg
@@ -74,6 +81,7 @@
 #define __posix_rmdir rmdir
 #define __posix_select select
 #define __posix_send send
+#define __posix_sendfile sendfile
 #define __posix_sendmsg sendmsg
 #define __posix_sendto sendto
 #define __posix_setsockopt setsockopt
@@ -81,6 +89,7 @@
 #define __posix_sockatmark sockatmark
 #define __posix_socket socket
 #define __posix_socketpair socketpair
+#define __posix_splice splice
 #define __posix_stat stat
 #define __posix_symlink symlink
 #define __posix_sync sync
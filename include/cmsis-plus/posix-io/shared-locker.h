@@ -0,0 +1,354 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_SHARED_LOCKER_H_
+#define CMSIS_PLUS_POSIX_IO_SHARED_LOCKER_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/rtos/os.h>
+
+#include <cstddef>
+#include <utility>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief Lock with shared and exclusive ownership.
+     * @headerfile shared-locker.h <cmsis-plus/posix-io/shared-locker.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * Any number of threads can own it shared, with `lock_shared()`,
+     * or a single thread exclusively, with `lock()`. Waiting
+     * exclusive owners have priority, new shared owners wait
+     * until they are served.
+     *
+     * It is not recursive, a thread must not lock it again,
+     * not even shared.
+     *
+     * When used as the locker of the lockable file system
+     * templates, the file systems get finer grained locking,
+     * but only if their implementations support concurrent
+     * accesses, see `locker_traits`.
+     */
+    class shared_locker
+    {
+    public:
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+      shared_locker () = default;
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      shared_locker (const shared_locker&) = delete;
+      shared_locker (shared_locker&&) = delete;
+      shared_locker&
+      operator= (const shared_locker&) = delete;
+      shared_locker&
+      operator= (shared_locker&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      ~shared_locker () = default;
+
+      /**
+       * @}
+       */
+
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+      /**
+       * @brief Lock exclusively.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      lock (void);
+
+      /**
+       * @brief Try to lock exclusively.
+       * @par Parameters
+       *  None.
+       * @retval true The lock was acquired.
+       * @retval false The lock is owned by other threads.
+       */
+      bool
+      try_lock (void);
+
+      void
+      unlock (void);
+
+      /**
+       * @brief Lock shared.
+       * @par Parameters
+       *  None.
+       * @par Returns
+       *  Nothing.
+       */
+      void
+      lock_shared (void);
+
+      /**
+       * @brief Try to lock shared.
+       * @par Parameters
+       *  None.
+       * @retval true The lock was acquired.
+       * @retval false The lock is owned or awaited exclusively.
+       */
+      bool
+      try_lock_shared (void);
+
+      void
+      unlock_shared (void);
+
+      /**
+       * @}
+       */
+
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      rtos::mutex mutex_;
+      rtos::condition_variable cond_;
+
+      std::size_t readers_ = 0;
+      std::size_t waiting_writers_ = 0;
+      bool writer_ = false;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+    // ========================================================================
+
+    /**
+     * @brief Locking policy of the lockable templates.
+     * @headerfile shared-locker.h <cmsis-plus/posix-io/shared-locker.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @tparam L Type of the file system locker.
+     * @details
+     * With simple lockers (like `rtos::mutex`), all the operations
+     * of a file system, and of its files and directories, are
+     * serialised by the file system locker.
+     *
+     * Lockers that can also be owned shared (which have
+     * `lock_shared()` and `unlock_shared()`, like `shared_locker`)
+     * allow:
+     * - metadata reads (`stat()`, `statvfs()`) with a shared lock;
+     * - file and directory operations with a shared lock on the file
+     *  system and an exclusive lock on the object itself;
+     * - structural changes (like `open()`, `mkdir()`, `unlink()`
+     *  or `close()`) with an exclusive lock.
+     *
+     * Opting in is only safe when the implementations
+     * (`file_system_impl`, `file_impl` and `directory_impl`) allow,
+     * without locks of their own:
+     * - concurrent `do_read()` and `do_write()` calls on different
+     *  files;
+     * - concurrent metadata reads, also during these transfers.
+     *
+     * Libraries with shared state, like the ChaN FatFS without
+     * `FF_FS_REENTRANT`, do not, and would corrupt the data;
+     * use an exclusive locker (like `rtos::mutex`) with them,
+     * which is the default choice.
+     */
+    template<typename L, typename = void>
+      class locker_traits
+      {
+      public:
+
+        /**
+         * @brief Type of the locker of each file and directory.
+         */
+        using object_locker_type = rtos::null_locker;
+
+        static constexpr bool is_shared = false;
+
+        static void
+        lock_shared (L& locker)
+        {
+          locker.lock ();
+        }
+
+        static void
+        unlock_shared (L& locker)
+        {
+          locker.unlock ();
+        }
+      };
+
+    /**
+     * @cond ignore
+     */
+
+    template<typename L>
+      class locker_traits<L,
+          decltype(std::declval<L&> ().lock_shared (), void ())>
+      {
+      public:
+
+        using object_locker_type = rtos::mutex;
+
+        static constexpr bool is_shared = true;
+
+        static void
+        lock_shared (L& locker)
+        {
+          locker.lock_shared ();
+        }
+
+        static void
+        unlock_shared (L& locker)
+        {
+          locker.unlock_shared ();
+        }
+      };
+
+    /**
+     * @endcond
+     */
+
+    // ========================================================================
+
+    /**
+     * @brief RAII helper, to lock shared, if possible.
+     * @headerfile shared-locker.h <cmsis-plus/posix-io/shared-locker.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @tparam L Type of the locker.
+     * @details
+     * Lockers that cannot be owned shared are locked exclusively.
+     */
+    template<typename L>
+      class shared_lock_guard
+      {
+      public:
+
+        explicit
+        shared_lock_guard (L& locker);
+
+        /**
+         * @cond ignore
+         */
+
+        // The rule of five.
+        shared_lock_guard (const shared_lock_guard&) = delete;
+        shared_lock_guard (shared_lock_guard&&) = delete;
+        shared_lock_guard&
+        operator= (const shared_lock_guard&) = delete;
+        shared_lock_guard&
+        operator= (shared_lock_guard&&) = delete;
+
+        /**
+         * @endcond
+         */
+
+        ~shared_lock_guard ();
+
+      protected:
+
+        /**
+         * @cond ignore
+         */
+
+        L& locker_;
+
+        /**
+         * @endcond
+         */
+      };
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    template<typename L>
+      inline
+      shared_lock_guard<L>::shared_lock_guard (L& locker) :
+          locker_ (locker)
+      {
+        locker_traits<L>::lock_shared (locker_);
+      }
+
+    template<typename L>
+      inline
+      shared_lock_guard<L>::~shared_lock_guard ()
+      {
+        locker_traits<L>::unlock_shared (locker_);
+      }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_SHARED_LOCKER_H_ */
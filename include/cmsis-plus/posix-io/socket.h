@@ -307,6 +307,23 @@ namespace os
       virtual int
       do_sockatmark (void) = 0;
 
+      /**
+       * @brief Query the readiness.
+       * @param [in] events Mask of the events of interest.
+       * @return The mask of the events ready.
+       * @details
+       * Sockets can block, so there is no default; network stacks
+       * must report the received data and the pending connections
+       * (POLLIN), the free space in the send buffers (POLLOUT) and
+       * the sockets not connected (POLLHUP), without blocking.
+       *
+       * Network stacks must also call `notify_readiness()` each
+       * time one of them may have changed; otherwise threads
+       * in `poll()` are not woken up.
+       */
+      virtual int
+      do_poll (int events) override = 0;
+
       /**
        * @}
        */
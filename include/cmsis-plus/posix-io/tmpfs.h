@@ -0,0 +1,622 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef CMSIS_PLUS_POSIX_IO_TMPFS_H_
+#define CMSIS_PLUS_POSIX_IO_TMPFS_H_
+
+#if defined(__cplusplus)
+
+// ----------------------------------------------------------------------------
+
+#if defined(OS_USE_OS_APP_CONFIG_H)
+#include <cmsis-plus/os-app-config.h>
+#endif
+
+#include <cmsis-plus/posix-io/file-system.h>
+#include <cmsis-plus/posix-io/file.h>
+#include <cmsis-plus/posix-io/directory.h>
+#include <cmsis-plus/rtos/os.h>
+
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Size of the tmpfs data pages, in bytes.
+ */
+#if !defined(OS_INTEGER_POSIX_IO_TMPFS_PAGE_SIZE)
+#define OS_INTEGER_POSIX_IO_TMPFS_PAGE_SIZE (512)
+#endif
+
+/**
+ * @brief Initial number of buckets of the tmpfs name hash table.
+ * @details
+ * Must be a power of 2; the table doubles as the file system grows.
+ */
+#if !defined(OS_INTEGER_POSIX_IO_TMPFS_BUCKETS)
+#define OS_INTEGER_POSIX_IO_TMPFS_BUCKETS (16)
+#endif
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ------------------------------------------------------------------------
+
+    class tmpfs_file_impl;
+    class tmpfs_directory_impl;
+
+    // ========================================================================
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+    /**
+     * @brief tmpfs file system implementation.
+     * @headerfile tmpfs.h <cmsis-plus/posix-io/tmpfs.h>
+     * @ingroup cmsis-plus-posix-io-base
+     * @details
+     * A file system kept in memory, without a block device,
+     * for temporary files:
+     * @code{.cpp}
+     * posix::file_system_implementable<posix::tmpfs_file_system_impl> tmp
+     *   { "tmp", nullptr };
+     *
+     * tmp.mount ("/tmp/");
+     * @endcode
+     *
+     * File data is kept in fixed size pages allocated from
+     * a memory resource, only for the parts actually written,
+     * so sparse files use memory only for their data; holes read
+     * as zeroes. The total size of the pages can be limited,
+     * writes beyond the limit fail with `ENOSPC`.
+     *
+     * Names are found with a single hash table lookup per path
+     * component, keyed by the parent directory and the name;
+     * the table grows with the number of entries.
+     *
+     * The content survives `umount()` and is lost on `mkfs()`
+     * or when the object is destroyed. Files and directories
+     * removed while open are released on the last close.
+     *
+     * For use from multiple threads, construct it with a mutex
+     * and wrap it in `file_system_lockable`; the files and
+     * directories are then locked with the same mutex.
+     */
+    class tmpfs_file_system_impl : public file_system_impl
+    {
+      // ----------------------------------------------------------------------
+
+      friend class tmpfs_file_impl;
+      friend class tmpfs_directory_impl;
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      tmpfs_file_system_impl (rtos::memory::memory_resource* mr =
+                                  rtos::memory::get_default_resource (),
+                              std::size_t max_bytes = 0);
+
+      tmpfs_file_system_impl (rtos::mutex& locker,
+                              rtos::memory::memory_resource* mr =
+                                  rtos::memory::get_default_resource (),
+                              std::size_t max_bytes = 0);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      tmpfs_file_system_impl (const tmpfs_file_system_impl&) = delete;
+      tmpfs_file_system_impl (tmpfs_file_system_impl&&) = delete;
+      tmpfs_file_system_impl&
+      operator= (const tmpfs_file_system_impl&) = delete;
+      tmpfs_file_system_impl&
+      operator= (tmpfs_file_system_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~tmpfs_file_system_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual int
+      do_vmkfs (int options, std::va_list args) override;
+
+      virtual int
+      do_vmount (unsigned int flags, std::va_list args) override;
+
+      virtual int
+      do_umount (unsigned int flags) override;
+
+      virtual file*
+      do_vopen (class file_system& fs, const char* path, int oflag,
+                std::va_list args) override;
+
+      virtual directory*
+      do_opendir (class file_system& fs, const char* dirname) override;
+
+      virtual int
+      do_mkdir (const char* path, mode_t mode) override;
+
+      virtual int
+      do_rmdir (const char* path) override;
+
+      virtual void
+      do_sync (void) override;
+
+      virtual int
+      do_chmod (const char* path, mode_t mode) override;
+
+      virtual int
+      do_stat (const char* path, struct stat* buf) override;
+
+      virtual int
+      do_truncate (const char* path, off_t length) override;
+
+      virtual int
+      do_rename (const char* existing, const char* _new) override;
+
+      virtual int
+      do_unlink (const char* path) override;
+
+      virtual int
+      do_utime (const char* path, const struct utimbuf* times) override;
+
+      virtual int
+      do_statvfs (struct statvfs* buf) override;
+
+      // ----------------------------------------------------------------------
+      // Support functions.
+
+      rtos::mutex&
+      locker (void);
+
+      /**
+       * @brief Get the number of bytes used by file data.
+       * @par Parameters
+       *  None.
+       * @return The size of all allocated pages.
+       */
+      std::size_t
+      used_bytes (void) const;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      class node
+      {
+      public:
+
+        node* parent_ = nullptr;
+        node* hash_next_ = nullptr;
+        node* next_sibling_ = nullptr;
+        node* prev_sibling_ = nullptr;
+
+        char* name_ = nullptr;
+        std::size_t name_length_ = 0;
+        std::size_t hash_ = 0;
+        // Increasing in the order of the parent directory list.
+        uint32_t seq_ = 0;
+
+        mode_t mode_ = 0;
+        ino_t ino_ = 0;
+        time_t atime_ = 0;
+        time_t mtime_ = 0;
+        time_t ctime_ = 0;
+
+        // Files.
+        off_t size_ = 0;
+        uint8_t** pages_ = nullptr;
+        std::size_t num_pages_ = 0;
+
+        // Directories.
+        node* first_child_ = nullptr;
+        node* last_child_ = nullptr;
+        std::size_t num_children_ = 0;
+        uint32_t next_seq_ = 1;
+        // Incremented when a child is removed, to revalidate
+        // the position of the open directory streams.
+        uint32_t generation_ = 0;
+
+        std::size_t open_count_ = 0;
+        bool removed_ = false;
+      };
+
+      static constexpr std::size_t page_size =
+      OS_INTEGER_POSIX_IO_TMPFS_PAGE_SIZE;
+
+      std::size_t
+      hash (const node* parent, const char* name, std::size_t len) const;
+
+      node*
+      lookup (const node* parent, const char* name, std::size_t len) const;
+
+      node*
+      resolve (const char* path, node** parent, const char** name,
+               std::size_t* len);
+
+      node*
+      create (node* parent, const char* name, std::size_t len, mode_t mode);
+
+      void
+      detach (node* n);
+
+      void
+      attach (node* n, node* parent);
+
+      void
+      remove (node* n);
+
+      void
+      release (node* n);
+
+      void
+      remove_all (node* dir);
+
+      void
+      grow_hash_table (void);
+
+      int
+      resize (node* n, off_t length);
+
+      ssize_t
+      read_data (node* n, void* buf, std::size_t nbyte, off_t offset);
+
+      ssize_t
+      write_data (node* n, const void* buf, std::size_t nbyte, off_t offset);
+
+      void
+      fill_stat (const node* n, struct stat* buf) const;
+
+      void
+      open_node (node* n);
+
+      void
+      close_node (node* n);
+
+      /**
+       * @endcond
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      rtos::memory::memory_resource* mr_;
+      rtos::mutex* locker_ = nullptr;
+
+      std::size_t max_bytes_;
+      std::size_t used_bytes_ = 0;
+
+      node root_;
+
+      node** hash_table_ = nullptr;
+      std::size_t hash_size_ = 0;
+      std::size_t num_nodes_ = 0;
+
+      ino_t next_ino_ = 1;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief tmpfs file implementation.
+     * @headerfile tmpfs.h <cmsis-plus/posix-io/tmpfs.h>
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    class tmpfs_file_impl : public file_impl
+    {
+      // ----------------------------------------------------------------------
+
+      friend class tmpfs_file_system_impl;
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      tmpfs_file_impl (class file_system& fs);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      tmpfs_file_impl (const tmpfs_file_impl&) = delete;
+      tmpfs_file_impl (tmpfs_file_impl&&) = delete;
+      tmpfs_file_impl&
+      operator= (const tmpfs_file_impl&) = delete;
+      tmpfs_file_impl&
+      operator= (tmpfs_file_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~tmpfs_file_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual bool
+      do_is_opened (void) override;
+
+      virtual ssize_t
+      do_read (void* buf, std::size_t nbyte) override;
+
+      virtual ssize_t
+      do_write (const void* buf, std::size_t nbyte) override;
+
+      virtual ssize_t
+      do_readv (const struct iovec* iov, int iovcnt) override;
+
+      virtual ssize_t
+      do_writev (const struct iovec* iov, int iovcnt) override;
+
+      virtual ssize_t
+      do_pread (void* buf, std::size_t nbyte, off_t offset) override;
+
+      virtual ssize_t
+      do_pwrite (const void* buf, std::size_t nbyte, off_t offset) override;
+
+      virtual ssize_t
+      do_preadv (const struct iovec* iov, int iovcnt, off_t offset) override;
+
+      virtual ssize_t
+      do_pwritev (const struct iovec* iov, int iovcnt, off_t offset)
+          override;
+
+      virtual int
+      do_fstat (struct stat* buf) override;
+
+      virtual off_t
+      do_lseek (off_t offset, int whence) override;
+
+      virtual int
+      do_ftruncate (off_t length) override;
+
+      virtual int
+      do_fsync (void) override;
+
+      virtual int
+      do_close (void) override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      tmpfs_file_system_impl&
+      fs_impl (void);
+
+      tmpfs_file_system_impl::node* node_ = nullptr;
+
+      int oflag_ = 0;
+
+      /**
+       * @endcond
+       */
+    };
+
+    // ========================================================================
+
+    /**
+     * @brief tmpfs directory implementation.
+     * @headerfile tmpfs.h <cmsis-plus/posix-io/tmpfs.h>
+     * @ingroup cmsis-plus-posix-io-base
+     */
+    class tmpfs_directory_impl : public directory_impl
+    {
+      // ----------------------------------------------------------------------
+
+      friend class tmpfs_file_system_impl;
+
+      // ----------------------------------------------------------------------
+
+      /**
+       * @name Constructors & Destructor
+       * @{
+       */
+
+    public:
+
+      tmpfs_directory_impl (class file_system& fs);
+
+      /**
+       * @cond ignore
+       */
+
+      // The rule of five.
+      tmpfs_directory_impl (const tmpfs_directory_impl&) = delete;
+      tmpfs_directory_impl (tmpfs_directory_impl&&) = delete;
+      tmpfs_directory_impl&
+      operator= (const tmpfs_directory_impl&) = delete;
+      tmpfs_directory_impl&
+      operator= (tmpfs_directory_impl&&) = delete;
+
+      /**
+       * @endcond
+       */
+
+      virtual
+      ~tmpfs_directory_impl () override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+      /**
+       * @name Public Member Functions
+       * @{
+       */
+
+    public:
+
+      virtual struct dirent*
+      do_read (void) override;
+
+      virtual void
+      do_rewind (void) override;
+
+      virtual int
+      do_close (void) override;
+
+      /**
+       * @}
+       */
+
+      // ----------------------------------------------------------------------
+    protected:
+
+      /**
+       * @cond ignore
+       */
+
+      tmpfs_file_system_impl&
+      fs_impl (void);
+
+      tmpfs_file_system_impl::node* node_ = nullptr;
+
+      // The next child to return, valid while the generation
+      // of the directory does not change.
+      tmpfs_file_system_impl::node* next_ = nullptr;
+      // The sequence number of the last child returned.
+      uint32_t last_seq_ = 0;
+      uint32_t generation_ = 0;
+
+      /**
+       * @endcond
+       */
+    };
+
+#pragma GCC diagnostic pop
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ===== Inline & template implementations ====================================
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    inline rtos::mutex&
+    tmpfs_file_system_impl::locker (void)
+    {
+      return *locker_;
+    }
+
+    inline std::size_t
+    tmpfs_file_system_impl::used_bytes (void) const
+    {
+      return used_bytes_;
+    }
+
+    // ========================================================================
+
+    inline tmpfs_file_system_impl&
+    tmpfs_file_impl::fs_impl (void)
+    {
+      return static_cast<tmpfs_file_system_impl&> (file_system ().impl ());
+    }
+
+    // ========================================================================
+
+    inline tmpfs_file_system_impl&
+    tmpfs_directory_impl::fs_impl (void)
+    {
+      return static_cast<tmpfs_file_system_impl&> (file_system ().impl ());
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
+
+#endif /* __cplusplus */
+
+#endif /* CMSIS_PLUS_POSIX_IO_TMPFS_H_ */
@@ -34,6 +34,7 @@
 #include <sys/select.h>
 
 #include <cmsis-plus/posix/dirent.h>
+#include <cmsis-plus/posix/poll.h>
 #include <cmsis-plus/posix/sys/socket.h>
 #include <cmsis-plus/posix/termios.h>
 
@@ -41,6 +42,9 @@
 
 #ifdef __cplusplus
 
+#include <cstddef>
+#include <cstdint>
+
 namespace os
 {
   namespace posix
@@ -50,6 +54,25 @@ namespace os
 
     constexpr file_descriptor_t no_file_descriptor = -1;
 
+    /**
+     * @brief Hash a name, for the path lookup tables.
+     * @param [in] name Pointer to the characters, not necessarily
+     *  null terminated.
+     * @param [in] len Number of characters.
+     * @return The FNV-1a hash of the characters.
+     */
+    inline std::size_t
+    hash_name (const char* name, std::size_t len)
+    {
+      uint32_t hash = 2166136261u;
+      for (std::size_t i = 0; i < len; ++i)
+        {
+          hash ^= static_cast<uint8_t> (name[i]);
+          hash *= 16777619u;
+        }
+      return hash;
+    }
+
   } /* namespace posix */
 } /* namespace os */
 
@@ -193,6 +216,26 @@ extern "C"
   __attribute__((weak))
   __posix_opendir (const char* dirname);
 
+  int __attribute__((weak))
+  __posix_pipe (int fildes[2]);
+
+  int __attribute__((weak))
+  __posix_poll (struct pollfd fds[], nfds_t nfds, int timeout);
+
+  ssize_t __attribute__((weak))
+  __posix_pread (int fildes, void* buf, size_t nbyte, off_t offset);
+
+  ssize_t __attribute__((weak))
+  __posix_preadv (int fildes, const struct iovec* iov, int iovcnt,
+                  off_t offset);
+
+  ssize_t __attribute__((weak))
+  __posix_pwrite (int fildes, const void* buf, size_t nbyte, off_t offset);
+
+  ssize_t __attribute__((weak))
+  __posix_pwritev (int fildes, const struct iovec* iov, int iovcnt,
+                   off_t offset);
+
   int __attribute__((weak))
   __posix_raise (int sig);
 
@@ -209,6 +252,9 @@ extern "C"
   ssize_t __attribute__((weak))
   __posix_readlink (const char* path, char* buf, size_t bufsize);
 
+  ssize_t __attribute__((weak))
+  __posix_readv (int fildes, const struct iovec* iov, int iovcnt);
+
   ssize_t __attribute__((weak))
   __posix_recv (int socket, void* buffer, size_t length, int flags);
 
@@ -235,6 +281,9 @@ extern "C"
   ssize_t __attribute__((weak))
   __posix_send (int socket, const void* buffer, size_t length, int flags);
 
+  ssize_t __attribute__((weak))
+  __posix_sendfile (int out_fd, int in_fd, off_t* offset, size_t count);
+
   ssize_t __attribute__((weak))
   __posix_sendmsg (int socket, const struct msghdr* message, int flags);
 
@@ -258,6 +307,10 @@ extern "C"
   int __attribute__((weak))
   __posix_socketpair (int domain, int type, int protocol, int socket_vector[2]);
 
+  ssize_t __attribute__((weak))
+  __posix_splice (int fd_in, off_t* off_in, int fd_out, off_t* off_out,
+                  size_t len, unsigned int flags);
+
   int __attribute__((weak))
   __posix_stat (const char* path, struct stat* buf);
 
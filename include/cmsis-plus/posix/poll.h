@@ -0,0 +1,86 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef POSIX_POLL_H_
+#define POSIX_POLL_H_
+
+// ----------------------------------------------------------------------------
+
+#include <unistd.h>
+
+#if defined(_POSIX_VERSION)
+
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wgnu-include-next"
+#endif
+#include_next <poll.h>
+#pragma GCC diagnostic pop
+
+#else
+
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+// ----------------------------------------------------------------------------
+
+  typedef unsigned int nfds_t;
+
+  struct pollfd
+  {
+    int fd; // The descriptor being polled.
+    short events; // The input event flags.
+    short revents; // The output event flags.
+  };
+
+#define POLLIN          0x0001  // Data other than high-priority may be read.
+#define POLLPRI         0x0002  // High priority data may be read.
+#define POLLOUT         0x0004  // Normal data may be written.
+#define POLLERR         0x0008  // An error has occurred (revents only).
+#define POLLHUP         0x0010  // Device has been disconnected (revents only).
+#define POLLNVAL        0x0020  // Invalid fd member (revents only).
+#define POLLRDNORM      0x0040  // Normal data may be read.
+#define POLLRDBAND      0x0080  // Priority data may be read.
+#define POLLWRNORM      0x0100  // Equivalent to POLLOUT.
+#define POLLWRBAND      0x0200  // Priority data may be written.
+
+  int
+  poll (struct pollfd fds[], nfds_t nfds, int timeout);
+
+// ----------------------------------------------------------------------------
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* defined(_POSIX_VERSION) */
+
+#endif /* POSIX_POLL_H_ */
@@ -113,8 +113,14 @@
 
 #define BLKSSZGET  _IO(0x12,104) /* get block logical device sector size */
 #define BLKGETSIZE64 _IOR(0x12,114,size_t)  /* get device size in bytes (u64 *arg) */
+#define BLKDISCARD _IO(0x12,119) /* discard a range of bytes (u64 range[2] *arg) */
 #define BLKPBSZGET _IO(0x12,123) /* get block physical device sector size */
 
+/* µOS++ specific, handled by all devices. */
+
+#define IOSTATGET _IO(0x7A,1) /* get the I/O statistics (io_statistics *arg) */
+#define IOSTATCLR _IO(0x7A,2) /* clear the I/O statistics */
+
 // ----------------------------------------------------------------------------
 
 #endif /* POSIX_SYS_IOCTL_H_ */
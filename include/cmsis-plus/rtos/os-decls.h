@@ -727,6 +727,12 @@ namespace os
   {
     // ========================================================================
 
+    constexpr
+    null_locker::null_locker ()
+    {
+      ;
+    }
+
     inline
     null_locker::~null_locker ()
     {
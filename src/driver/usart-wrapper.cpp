@@ -170,6 +170,9 @@ namespace os
           return driver_->Control (
               ctrl - (serial::Control::disable_tx - serial::Control::enable_tx),
               0);
+        case serial::Control::enable_rx_circular:
+          // Not available in ARM CMSIS.
+          return ERROR_UNSUPPORTED;
         }
       return driver_->Control (ctrl, 1);
     }
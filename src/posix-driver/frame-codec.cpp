@@ -0,0 +1,502 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-driver/frame-codec.h>
+#include <cmsis-plus/posix/sys/uio.h>
+
+#include <cassert>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    frame_codec::frame_codec (uint8_t* buf, std::size_t size,
+                              handler_t handler, void* arg) :
+        buf_ (buf), //
+        size_ (size), //
+        handler_ (handler), //
+        handler_arg_ (arg)
+    {
+      assert (buf != nullptr);
+      assert (handler != nullptr);
+    }
+
+    frame_codec::~frame_codec ()
+    {
+      ;
+    }
+
+    std::size_t
+    frame_codec::decode (const struct iovec* iov, int iovcnt)
+    {
+      assert (iov != nullptr);
+
+      std::size_t frames = 0;
+      for (int i = 0; i < iovcnt; ++i)
+        {
+          frames += do_decode (static_cast<const uint8_t*> (iov[i].iov_base),
+                               iov[i].iov_len);
+        }
+      return frames;
+    }
+
+    void
+    frame_codec::reset (void)
+    {
+      len_ = 0;
+      bad_ = false;
+
+      do_reset ();
+    }
+
+    void
+    frame_codec::do_reset (void)
+    {
+      ;
+    }
+
+    void
+    frame_codec::append (const uint8_t* data, std::size_t len)
+    {
+      if (bad_)
+        {
+          return;
+        }
+      if (len > size_ - len_)
+        {
+          bad_ = true; // Too long, drop it.
+          return;
+        }
+      std::memcpy (buf_ + len_, data, len);
+      len_ += len;
+    }
+
+    bool
+    frame_codec::finish (void)
+    {
+      return finish (buf_, len_);
+    }
+
+    bool
+    frame_codec::finish (const uint8_t* frame, std::size_t len)
+    {
+      bool ok = !bad_ && (check_ == nullptr || check_ (check_arg_, frame, len));
+
+      // Prepare for the next frame; the buffer is not changed.
+      len_ = 0;
+      bad_ = false;
+
+      if (!ok)
+        {
+          ++errors_;
+          return false;
+        }
+
+      handler_ (handler_arg_, frame, len);
+      return true;
+    }
+
+    // ========================================================================
+
+    slip_codec::slip_codec (uint8_t* buf, std::size_t size, handler_t handler,
+                            void* arg) :
+        frame_codec
+          { buf, size, handler, arg }
+    {
+      ;
+    }
+
+    slip_codec::~slip_codec ()
+    {
+      ;
+    }
+
+    std::size_t
+    slip_codec::do_decode (const uint8_t* data, std::size_t len)
+    {
+      std::size_t frames = 0;
+      const uint8_t* limit = data + len;
+      const uint8_t* p = data;
+      while (p < limit)
+        {
+          if (escaped_)
+            {
+              escaped_ = false;
+              uint8_t c;
+              if (*p == esc_end)
+                {
+                  c = end;
+                }
+              else if (*p == esc_esc)
+                {
+                  c = esc;
+                }
+              else
+                {
+                  bad_ = true; // Invalid escape.
+                  if (*p != end)
+                    {
+                      ++p;
+                    }
+                  continue;
+                }
+              append (&c, 1);
+              ++p;
+              continue;
+            }
+
+          // Find the end of the run of plain bytes.
+          const uint8_t* q = p;
+          while (q < limit && *q != end && *q != esc)
+            {
+              ++q;
+            }
+
+          if (q < limit && *q == end && len_ == 0 && !bad_
+              && static_cast<std::size_t> (q - p) <= size_)
+            {
+              // The entire frame is here, pass it in place.
+              if (q > p && finish (p, static_cast<std::size_t> (q - p)))
+                {
+                  ++frames;
+                }
+              p = q + 1;
+              continue;
+            }
+
+          append (p, static_cast<std::size_t> (q - p));
+          if (q == limit)
+            {
+              break;
+            }
+
+          if (*q == end)
+            {
+              // Empty frames are ignored.
+              if ((len_ > 0 || bad_) && finish ())
+                {
+                  ++frames;
+                }
+            }
+          else
+            {
+              escaped_ = true;
+            }
+          p = q + 1;
+        }
+      return frames;
+    }
+
+    std::size_t
+    slip_codec::do_encode (const uint8_t* data, std::size_t len, uint8_t* buf,
+                           std::size_t size) const
+    {
+      if (size < 2)
+        {
+          return 0;
+        }
+
+      // Start with an end, to flush any line noise; reserve
+      // the last byte for the final end.
+      std::size_t n = 0;
+      buf[n++] = end;
+      for (std::size_t i = 0; i < len; ++i)
+        {
+          uint8_t c = data[i];
+          if (c == end || c == esc)
+            {
+              if (n + 2 > size - 1)
+                {
+                  return 0;
+                }
+              buf[n++] = esc;
+              buf[n++] = (c == end) ? esc_end : esc_esc;
+            }
+          else
+            {
+              if (n + 1 > size - 1)
+                {
+                  return 0;
+                }
+              buf[n++] = c;
+            }
+        }
+      buf[n++] = end;
+
+      return n;
+    }
+
+    void
+    slip_codec::do_reset (void)
+    {
+      escaped_ = false;
+    }
+
+    // ========================================================================
+
+    cobs_codec::cobs_codec (uint8_t* buf, std::size_t size, handler_t handler,
+                            void* arg) :
+        frame_codec
+          { buf, size, handler, arg }
+    {
+      ;
+    }
+
+    cobs_codec::~cobs_codec ()
+    {
+      ;
+    }
+
+    std::size_t
+    cobs_codec::do_decode (const uint8_t* data, std::size_t len)
+    {
+      std::size_t frames = 0;
+      const uint8_t* limit = data + len;
+      const uint8_t* p = data;
+      while (p < limit)
+        {
+          if (remaining_ == 0)
+            {
+              uint8_t code = *p++;
+              if (code == 0)
+                {
+                  // Delimiter; the zero after the last block
+                  // is not part of the frame.
+                  if (started_ && finish ())
+                    {
+                      ++frames;
+                    }
+                  started_ = false;
+                  zero_pending_ = false;
+                  continue;
+                }
+              if (zero_pending_)
+                {
+                  uint8_t z = 0;
+                  append (&z, 1);
+                }
+              started_ = true;
+              remaining_ = code - 1u;
+              zero_pending_ = (code != 0xFF);
+              continue;
+            }
+
+          std::size_t n = static_cast<std::size_t> (limit - p);
+          if (n > remaining_)
+            {
+              n = remaining_;
+            }
+          const uint8_t* z = static_cast<const uint8_t*> (
+              std::memchr (p, 0, n));
+          if (z != nullptr)
+            {
+              // Truncated block, the zero ends the frame.
+              append (p, static_cast<std::size_t> (z - p));
+              bad_ = true;
+              remaining_ = 0;
+              p = z;
+              continue;
+            }
+          append (p, n);
+          remaining_ -= n;
+          p += n;
+        }
+      return frames;
+    }
+
+    std::size_t
+    cobs_codec::do_encode (const uint8_t* data, std::size_t len, uint8_t* buf,
+                           std::size_t size) const
+    {
+      if (size == 0)
+        {
+          return 0;
+        }
+
+      // Each block starts with a code, set when the block ends.
+      std::size_t code_pos = 0;
+      std::size_t n = 1;
+      uint8_t code = 1;
+      for (std::size_t i = 0; i < len; ++i)
+        {
+          if (data[i] != 0)
+            {
+              if (n >= size)
+                {
+                  return 0;
+                }
+              buf[n++] = data[i];
+              ++code;
+            }
+          if (data[i] == 0 || code == 0xFF)
+            {
+              buf[code_pos] = code;
+              code_pos = n;
+              if (n >= size)
+                {
+                  return 0;
+                }
+              ++n;
+              code = 1;
+            }
+        }
+      buf[code_pos] = code;
+
+      if (n >= size)
+        {
+          return 0;
+        }
+      buf[n++] = 0;
+
+      return n;
+    }
+
+    void
+    cobs_codec::do_reset (void)
+    {
+      remaining_ = 0;
+      started_ = false;
+      zero_pending_ = false;
+    }
+
+    // ========================================================================
+
+    length_prefix_codec::length_prefix_codec (uint8_t* buf, std::size_t size,
+                                              handler_t handler, void* arg,
+                                              std::size_t prefix) :
+        frame_codec
+          { buf, size, handler, arg }, //
+        prefix_ (prefix)
+    {
+      assert (prefix >= 1 && prefix <= 4);
+    }
+
+    length_prefix_codec::~length_prefix_codec ()
+    {
+      ;
+    }
+
+    std::size_t
+    length_prefix_codec::do_decode (const uint8_t* data, std::size_t len)
+    {
+      std::size_t frames = 0;
+      const uint8_t* limit = data + len;
+      const uint8_t* p = data;
+      while (p < limit)
+        {
+          if (prefix_count_ < prefix_)
+            {
+              remaining_ = (remaining_ << 8) | *p++;
+              if (++prefix_count_ < prefix_)
+                {
+                  continue;
+                }
+              if (remaining_ > size_)
+                {
+                  bad_ = true; // Too long, skip it.
+                }
+              if (remaining_ == 0)
+                {
+                  if (finish ())
+                    {
+                      ++frames;
+                    }
+                  prefix_count_ = 0;
+                }
+              continue;
+            }
+
+          std::size_t n = static_cast<std::size_t> (limit - p);
+          if (n > remaining_)
+            {
+              n = remaining_;
+            }
+          if (len_ == 0 && n == remaining_ && !bad_)
+            {
+              // The entire frame is here, pass it in place.
+              if (finish (p, n))
+                {
+                  ++frames;
+                }
+            }
+          else
+            {
+              append (p, n);
+              if (n == remaining_ && finish ())
+                {
+                  ++frames;
+                }
+            }
+          remaining_ -= n;
+          p += n;
+          if (remaining_ == 0)
+            {
+              prefix_count_ = 0;
+            }
+        }
+      return frames;
+    }
+
+    std::size_t
+    length_prefix_codec::do_encode (const uint8_t* data, std::size_t len,
+                                    uint8_t* buf, std::size_t size) const
+    {
+      if ((prefix_ < sizeof(std::size_t)) && ((len >> (8 * prefix_)) != 0))
+        {
+          return 0; // Does not fit in the prefix.
+        }
+      if (size < prefix_ + len)
+        {
+          return 0;
+        }
+
+      for (std::size_t i = 0; i < prefix_; ++i)
+        {
+          buf[i] = static_cast<uint8_t> (len >> (8 * (prefix_ - 1 - i)));
+        }
+      std::memcpy (buf + prefix_, data, len);
+
+      return prefix_ + len;
+    }
+
+    void
+    length_prefix_codec::do_reset (void)
+    {
+      prefix_count_ = 0;
+      remaining_ = 0;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
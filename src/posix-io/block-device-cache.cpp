@@ -0,0 +1,741 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/block-device-cache.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <cstring>
+#include <cassert>
+#include <cerrno>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    block_device_cache::block_device_cache (block_device_cache_impl& impl,
+                                            const char* name) :
+        block_device
+          { impl, name }
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf ("block_device_cache::%s(\"%s\")=@%p\n", __func__, name_,
+                     this);
+#endif
+    }
+
+    block_device_cache::~block_device_cache ()
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf ("block_device_cache::%s() @%p %s\n", __func__, this,
+                     name_);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    int
+    block_device_cache::invalidate (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf ("block_device_cache::%s() @%p\n", __func__, this);
+#endif
+
+      errno = 0;
+
+      return impl ().invalidate ();
+    }
+
+    // ========================================================================
+
+    /**
+     * @details
+     * The buffer descriptors and the hash table are allocated here;
+     * the buffers content is allocated on the first open(), when
+     * the block size of the parent is known.
+     */
+    block_device_cache_impl::block_device_cache_impl (block_device& parent,
+                                                      std::size_t nbuffers) :
+        parent_ (parent), //
+        num_buffers_ (nbuffers), //
+        lru_list_ (true), //
+        free_list_ (true), //
+        read_ahead_max_blocks_ (nbuffers / 2)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf ("block_device_cache_impl::%s(%u)=@%p\n", __func__,
+                     nbuffers, this);
+#endif
+
+      assert(num_buffers_ > 0);
+
+      // Twice the number of buffers, rounded up to a power of 2.
+      std::size_t hash_size = 1;
+      while (hash_size < 2 * num_buffers_)
+        {
+          hash_size <<= 1;
+        }
+      hash_mask_ = hash_size - 1;
+
+      hash_table_ = new buffer*[hash_size];
+      for (std::size_t i = 0; i < hash_size; ++i)
+        {
+          hash_table_[i] = nullptr;
+        }
+
+      buffers_ = new buffer[num_buffers_];
+      for (std::size_t i = 0; i < num_buffers_; ++i)
+        {
+          free_list_.link (buffers_[i]);
+        }
+    }
+
+    block_device_cache_impl::~block_device_cache_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf ("block_device_cache_impl::%s() @%p\n", __func__, this);
+#endif
+
+      delete[] ahead_buffer_;
+      delete[] arena_;
+      delete[] buffers_;
+      delete[] hash_table_;
+    }
+
+    // ------------------------------------------------------------------------
+
+    int
+    block_device_cache_impl::do_vioctl (int request, std::va_list args)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf ("block_device_cache_impl::%s(%d) @%p\n", __func__,
+                     request, this);
+#endif
+
+      return parent_.vioctl (request, args);
+    }
+
+    int
+    block_device_cache_impl::do_vopen (const char* path, int oflag,
+                                       std::va_list args)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf ("block_device_cache_impl::%s(%d) @%p\n", __func__, oflag,
+                     this);
+#endif
+
+      int ret = parent_.vopen (path, oflag, args);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      // Inherit from parent.
+      block_logical_size_bytes_ = parent_.block_logical_size_bytes ();
+      block_physical_size_bytes_ = parent_.block_physical_size_bytes ();
+      num_blocks_ = parent_.blocks ();
+
+      if (arena_block_size_bytes_ != block_logical_size_bytes_)
+        {
+          delete[] arena_;
+          arena_ = new uint8_t[num_buffers_ * block_logical_size_bytes_];
+          arena_block_size_bytes_ = block_logical_size_bytes_;
+
+          for (std::size_t i = 0; i < num_buffers_; ++i)
+            {
+              buffers_[i].data_ = arena_ + i * block_logical_size_bytes_;
+            }
+        }
+
+      // The media may have been changed while closed, forget
+      // everything. Dirty buffers were written back on close().
+      while (!lru_list_.empty ())
+        {
+          release_buffer (lru_list_.unlink_head ());
+        }
+
+      for (auto&& st : streams_)
+        {
+          st.active_ = false;
+        }
+
+      return ret;
+    }
+
+    /**
+     * @details
+     * Hits are copied from the cache. Consecutive misses are read
+     * from the parent with a single multi-block call, directly
+     * into the user buffer, and then copied into the cache;
+     * runs larger than the cache are not cached at all, to
+     * avoid flushing the cache with data read only once.
+     *
+     * After the request is served, read-ahead is considered.
+     */
+    ssize_t
+    block_device_cache_impl::do_read_block (void* buf, blknum_t blknum,
+                                            std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf ("block_device_cache_impl::%s(%p, %u, %u) @%p\n",
+                     __func__, buf, blknum, nblocks, this);
+#endif
+
+      uint8_t* p = static_cast<uint8_t*> (buf);
+      std::size_t ahead_hits = 0;
+      std::size_t i = 0;
+      while (i < nblocks)
+        {
+          buffer* b = lookup (blknum + i);
+          if (b != nullptr)
+            {
+              std::memcpy (p, b->data_, block_logical_size_bytes_);
+              p += block_logical_size_bytes_;
+              ++statistics_.hits;
+              if (b->ahead_)
+                {
+                  b->ahead_ = false;
+                  ++statistics_.read_ahead_hits;
+                  ++ahead_hits;
+                }
+              ++i;
+              continue;
+            }
+
+          // Count the consecutive missing blocks.
+          std::size_t n = 1;
+          while ((i + n < nblocks) && (lookup (blknum + i + n) == nullptr))
+            {
+              ++n;
+            }
+
+          ssize_t ret = parent_.read_block (p, blknum + i, n);
+          if (ret < 0)
+            {
+              return ret;
+            }
+          statistics_.misses += n;
+
+          if (n < num_buffers_)
+            {
+              for (std::size_t k = 0; k < n; ++k)
+                {
+                  b = allocate_buffer (blknum + i + k);
+                  if (b == nullptr)
+                    {
+                      return -1;
+                    }
+                  std::memcpy (b->data_, p + k * block_logical_size_bytes_,
+                               block_logical_size_bytes_);
+                }
+            }
+
+          p += n * block_logical_size_bytes_;
+          i += n;
+        }
+
+      if (read_ahead_max_blocks_ > 0)
+        {
+          prefetch (blknum, nblocks, ahead_hits);
+        }
+
+      return static_cast<ssize_t> (nblocks);
+    }
+
+    /**
+     * @details
+     * Writes smaller than the cache are deferred; the buffers are
+     * marked dirty and written back later. Larger writes go
+     * directly to the parent, and the cached copies, if any,
+     * are updated.
+     */
+    ssize_t
+    block_device_cache_impl::do_write_block (const void* buf, blknum_t blknum,
+                                             std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf ("block_device_cache_impl::%s(%p, %u, %u) @%p\n",
+                     __func__, buf, blknum, nblocks, this);
+#endif
+
+      const uint8_t* p = static_cast<const uint8_t*> (buf);
+
+      if (nblocks >= num_buffers_)
+        {
+          ssize_t ret = parent_.write_block (buf, blknum, nblocks);
+          if (ret < 0)
+            {
+              return ret;
+            }
+
+          for (std::size_t i = 0; i < nblocks; ++i)
+            {
+              buffer* b = lookup (blknum + i);
+              if (b != nullptr)
+                {
+                  std::memcpy (b->data_, p + i * block_logical_size_bytes_,
+                               block_logical_size_bytes_);
+                  b->dirty_ = false;
+                }
+            }
+          return ret;
+        }
+
+      for (std::size_t i = 0; i < nblocks; ++i)
+        {
+          buffer* b = lookup (blknum + i);
+          if (b == nullptr)
+            {
+              b = allocate_buffer (blknum + i);
+              if (b == nullptr)
+                {
+                  return -1;
+                }
+            }
+          std::memcpy (b->data_, p, block_logical_size_bytes_);
+          b->dirty_ = true;
+          p += block_logical_size_bytes_;
+        }
+
+      return static_cast<ssize_t> (nblocks);
+    }
+
+    /**
+     * @details
+     * The cached copies of the discarded blocks are dropped,
+     * without writing them back, even if dirty.
+     */
+    int
+    block_device_cache_impl::do_discard (blknum_t blknum, std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf ("block_device_cache_impl::%s(%u, %u) @%p\n", __func__,
+                     blknum, nblocks, this);
+#endif
+
+      for (std::size_t i = 0; i < num_buffers_; ++i)
+        {
+          buffer* b = &buffers_[i];
+          if (b->blknum_ >= blknum && b->blknum_ < blknum + nblocks
+              && find (b->blknum_) == b)
+            {
+              b->lru_links_.unlink ();
+              release_buffer (b);
+            }
+        }
+
+      return parent_.discard_blocks (blknum, nblocks);
+    }
+
+    void
+    block_device_cache_impl::do_sync (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf ("block_device_cache_impl::%s() @%p\n", __func__, this);
+#endif
+
+      write_back_all ();
+
+      return parent_.sync ();
+    }
+
+    int
+    block_device_cache_impl::do_close (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf ("block_device_cache_impl::%s() @%p\n", __func__, this);
+#endif
+
+      int ret = write_back_all ();
+
+      int ret2 = parent_.close ();
+      return (ret < 0) ? ret : ret2;
+    }
+
+    // ------------------------------------------------------------------------
+
+    int
+    block_device_cache_impl::invalidate (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf ("block_device_cache_impl::%s() @%p\n", __func__, this);
+#endif
+
+      int ret = write_back_all ();
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      while (!lru_list_.empty ())
+        {
+          release_buffer (lru_list_.unlink_head ());
+        }
+
+      return 0;
+    }
+
+    void
+    block_device_cache_impl::read_ahead (std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_CACHE)
+      trace::printf ("block_device_cache_impl::%s(%u) @%p\n", __func__,
+                     nblocks, this);
+#endif
+
+      // Keep at least half of the cache for the normal traffic.
+      if (nblocks > num_buffers_ / 2)
+        {
+          nblocks = num_buffers_ / 2;
+        }
+      read_ahead_max_blocks_ = nblocks;
+
+      for (auto&& st : streams_)
+        {
+          if (st.window_ > nblocks)
+            {
+              st.window_ = nblocks;
+            }
+        }
+    }
+
+    // ------------------------------------------------------------------------
+
+    std::size_t
+    block_device_cache_impl::hash (blknum_t blknum) const
+    {
+      // Consecutive blocks go to consecutive buckets.
+      return static_cast<std::size_t> (blknum) & hash_mask_;
+    }
+
+    block_device_cache_impl::buffer*
+    block_device_cache_impl::find (blknum_t blknum)
+    {
+      buffer* b = hash_table_[hash (blknum)];
+      while (b != nullptr)
+        {
+          if (b->blknum_ == blknum)
+            {
+              return b;
+            }
+          b = b->hash_next_;
+        }
+      return nullptr;
+    }
+
+    /**
+     * @details
+     * If found, the buffer is also moved to the most recently
+     * used end of the list.
+     */
+    block_device_cache_impl::buffer*
+    block_device_cache_impl::lookup (blknum_t blknum)
+    {
+      buffer* b = find (blknum);
+      if (b != nullptr)
+        {
+          b->lru_links_.unlink ();
+          lru_list_.link (*b);
+        }
+      return b;
+    }
+
+    void
+    block_device_cache_impl::hash_link (buffer* b)
+    {
+      std::size_t h = hash (b->blknum_);
+      b->hash_next_ = hash_table_[h];
+      hash_table_[h] = b;
+    }
+
+    void
+    block_device_cache_impl::hash_unlink (buffer* b)
+    {
+      buffer** pp = &hash_table_[hash (b->blknum_)];
+      while (*pp != nullptr)
+        {
+          if (*pp == b)
+            {
+              *pp = b->hash_next_;
+              break;
+            }
+          pp = &((*pp)->hash_next_);
+        }
+      b->hash_next_ = nullptr;
+    }
+
+    /**
+     * @details
+     * Use a free buffer if available, otherwise reuse the least
+     * recently used one, after writing it back if dirty.
+     *
+     * The returned buffer is clean, hashed for the new block,
+     * and already at the most recently used end of the list.
+     */
+    block_device_cache_impl::buffer*
+    block_device_cache_impl::allocate_buffer (blknum_t blknum)
+    {
+      buffer* b;
+      if (!free_list_.empty ())
+        {
+          b = free_list_.unlink_head ();
+        }
+      else
+        {
+          b = lru_list_.unlink_head ();
+          if (b->dirty_)
+            {
+              if (write_back (b) < 0)
+                {
+                  // Keep it, but do not try it again too soon.
+                  lru_list_.link (*b);
+                  return nullptr;
+                }
+            }
+          hash_unlink (b);
+          ++statistics_.evictions;
+
+          if (b->ahead_)
+            {
+              // Prefetched too far, or too early; shrink all windows.
+              ++statistics_.read_ahead_wasted;
+              for (auto&& st : streams_)
+                {
+                  st.window_ = (st.window_ + 1) / 2;
+                }
+            }
+        }
+
+      b->blknum_ = blknum;
+      b->dirty_ = false;
+      b->ahead_ = false;
+      hash_link (b);
+      lru_list_.link (*b);
+
+      return b;
+    }
+
+    /**
+     * @details
+     * The buffer must already be unlinked from the LRU list.
+     */
+    void
+    block_device_cache_impl::release_buffer (buffer* b)
+    {
+      hash_unlink (b);
+      b->dirty_ = false;
+      b->ahead_ = false;
+      free_list_.link (*b);
+    }
+
+    int
+    block_device_cache_impl::write_back (buffer* b)
+    {
+      ssize_t ret = parent_.write_block (b->data_, b->blknum_, 1);
+      if (ret < 0)
+        {
+          return -1;
+        }
+
+      b->dirty_ = false;
+      ++statistics_.write_backs;
+
+      return 0;
+    }
+
+    /**
+     * @details
+     * Try all dirty buffers, even if some fail, and
+     * report the first error.
+     */
+    int
+    block_device_cache_impl::write_back_all (void)
+    {
+      int ret = 0;
+      for (auto&& b : lru_list_)
+        {
+          if (b.dirty_)
+            {
+              if (write_back (&b) < 0 && ret == 0)
+                {
+                  ret = -1;
+                }
+            }
+        }
+      return ret;
+    }
+
+    /**
+     * @details
+     * A read that continues exactly where a previous read of the same
+     * stream ended is sequential. Non sequential reads start a new
+     * stream, replacing the oldest one.
+     *
+     * The first sequential read opens a window of twice the request
+     * size; the window doubles each time a request is entirely served
+     * from prefetched blocks.
+     *
+     * When less than half of the window remains prefetched ahead
+     * of the stream, the following missing blocks are read with a
+     * single multi-block call. Read-ahead is a hint, errors are
+     * ignored.
+     */
+    void
+    block_device_cache_impl::prefetch (blknum_t blknum, std::size_t nblocks,
+                                       std::size_t ahead_hits)
+    {
+      blknum_t end = blknum + nblocks;
+
+      stream* st = nullptr;
+      for (auto&& s : streams_)
+        {
+          if (s.active_ && s.next_ == blknum)
+            {
+              st = &s;
+              break;
+            }
+        }
+
+      if (st == nullptr)
+        {
+          st = &streams_[next_stream_];
+          next_stream_ = (next_stream_ + 1)
+              % OS_INTEGER_POSIX_IO_BLOCK_DEVICE_CACHE_STREAMS;
+
+          st->active_ = true;
+          st->next_ = end;
+          st->ahead_end_ = end;
+          st->window_ = 0;
+          return;
+        }
+
+      st->next_ = end;
+      if (st->window_ == 0)
+        {
+          st->window_ = 2 * nblocks;
+        }
+      else if (ahead_hits == nblocks)
+        {
+          st->window_ *= 2;
+        }
+
+      // The active streams share the read-ahead buffers.
+      std::size_t nstreams = 0;
+      for (auto&& s : streams_)
+        {
+          if (s.active_)
+            {
+              ++nstreams;
+            }
+        }
+      std::size_t max_window = read_ahead_max_blocks_ / nstreams;
+      if (max_window == 0)
+        {
+          max_window = 1;
+        }
+      if (st->window_ > max_window)
+        {
+          st->window_ = max_window;
+        }
+
+      if (st->ahead_end_ < end)
+        {
+          st->ahead_end_ = end;
+        }
+
+      std::size_t remaining = st->ahead_end_ - end;
+      if (2 * remaining > st->window_)
+        {
+          return;
+        }
+
+      blknum_t start = st->ahead_end_;
+      std::size_t count = st->window_ - remaining;
+      if (start + count > num_blocks_)
+        {
+          count = (start < num_blocks_) ? num_blocks_ - start : 0;
+        }
+
+      // Skip blocks already in the cache.
+      while (count > 0 && find (start) != nullptr)
+        {
+          ++start;
+          --count;
+        }
+      std::size_t n = 0;
+      while (n < count && find (start + n) == nullptr)
+        {
+          ++n;
+        }
+      st->ahead_end_ = start;
+      if (n == 0)
+        {
+          return;
+        }
+
+      // The block size may change when reopened, compare bytes.
+      if (ahead_buffer_size_bytes_ < n * block_logical_size_bytes_)
+        {
+          delete[] ahead_buffer_;
+          ahead_buffer_size_bytes_ = read_ahead_max_blocks_
+              * block_logical_size_bytes_;
+          ahead_buffer_ = new uint8_t[ahead_buffer_size_bytes_];
+        }
+
+      int saved_errno = errno;
+      ssize_t ret = parent_.read_block (ahead_buffer_, start, n);
+      if (ret < 0)
+        {
+          errno = saved_errno;
+          return;
+        }
+
+      for (std::size_t k = 0; k < n; ++k)
+        {
+          buffer* b = allocate_buffer (start + k);
+          if (b == nullptr)
+            {
+              break;
+            }
+          std::memcpy (b->data_, ahead_buffer_ + k * block_logical_size_bytes_,
+                       block_logical_size_bytes_);
+          b->ahead_ = true;
+          ++statistics_.read_ahead_blocks;
+          st->ahead_end_ = start + k + 1;
+        }
+      errno = saved_errno;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
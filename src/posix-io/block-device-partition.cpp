@@ -27,6 +27,7 @@
 
 #include <cmsis-plus/posix-io/block-device-partition.h>
 
+#include <cmsis-plus/posix/sys/mman.h>
 #include <cmsis-plus/diag/trace.h>
 
 // ----------------------------------------------------------------------------
@@ -157,6 +158,85 @@ namespace os
                                   nblocks);
     }
 
+    ssize_t
+    block_device_partition_impl::do_readv_block (const struct iovec* iov,
+                                                 int iovcnt, blknum_t blknum)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
+      trace::printf ("block_device_partition_impl::%s(%p, %d, %u) @%p\n",
+                     __func__, iov, iovcnt, blknum, this);
+#endif
+
+      return parent_.readv_block (iov, iovcnt,
+                                  blknum + partition_offset_blocks_);
+    }
+
+    ssize_t
+    block_device_partition_impl::do_writev_block (const struct iovec* iov,
+                                                  int iovcnt, blknum_t blknum)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
+      trace::printf ("block_device_partition_impl::%s(%p, %d, %u) @%p\n",
+                     __func__, iov, iovcnt, blknum, this);
+#endif
+
+      return parent_.writev_block (iov, iovcnt,
+                                   blknum + partition_offset_blocks_);
+    }
+
+    int
+    block_device_partition_impl::do_discard (blknum_t blknum,
+                                             std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
+      trace::printf ("block_device_partition_impl::%s(%u, %u) @%p\n",
+                     __func__, blknum, nblocks, this);
+#endif
+
+      return parent_.discard_blocks (blknum + partition_offset_blocks_,
+                                     nblocks);
+    }
+
+    void*
+    block_device_partition_impl::do_mmap (std::size_t length, int prot,
+                                          int flags, off_t offset)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION)
+      trace::printf ("block_device_partition_impl::%s(%u, %d) @%p\n",
+                     __func__, length, offset, this);
+#endif
+
+      if ((static_cast<std::size_t> (offset) % block_logical_size_bytes_)
+          != 0)
+        {
+          errno = EINVAL;
+          return MAP_FAILED;
+        }
+
+      std::size_t nblocks = (length + block_logical_size_bytes_ - 1)
+          / block_logical_size_bytes_;
+      blknum_t blknum = static_cast<std::size_t> (offset)
+          / block_logical_size_bytes_;
+
+      if (blknum + nblocks > num_blocks_)
+        {
+          errno = ENXIO;
+          return MAP_FAILED;
+        }
+
+      return parent_.mmap (
+          length, prot, flags,
+          offset
+              + static_cast<off_t> (partition_offset_blocks_
+                  * block_logical_size_bytes_));
+    }
+
+    int
+    block_device_partition_impl::do_munmap (void* addr, std::size_t length)
+    {
+      return parent_.munmap (addr, length);
+    }
+
     void
     block_device_partition_impl::do_sync (void)
     {
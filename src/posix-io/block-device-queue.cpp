@@ -0,0 +1,506 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/block-device-queue.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <cstring>
+#include <cassert>
+#include <cerrno>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    block_device_queue::block_device_queue (block_device_queue_impl& impl,
+                                            const char* name) :
+        block_device
+          { impl, name }
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+      trace::printf ("block_device_queue::%s(\"%s\")=@%p\n", __func__, name_,
+                     this);
+#endif
+    }
+
+    block_device_queue::~block_device_queue ()
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+      trace::printf ("block_device_queue::%s() @%p %s\n", __func__, this,
+                     name_);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    int
+    block_device_queue::flush (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+      trace::printf ("block_device_queue::%s() @%p\n", __func__, this);
+#endif
+
+      errno = 0;
+
+      return impl ().flush ();
+    }
+
+    int
+    block_device_queue::flush_expired (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+      trace::printf ("block_device_queue::%s() @%p\n", __func__, this);
+#endif
+
+      errno = 0;
+
+      return impl ().flush_expired ();
+    }
+
+    // ========================================================================
+
+    /**
+     * @details
+     * The slots descriptors are allocated here; the slots content
+     * is allocated on the first open(), when the block size
+     * of the parent is known.
+     */
+    block_device_queue_impl::block_device_queue_impl (
+        block_device& parent, std::size_t nslots,
+        rtos::clock::duration_t timeout) :
+        parent_ (parent), //
+        num_slots_ (nslots), //
+        timeout_ (timeout)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+      trace::printf ("block_device_queue_impl::%s(%u, %u)=@%p\n", __func__,
+                     nslots, timeout, this);
+#endif
+
+      assert(num_slots_ > 0);
+
+      slots_ = new slot[num_slots_];
+      pending_ = new slot*[num_slots_];
+      free_ = new slot*[num_slots_];
+
+      for (std::size_t i = 0; i < num_slots_; ++i)
+        {
+          free_[i] = &slots_[i];
+        }
+      num_free_ = num_slots_;
+    }
+
+    block_device_queue_impl::~block_device_queue_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+      trace::printf ("block_device_queue_impl::%s() @%p\n", __func__, this);
+#endif
+
+      delete[] merge_buffer_;
+      delete[] arena_;
+      delete[] free_;
+      delete[] pending_;
+      delete[] slots_;
+    }
+
+    // ------------------------------------------------------------------------
+
+    int
+    block_device_queue_impl::do_vioctl (int request, std::va_list args)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+      trace::printf ("block_device_queue_impl::%s(%d) @%p\n", __func__,
+                     request, this);
+#endif
+
+      return parent_.vioctl (request, args);
+    }
+
+    int
+    block_device_queue_impl::do_vopen (const char* path, int oflag,
+                                       std::va_list args)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+      trace::printf ("block_device_queue_impl::%s(%d) @%p\n", __func__, oflag,
+                     this);
+#endif
+
+      int ret = parent_.vopen (path, oflag, args);
+      if (ret < 0)
+        {
+          return ret;
+        }
+
+      // Inherit from parent.
+      block_logical_size_bytes_ = parent_.block_logical_size_bytes ();
+      block_physical_size_bytes_ = parent_.block_physical_size_bytes ();
+      num_blocks_ = parent_.blocks ();
+
+      if (arena_block_size_bytes_ != block_logical_size_bytes_)
+        {
+          // Different media, forget the blocks that could
+          // not be written.
+          drop (0, num_blocks_);
+
+          delete[] merge_buffer_;
+          delete[] arena_;
+          arena_ = new uint8_t[num_slots_ * block_logical_size_bytes_];
+          merge_buffer_ = new uint8_t[num_slots_ * block_logical_size_bytes_];
+          arena_block_size_bytes_ = block_logical_size_bytes_;
+
+          for (std::size_t i = 0; i < num_slots_; ++i)
+            {
+              slots_[i].data_ = arena_ + i * block_logical_size_bytes_;
+            }
+        }
+
+      return ret;
+    }
+
+    /**
+     * @details
+     * Queued blocks are copied from the queue; the runs of
+     * blocks between them are read from the parent with
+     * multi-block calls.
+     */
+    ssize_t
+    block_device_queue_impl::do_read_block (void* buf, blknum_t blknum,
+                                            std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+      trace::printf ("block_device_queue_impl::%s(%p, %u, %u) @%p\n",
+                     __func__, buf, blknum, nblocks, this);
+#endif
+
+      uint8_t* p = static_cast<uint8_t*> (buf);
+      blknum_t end = blknum + nblocks;
+      std::size_t idx = find (blknum);
+      blknum_t b = blknum;
+      while (b < end)
+        {
+          if (idx < num_pending_ && pending_[idx]->blknum_ == b)
+            {
+              std::memcpy (p, pending_[idx]->data_, block_logical_size_bytes_);
+              p += block_logical_size_bytes_;
+              ++idx;
+              ++b;
+              continue;
+            }
+
+          blknum_t next = end;
+          if (idx < num_pending_ && pending_[idx]->blknum_ < end)
+            {
+              next = pending_[idx]->blknum_;
+            }
+
+          ssize_t ret = parent_.read_block (p, b, next - b);
+          if (ret < 0)
+            {
+              return ret;
+            }
+          p += (next - b) * block_logical_size_bytes_;
+          b = next;
+        }
+
+      if (flush_expired () < 0)
+        {
+          return -1;
+        }
+
+      return static_cast<ssize_t> (nblocks);
+    }
+
+    /**
+     * @details
+     * Requests larger than the queue are written directly
+     * to the parent, and the queued copies of the same blocks
+     * are dropped.
+     */
+    ssize_t
+    block_device_queue_impl::do_write_block (const void* buf, blknum_t blknum,
+                                             std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+      trace::printf ("block_device_queue_impl::%s(%p, %u, %u) @%p\n",
+                     __func__, buf, blknum, nblocks, this);
+#endif
+
+      const uint8_t* p = static_cast<const uint8_t*> (buf);
+
+      if (nblocks >= num_slots_)
+        {
+          drop (blknum, nblocks);
+
+          ssize_t ret = parent_.write_block (buf, blknum, nblocks);
+          if (ret < 0)
+            {
+              return ret;
+            }
+          ++statistics_.transfers;
+          statistics_.written += nblocks;
+
+          return ret;
+        }
+
+      for (std::size_t i = 0; i < nblocks; ++i, p += block_logical_size_bytes_)
+        {
+          blknum_t b = blknum + i;
+          ++statistics_.queued;
+
+          std::size_t idx = find (b);
+          if (idx < num_pending_ && pending_[idx]->blknum_ == b)
+            {
+              // Already queued, update it.
+              std::memcpy (pending_[idx]->data_, p, block_logical_size_bytes_);
+              ++statistics_.absorbed;
+              continue;
+            }
+
+          if (num_free_ == 0)
+            {
+              if (flush () < 0)
+                {
+                  return -1;
+                }
+              idx = 0;
+            }
+
+          if (num_pending_ == 0)
+            {
+              oldest_ = rtos::sysclock.now ();
+            }
+
+          slot* s = free_[--num_free_];
+          s->blknum_ = b;
+          std::memcpy (s->data_, p, block_logical_size_bytes_);
+
+          // Keep the queue sorted.
+          std::memmove (&pending_[idx + 1], &pending_[idx],
+                        (num_pending_ - idx) * sizeof(pending_[0]));
+          pending_[idx] = s;
+          ++num_pending_;
+        }
+
+      if (flush_expired () < 0)
+        {
+          return -1;
+        }
+
+      return static_cast<ssize_t> (nblocks);
+    }
+
+    /**
+     * @details
+     * The queued copies of the discarded blocks are dropped.
+     */
+    int
+    block_device_queue_impl::do_discard (blknum_t blknum, std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+      trace::printf ("block_device_queue_impl::%s(%u, %u) @%p\n", __func__,
+                     blknum, nblocks, this);
+#endif
+
+      drop (blknum, nblocks);
+
+      return parent_.discard_blocks (blknum, nblocks);
+    }
+
+    void
+    block_device_queue_impl::do_sync (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+      trace::printf ("block_device_queue_impl::%s() @%p\n", __func__, this);
+#endif
+
+      flush ();
+
+      return parent_.sync ();
+    }
+
+    int
+    block_device_queue_impl::do_close (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+      trace::printf ("block_device_queue_impl::%s() @%p\n", __func__, this);
+#endif
+
+      int ret = flush ();
+
+      int ret2 = parent_.close ();
+      return (ret < 0) ? ret : ret2;
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * The queue is walked in ascending block order; each run of
+     * adjacent blocks is written with a single request.
+     *
+     * If a write fails, the blocks not yet written remain queued.
+     */
+    int
+    block_device_queue_impl::flush (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_QUEUE)
+      trace::printf ("block_device_queue_impl::%s() @%p\n", __func__, this);
+#endif
+
+      if (num_pending_ == 0)
+        {
+          return 0;
+        }
+
+      ++statistics_.flushes;
+
+      int ret = 0;
+      std::size_t i = 0;
+      while (i < num_pending_)
+        {
+          std::size_t j = i + 1;
+          while (j < num_pending_
+              && pending_[j]->blknum_ == pending_[j - 1]->blknum_ + 1)
+            {
+              ++j;
+            }
+
+          const void* p;
+          if (j - i == 1)
+            {
+              p = pending_[i]->data_;
+            }
+          else
+            {
+              for (std::size_t k = i; k < j; ++k)
+                {
+                  std::memcpy (
+                      merge_buffer_ + (k - i) * block_logical_size_bytes_,
+                      pending_[k]->data_, block_logical_size_bytes_);
+                }
+              p = merge_buffer_;
+            }
+
+          if (parent_.write_block (p, pending_[i]->blknum_, j - i) < 0)
+            {
+              ret = -1;
+              break;
+            }
+          ++statistics_.transfers;
+          statistics_.written += (j - i);
+
+          for (std::size_t k = i; k < j; ++k)
+            {
+              free_[num_free_++] = pending_[k];
+            }
+          i = j;
+        }
+
+      // Keep what was not written.
+      std::memmove (&pending_[0], &pending_[i],
+                    (num_pending_ - i) * sizeof(pending_[0]));
+      num_pending_ -= i;
+
+      return ret;
+    }
+
+    int
+    block_device_queue_impl::flush_expired (void)
+    {
+      if (timeout_ == 0 || num_pending_ == 0)
+        {
+          return 0;
+        }
+
+      if (rtos::sysclock.now () - oldest_ < timeout_)
+        {
+          return 0;
+        }
+
+      return flush ();
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * Binary search in the sorted queue.
+     *
+     * @return The index of the first queued block with a number
+     *  greater or equal to `blknum`.
+     */
+    std::size_t
+    block_device_queue_impl::find (blknum_t blknum)
+    {
+      std::size_t lo = 0;
+      std::size_t hi = num_pending_;
+      while (lo < hi)
+        {
+          std::size_t mid = lo + (hi - lo) / 2;
+          if (pending_[mid]->blknum_ < blknum)
+            {
+              lo = mid + 1;
+            }
+          else
+            {
+              hi = mid;
+            }
+        }
+      return lo;
+    }
+
+    /**
+     * @details
+     * Remove from the queue, without writing them, the blocks
+     * in the given range.
+     */
+    void
+    block_device_queue_impl::drop (blknum_t blknum, std::size_t nblocks)
+    {
+      std::size_t first = find (blknum);
+      std::size_t last = first;
+      while (last < num_pending_ && pending_[last]->blknum_ < blknum + nblocks)
+        {
+          free_[num_free_++] = pending_[last];
+          ++last;
+        }
+
+      std::memmove (&pending_[first], &pending_[last],
+                    (num_pending_ - last) * sizeof(pending_[0]));
+      num_pending_ -= (last - first);
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
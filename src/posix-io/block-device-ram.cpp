@@ -0,0 +1,291 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/block-device-ram.h>
+
+#include <cmsis-plus/posix/sys/mman.h>
+#include <cmsis-plus/posix/sys/uio.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <cstring>
+#include <cerrno>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    /**
+     * @details
+     * The storage is not allocated here, but on the first open(),
+     * so static devices can be constructed before the memory
+     * resources are initialised.
+     */
+    block_device_ram_impl::block_device_ram_impl (
+        std::size_t block_size_bytes, blknum_t nblocks,
+        rtos::memory::memory_resource* mr) :
+        mr_ (mr)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_RAM)
+      trace::printf ("block_device_ram_impl::%s(%u,%u)=@%p\n", __func__,
+                     block_size_bytes, nblocks, this);
+#endif
+
+      block_logical_size_bytes_ = block_size_bytes;
+      block_physical_size_bytes_ = block_size_bytes;
+      num_blocks_ = nblocks;
+    }
+
+    block_device_ram_impl::~block_device_ram_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_RAM)
+      trace::printf ("block_device_ram_impl::%s() @%p\n", __func__, this);
+#endif
+
+      if (arena_ != nullptr)
+        {
+          mr_->deallocate (arena_, arena_size_bytes_);
+        }
+    }
+
+    // ------------------------------------------------------------------------
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    int
+    block_device_ram_impl::do_vioctl (int request, std::va_list args)
+    {
+      errno = ENOSYS;
+      return -1;
+    }
+
+    int
+    block_device_ram_impl::do_vopen (const char* path, int oflag,
+                                     std::va_list args)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_RAM)
+      trace::printf ("block_device_ram_impl::%s() @%p\n", __func__, this);
+#endif
+
+      if (arena_ != nullptr)
+        {
+          // Reopened, keep the content.
+          return 0;
+        }
+
+      std::size_t size = static_cast<std::size_t> (num_blocks_)
+          * block_logical_size_bytes_;
+      void* p = mr_->allocate (size);
+      if (p == nullptr)
+        {
+          errno = ENOMEM;
+          return -1;
+        }
+
+      arena_ = static_cast<uint8_t*> (p);
+      arena_size_bytes_ = size;
+      std::memset (arena_, 0, size);
+
+      return 0;
+    }
+
+#pragma GCC diagnostic pop
+
+    ssize_t
+    block_device_ram_impl::do_read_block (void* buf, blknum_t blknum,
+                                          std::size_t nblocks)
+    {
+      std::size_t bytes = nblocks * block_logical_size_bytes_;
+      std::memcpy (buf, block_address (blknum), bytes);
+      delay (bytes);
+
+      return static_cast<ssize_t> (nblocks);
+    }
+
+    ssize_t
+    block_device_ram_impl::do_write_block (const void* buf, blknum_t blknum,
+                                           std::size_t nblocks)
+    {
+      std::size_t bytes = nblocks * block_logical_size_bytes_;
+      std::memcpy (block_address (blknum), buf, bytes);
+      delay (bytes);
+
+      return static_cast<ssize_t> (nblocks);
+    }
+
+    /**
+     * @details
+     * Each buffer is copied directly; the transfer is charged
+     * as a single command.
+     */
+    ssize_t
+    block_device_ram_impl::do_readv_block (const struct iovec* iov,
+                                           int iovcnt, blknum_t blknum)
+    {
+      uint8_t* p = block_address (blknum);
+      std::size_t bytes = 0;
+      for (int i = 0; i < iovcnt; ++i)
+        {
+          std::memcpy (iov[i].iov_base, p + bytes, iov[i].iov_len);
+          bytes += iov[i].iov_len;
+        }
+      delay (bytes);
+
+      return static_cast<ssize_t> (bytes / block_logical_size_bytes_);
+    }
+
+    ssize_t
+    block_device_ram_impl::do_writev_block (const struct iovec* iov,
+                                            int iovcnt, blknum_t blknum)
+    {
+      uint8_t* p = block_address (blknum);
+      std::size_t bytes = 0;
+      for (int i = 0; i < iovcnt; ++i)
+        {
+          std::memcpy (p + bytes, iov[i].iov_base, iov[i].iov_len);
+          bytes += iov[i].iov_len;
+        }
+      delay (bytes);
+
+      return static_cast<ssize_t> (bytes / block_logical_size_bytes_);
+    }
+
+    int
+    block_device_ram_impl::do_discard (blknum_t blknum, std::size_t nblocks)
+    {
+      std::memset (block_address (blknum), 0,
+                   nblocks * block_logical_size_bytes_);
+      return 0;
+    }
+
+    /**
+     * @details
+     * Writable private mappings get a copy, since changes
+     * must not reach the storage.
+     */
+    void*
+    block_device_ram_impl::do_mmap (std::size_t length, int prot, int flags,
+                                    off_t offset)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_RAM)
+      trace::printf ("block_device_ram_impl::%s(%u, %d) @%p\n", __func__,
+                     length, offset, this);
+#endif
+
+      if (((flags & MAP_PRIVATE) != 0) && ((prot & PROT_WRITE) != 0))
+        {
+          return block_device_impl::do_mmap (length, prot, flags, offset);
+        }
+
+      if (static_cast<std::size_t> (offset) + length > arena_size_bytes_)
+        {
+          errno = ENXIO;
+          return MAP_FAILED;
+        }
+
+      return arena_ + offset;
+    }
+
+    int
+    block_device_ram_impl::do_munmap (void* addr, std::size_t length)
+    {
+      uint8_t* p = static_cast<uint8_t*> (addr);
+      if (p >= arena_ && p < arena_ + arena_size_bytes_)
+        {
+          if (length > static_cast<std::size_t> (arena_ + arena_size_bytes_
+              - p))
+            {
+              errno = EINVAL; // Past the end of the storage.
+              return -1;
+            }
+
+          // Direct mapping, nothing to release.
+          return 0;
+        }
+
+      return block_device_impl::do_munmap (addr, length);
+    }
+
+    void
+    block_device_ram_impl::do_sync (void)
+    {
+      ;
+    }
+
+    int
+    block_device_ram_impl::do_close (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_RAM)
+      trace::printf ("block_device_ram_impl::%s() @%p\n", __func__, this);
+#endif
+
+      return 0;
+    }
+
+    // ------------------------------------------------------------------------
+
+    void
+    block_device_ram_impl::latency (rtos::clock::duration_t command,
+                                    std::size_t bytes_per_tick)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE_RAM)
+      trace::printf ("block_device_ram_impl::%s(%u,%u) @%p\n", __func__,
+                     command, bytes_per_tick, this);
+#endif
+
+      command_ticks_ = command;
+      bytes_per_tick_ = bytes_per_tick;
+      pending_bytes_ = 0;
+    }
+
+    void
+    block_device_ram_impl::delay (std::size_t bytes)
+    {
+      rtos::clock::duration_t ticks = command_ticks_;
+      if (bytes_per_tick_ != 0)
+        {
+          pending_bytes_ += bytes;
+          ticks += static_cast<rtos::clock::duration_t> (pending_bytes_
+              / bytes_per_tick_);
+          pending_bytes_ %= bytes_per_tick_;
+        }
+
+      if (ticks > 0)
+        {
+          rtos::sysclock.sleep_for (ticks);
+        }
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,136 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/block-device-worker.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <cerrno>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    block_device_worker::block_device_worker (
+        const char* name, const rtos::thread::attributes& attr) :
+        requests_ (true), //
+        sem_
+          { name, 0 }, //
+        thread_
+          { name, run, this, attr }
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device_worker::%s(\"%s\")=@%p\n", __func__, name,
+                     this);
+#endif
+    }
+
+    block_device_worker::~block_device_worker ()
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device_worker::%s() @%p\n", __func__, this);
+#endif
+
+      // Let the thread complete the queued requests and terminate.
+      stopping_ = true;
+      sem_.post ();
+      thread_.join ();
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * Can be called from interrupt service routines.
+     */
+    void
+    block_device_worker::enqueue (block_device_request& req)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device_worker::%s(@%p) @%p\n", __func__, &req,
+                     this);
+#endif
+
+        {
+          rtos::interrupts::critical_section ics;
+
+          requests_.link (req);
+        }
+
+      sem_.post ();
+    }
+
+    /**
+     * @details
+     * Wait for requests, and execute all queued requests
+     * each time it is woken up; return when the worker is
+     * destroyed and the queue is empty.
+     */
+    void*
+    block_device_worker::run (void* args)
+    {
+      block_device_worker* self = static_cast<block_device_worker*> (args);
+
+      for (;;)
+        {
+          self->sem_.wait ();
+
+          for (;;)
+            {
+              block_device_request* req;
+                {
+                  rtos::interrupts::critical_section ics;
+
+                  if (self->requests_.empty ())
+                    {
+                      break;
+                    }
+                  req = self->requests_.unlink_head ();
+                }
+
+              ssize_t ret = req->execute ();
+              req->complete (ret, (ret < 0) ? errno : 0);
+            }
+
+          if (self->stopping_)
+            {
+              break;
+            }
+        }
+
+      return nullptr;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
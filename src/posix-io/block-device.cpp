@@ -26,9 +26,12 @@
  */
 
 #include <cmsis-plus/posix-io/block-device.h>
+#include <cmsis-plus/posix-io/block-device-worker.h>
 #include <cmsis-plus/posix-io/device-registry.h>
 
 #include <cmsis-plus/posix/sys/ioctl.h>
+#include <cmsis-plus/posix/sys/mman.h>
+#include <cmsis-plus/posix/sys/uio.h>
 
 #include <cstring>
 #include <cassert>
@@ -83,7 +86,19 @@ namespace os
           return -1;
         }
 
-      return impl ().do_read_block (buf, blknum, nblocks);
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      ssize_t ret = impl ().do_read_block (buf, blknum, nblocks);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      ssize_t bytes = (ret > 0) ? ret * static_cast<ssize_t> (
+          impl ().block_logical_size_bytes_) : ret;
+      impl ().account_read (begin, bytes);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      return ret;
     }
 
     ssize_t
@@ -107,7 +122,276 @@ namespace os
           return -1;
         }
 
-      return impl ().do_write_block (buf, blknum, nblocks);
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      ssize_t ret = impl ().do_write_block (buf, blknum, nblocks);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      ssize_t bytes = (ret > 0) ? ret * static_cast<ssize_t> (
+          impl ().block_logical_size_bytes_) : ret;
+      impl ().account_write (begin, bytes);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      return ret;
+    }
+
+    ssize_t
+    block_device::readv_block (const struct iovec* iov, int iovcnt,
+                               blknum_t blknum)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device::%s(%p, %d, %u) @%p\n", __func__, iov,
+                     iovcnt, blknum, this);
+#endif
+
+      if (iov == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if (iovcnt <= 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      std::size_t nblocks = 0;
+      for (int i = 0; i < iovcnt; ++i)
+        {
+          if (iov[i].iov_len % impl ().block_logical_size_bytes_ != 0)
+            {
+              errno = EINVAL; // Not an integral number of blocks.
+              return -1;
+            }
+          nblocks += iov[i].iov_len / impl ().block_logical_size_bytes_;
+        }
+
+      if (blknum + nblocks > impl ().num_blocks_)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      ssize_t ret = impl ().do_readv_block (iov, iovcnt, blknum);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      ssize_t bytes = (ret > 0) ? ret * static_cast<ssize_t> (
+          impl ().block_logical_size_bytes_) : ret;
+      impl ().account_read (begin, bytes);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      return ret;
+    }
+
+    ssize_t
+    block_device::writev_block (const struct iovec* iov, int iovcnt,
+                                blknum_t blknum)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device::%s(%p, %d, %u) @%p\n", __func__, iov,
+                     iovcnt, blknum, this);
+#endif
+
+      if (iov == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if (iovcnt <= 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      std::size_t nblocks = 0;
+      for (int i = 0; i < iovcnt; ++i)
+        {
+          if (iov[i].iov_len % impl ().block_logical_size_bytes_ != 0)
+            {
+              errno = EINVAL; // Not an integral number of blocks.
+              return -1;
+            }
+          nblocks += iov[i].iov_len / impl ().block_logical_size_bytes_;
+        }
+
+      if (blknum + nblocks > impl ().num_blocks_)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      ssize_t ret = impl ().do_writev_block (iov, iovcnt, blknum);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      ssize_t bytes = (ret > 0) ? ret * static_cast<ssize_t> (
+          impl ().block_logical_size_bytes_) : ret;
+      impl ().account_write (begin, bytes);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      return ret;
+    }
+
+    int
+    block_device::discard_blocks (blknum_t blknum, std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device::%s(%u, %u) @%p\n", __func__, blknum,
+                     nblocks, this);
+#endif
+
+      if (blknum + nblocks > impl ().num_blocks_)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      if (nblocks == 0)
+        {
+          return 0;
+        }
+
+      errno = 0;
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      int ret = impl ().do_discard (blknum, nblocks);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_other (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      return ret;
+    }
+
+    int
+    block_device::submit_read_block (block_device_request& req, void* buf,
+                                     blknum_t blknum, std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device::%s(@%p, %p, %u, %u) @%p\n", __func__,
+                     &req, buf, blknum, nblocks, this);
+#endif
+
+      if (!req.done_)
+        {
+          errno = EBUSY; // Still in progress.
+          return -1;
+        }
+
+      if (blknum + nblocks > impl ().num_blocks_)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      req.device_ = this;
+      req.op_ = block_device_request::operation::read;
+      req.buf_ = buf;
+      req.blknum_ = blknum;
+      req.nblocks_ = nblocks;
+      req.result_ = 0;
+      req.error_ = 0;
+      req.done_ = false;
+
+      // Forget a completion not consumed by wait().
+      req.sem_.reset ();
+
+      errno = 0;
+
+      int ret = impl ().do_submit (req);
+      if (ret < 0)
+        {
+          req.done_ = true;
+        }
+      return ret;
+    }
+
+    int
+    block_device::submit_write_block (block_device_request& req,
+                                      const void* buf, blknum_t blknum,
+                                      std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device::%s(@%p, %p, %u, %u) @%p\n", __func__,
+                     &req, buf, blknum, nblocks, this);
+#endif
+
+      if (!req.done_)
+        {
+          errno = EBUSY; // Still in progress.
+          return -1;
+        }
+
+      if (blknum + nblocks > impl ().num_blocks_)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      req.device_ = this;
+      req.op_ = block_device_request::operation::write;
+      req.buf_ = const_cast<void*> (buf);
+      req.blknum_ = blknum;
+      req.nblocks_ = nblocks;
+      req.result_ = 0;
+      req.error_ = 0;
+      req.done_ = false;
+
+      // Forget a completion not consumed by wait().
+      req.sem_.reset ();
+
+      errno = 0;
+
+      int ret = impl ().do_submit (req);
+      if (ret < 0)
+        {
+          req.done_ = true;
+        }
+      return ret;
     }
 
     int
@@ -170,10 +454,42 @@ namespace os
             return 0;
           }
 
+        case BLKDISCARD:
+          // Discard a range of bytes, aligned to the logical block size.
+          {
+            uint64_t* range = va_arg(args, uint64_t*);
+            std::size_t bsz = impl ().block_logical_size_bytes_;
+            if (range == nullptr || (range[0] % bsz) != 0
+                || (range[1] % bsz) != 0)
+              {
+                errno = EINVAL;
+                return -1;
+              }
+
+            uint64_t total = static_cast<uint64_t> (impl ().num_blocks_)
+                * bsz;
+            if (range[0] > total || range[1] > total - range[0])
+              {
+                errno = EINVAL;
+                return -1;
+              }
+            blknum_t blknum = static_cast<blknum_t> (range[0] / bsz);
+            std::size_t nblocks = static_cast<std::size_t> (range[1] / bsz);
+            if (nblocks == 0)
+              {
+                return 0;
+              }
+
+            // Call the implementation directly, the lockable
+            // wrapper already holds the lock.
+            return impl ().do_discard (blknum, nblocks);
+          }
+
         default:
 
-          // Execute the implementation specific code.
-          return impl ().do_vioctl (request, args);
+          // The common requests (like the statistics), then
+          // the implementation specific code.
+          return device::vioctl (request, args);
         }
     }
 
@@ -198,6 +514,163 @@ namespace os
 
     // ------------------------------------------------------------------------
 
+    int
+    block_device_impl::do_submit (block_device_request& req)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device_impl::%s(@%p) @%p\n", __func__, &req,
+                     this);
+#endif
+
+      if (worker_ != nullptr)
+        {
+          worker_->enqueue (req);
+          return 0;
+        }
+
+      ssize_t ret = req.execute ();
+      req.complete (ret, (ret < 0) ? errno : 0);
+
+      return 0;
+    }
+
+    ssize_t
+    block_device_impl::do_readv_block (const struct iovec* iov, int iovcnt,
+                                       blknum_t blknum)
+    {
+      ssize_t total = 0;
+
+      int i = 0;
+      while (i < iovcnt)
+        {
+          // Merge the buffers adjacent in memory into a single call.
+          uint8_t* base = static_cast<uint8_t*> (iov[i].iov_base);
+          std::size_t len = iov[i].iov_len;
+          for (++i;
+              i < iovcnt
+                  && static_cast<uint8_t*> (iov[i].iov_base) == base + len;
+              ++i)
+            {
+              len += iov[i].iov_len;
+            }
+
+          std::size_t n = len / block_logical_size_bytes_;
+          if (n == 0)
+            {
+              continue;
+            }
+          ssize_t ret = do_read_block (base, blknum, n);
+          if (ret < 0)
+            {
+              return ret;
+            }
+          total += ret;
+          if (static_cast<std::size_t> (ret) < n)
+            {
+              // Do not continue past a short transfer.
+              break;
+            }
+          blknum += static_cast<blknum_t> (n);
+        }
+      return total;
+    }
+
+    ssize_t
+    block_device_impl::do_writev_block (const struct iovec* iov, int iovcnt,
+                                        blknum_t blknum)
+    {
+      ssize_t total = 0;
+
+      int i = 0;
+      while (i < iovcnt)
+        {
+          // Merge the buffers adjacent in memory into a single call.
+          uint8_t* base = static_cast<uint8_t*> (iov[i].iov_base);
+          std::size_t len = iov[i].iov_len;
+          for (++i;
+              i < iovcnt
+                  && static_cast<uint8_t*> (iov[i].iov_base) == base + len;
+              ++i)
+            {
+              len += iov[i].iov_len;
+            }
+
+          std::size_t n = len / block_logical_size_bytes_;
+          if (n == 0)
+            {
+              continue;
+            }
+          ssize_t ret = do_write_block (base, blknum, n);
+          if (ret < 0)
+            {
+              return ret;
+            }
+          total += ret;
+          if (static_cast<std::size_t> (ret) < n)
+            {
+              // Do not continue past a short transfer.
+              break;
+            }
+          blknum += static_cast<blknum_t> (n);
+        }
+      return total;
+    }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    int
+    block_device_impl::do_discard (blknum_t blknum, std::size_t nblocks)
+    {
+      errno = ENOSYS; // Not implemented
+      return -1;
+    }
+
+#pragma GCC diagnostic pop
+
+    void*
+    block_device_impl::do_mmap (std::size_t length, int prot, int flags,
+                                off_t offset)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device_impl::%s(%u, %d) @%p\n", __func__, length,
+                     offset, this);
+#endif
+
+      if ((block_logical_size_bytes_ == 0)
+          || ((static_cast<std::size_t> (offset) % block_logical_size_bytes_)
+              != 0))
+        {
+          errno = EINVAL;
+          return MAP_FAILED;
+        }
+
+      std::size_t nblocks = (length + block_logical_size_bytes_ - 1)
+          / block_logical_size_bytes_;
+      blknum_t blknum = static_cast<std::size_t> (offset)
+          / block_logical_size_bytes_;
+
+      if (blknum + nblocks > num_blocks_)
+        {
+          errno = ENXIO;
+          return MAP_FAILED;
+        }
+
+      return io_impl::do_mmap (nblocks * block_logical_size_bytes_, prot,
+                               flags, offset);
+    }
+
+    int
+    block_device_impl::do_munmap (void* addr, std::size_t length)
+    {
+      std::size_t nblocks = (length + block_logical_size_bytes_ - 1)
+          / block_logical_size_bytes_;
+
+      return io_impl::do_munmap (addr, nblocks * block_logical_size_bytes_);
+    }
+
+    // ------------------------------------------------------------------------
+
     off_t
     block_device_impl::do_lseek (off_t offset, int whence)
     {
@@ -243,9 +716,53 @@ namespace os
                      nbyte, this);
 #endif
 
+      return do_pread (buf, nbyte, offset_);
+    }
+
+    ssize_t
+    block_device_impl::do_write (const void* buf, std::size_t nbyte)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device_impl::%s(%p, %u) @%p\n", __func__, buf,
+                     nbyte, this);
+#endif
+
+      return do_pwrite (buf, nbyte, offset_);
+    }
+
+    ssize_t
+    block_device_impl::do_readv (const struct iovec* iov, int iovcnt)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device_impl::%s(%p, %d) @%p\n", __func__, iov,
+                     iovcnt, this);
+#endif
+
+      return do_preadv (iov, iovcnt, offset_);
+    }
+
+    ssize_t
+    block_device_impl::do_writev (const struct iovec* iov, int iovcnt)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device_impl::%s(%p, %d) @%p\n", __func__, iov,
+                     iovcnt, this);
+#endif
+
+      return do_pwritev (iov, iovcnt, offset_);
+    }
+
+    ssize_t
+    block_device_impl::do_pread (void* buf, std::size_t nbyte, off_t offset)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device_impl::%s(%p, %u, %d) @%p\n", __func__,
+                     buf, nbyte, offset, this);
+#endif
+
       if ((block_logical_size_bytes_ == 0)
           || ((nbyte % block_logical_size_bytes_) != 0)
-          || ((static_cast<std::size_t> (offset_) % block_logical_size_bytes_)
+          || ((static_cast<std::size_t> (offset) % block_logical_size_bytes_)
               != 0))
         {
           errno = EINVAL;
@@ -253,7 +770,7 @@ namespace os
         }
 
       std::size_t nblocks = nbyte / block_logical_size_bytes_;
-      blknum_t blknum = static_cast<std::size_t> (offset_)
+      blknum_t blknum = static_cast<std::size_t> (offset)
           / block_logical_size_bytes_;
 
       if (blknum + nblocks > num_blocks_)
@@ -265,22 +782,23 @@ namespace os
       ssize_t ret = do_read_block (buf, blknum, nblocks);
       if (ret >= 0)
         {
-          ret *= block_logical_size_bytes_;
+          ret *= static_cast<ssize_t> (block_logical_size_bytes_);
         }
       return ret;
     }
 
     ssize_t
-    block_device_impl::do_write (const void* buf, std::size_t nbyte)
+    block_device_impl::do_pwrite (const void* buf, std::size_t nbyte,
+                                  off_t offset)
     {
 #if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
-      trace::printf ("block_device_impl::%s(%p, %u) @%p\n", __func__, buf,
-                     nbyte, this);
+      trace::printf ("block_device_impl::%s(%p, %u, %d) @%p\n", __func__,
+                     buf, nbyte, offset, this);
 #endif
 
       if ((block_logical_size_bytes_ == 0)
           || ((nbyte % block_logical_size_bytes_) != 0)
-          || ((static_cast<std::size_t> (offset_) % block_logical_size_bytes_)
+          || ((static_cast<std::size_t> (offset) % block_logical_size_bytes_)
               != 0))
         {
           errno = EINVAL;
@@ -288,7 +806,7 @@ namespace os
         }
 
       std::size_t nblocks = nbyte / block_logical_size_bytes_;
-      blknum_t blknum = static_cast<std::size_t> (offset_)
+      blknum_t blknum = static_cast<std::size_t> (offset)
           / block_logical_size_bytes_;
 
       if (blknum + nblocks > num_blocks_)
@@ -300,11 +818,207 @@ namespace os
       ssize_t ret = do_write_block (buf, blknum, nblocks);
       if (ret >= 0)
         {
-          ret *= block_logical_size_bytes_;
+          ret *= static_cast<ssize_t> (block_logical_size_bytes_);
         }
       return ret;
     }
 
+    /**
+     * @details
+     * All buffers must be multiples of the block size; they
+     * are transferred with a single `do_readv_block()` call.
+     */
+    ssize_t
+    block_device_impl::do_preadv (const struct iovec* iov, int iovcnt,
+                                  off_t offset)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device_impl::%s(%p, %d, %d) @%p\n", __func__,
+                     iov, iovcnt, offset, this);
+#endif
+
+      ssize_t nblocks = validate_vector (iov, iovcnt, offset);
+      if (nblocks <= 0)
+        {
+          return nblocks;
+        }
+
+      ssize_t ret = do_readv_block (
+          iov, iovcnt,
+          static_cast<std::size_t> (offset) / block_logical_size_bytes_);
+      if (ret >= 0)
+        {
+          ret *= static_cast<ssize_t> (block_logical_size_bytes_);
+        }
+      return ret;
+    }
+
+    ssize_t
+    block_device_impl::do_pwritev (const struct iovec* iov, int iovcnt,
+                                   off_t offset)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device_impl::%s(%p, %d, %d) @%p\n", __func__,
+                     iov, iovcnt, offset, this);
+#endif
+
+      ssize_t nblocks = validate_vector (iov, iovcnt, offset);
+      if (nblocks <= 0)
+        {
+          return nblocks;
+        }
+
+      ssize_t ret = do_writev_block (
+          iov, iovcnt,
+          static_cast<std::size_t> (offset) / block_logical_size_bytes_);
+      if (ret >= 0)
+        {
+          ret *= static_cast<ssize_t> (block_logical_size_bytes_);
+        }
+      return ret;
+    }
+
+    /**
+     * @details
+     * Check that the offset and all buffers are aligned
+     * to the block size, and that the range is inside the device.
+     *
+     * @return The number of blocks, or -1 if error (errno is set).
+     */
+    ssize_t
+    block_device_impl::validate_vector (const struct iovec* iov, int iovcnt,
+                                        off_t offset)
+    {
+      if ((block_logical_size_bytes_ == 0)
+          || ((static_cast<std::size_t> (offset) % block_logical_size_bytes_)
+              != 0))
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      std::size_t nblocks = 0;
+      for (int i = 0; i < iovcnt; ++i)
+        {
+          if ((iov[i].iov_len % block_logical_size_bytes_) != 0)
+            {
+              errno = EINVAL;
+              return -1;
+            }
+          nblocks += iov[i].iov_len / block_logical_size_bytes_;
+        }
+
+      blknum_t blknum = static_cast<std::size_t> (offset)
+          / block_logical_size_bytes_;
+      if (blknum + nblocks > num_blocks_)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      return static_cast<ssize_t> (nblocks);
+    }
+
+    // ========================================================================
+
+    block_device_request::block_device_request (callback_t callback,
+                                                void* args) :
+        callback_ (callback), //
+        args_ (args), //
+        sem_
+          { "block_device_request", 0 }
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device_request::%s()=@%p\n", __func__, this);
+#endif
+    }
+
+    block_device_request::~block_device_request ()
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device_request::%s() @%p\n", __func__, this);
+#endif
+
+      assert(done_);
+    }
+
+    // ------------------------------------------------------------------------
+
+    ssize_t
+    block_device_request::wait (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device_request::%s() @%p\n", __func__, this);
+#endif
+
+      // Each completion posts the semaphore once; consume it.
+      if (done_)
+        {
+          sem_.try_wait ();
+        }
+      else
+        {
+          sem_.wait ();
+        }
+
+      if (result_ < 0)
+        {
+          errno = error_;
+        }
+      return result_;
+    }
+
+    /**
+     * @details
+     * Use the public device functions, so that the
+     * locks of the lockable devices are also used.
+     */
+    ssize_t
+    block_device_request::execute (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device_request::%s() @%p\n", __func__, this);
+#endif
+
+      if (op_ == operation::read)
+        {
+          return device_->read_block (buf_, blknum_, nblocks_);
+        }
+      else if (op_ == operation::write)
+        {
+          return device_->write_block (buf_, blknum_, nblocks_);
+        }
+
+      errno = EINVAL;
+      return -1;
+    }
+
+    void
+    block_device_request::complete (ssize_t result, int error)
+    {
+#if defined(OS_TRACE_POSIX_IO_BLOCK_DEVICE)
+      trace::printf ("block_device_request::%s(%d, %d) @%p\n", __func__,
+                     result, error, this);
+#endif
+
+      result_ = result;
+      error_ = error;
+
+      if (callback_ != nullptr)
+        {
+          callback_ (*this, args_);
+        }
+
+      // Publish the completion last, the request may be destroyed
+      // or reused as soon as a waiting thread sees it.
+        {
+          rtos::interrupts::critical_section ics;
+
+          done_ = true;
+          sem_.post ();
+        }
+    }
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
@@ -36,6 +36,7 @@
 #include <cmsis-plus/posix-io/file.h>
 #include <cmsis-plus/posix-io/file-system.h>
 #include <cmsis-plus/posix-io/directory.h>
+#include <cmsis-plus/posix-io/pipe.h>
 #include <cmsis-plus/posix-io/socket.h>
 #include <cmsis-plus/posix-io/net-stack.h>
 
@@ -45,6 +46,8 @@
 
 #include <cstdarg>
 #include <cerrno>
+#include <climits>
+#include <new>
 
 // ----------------------------------------------------------------------------
 
@@ -166,6 +169,105 @@ __posix_writev (int fildes, const struct iovec* iov, int iovcnt)
   return io->writev (iov, iovcnt);
 }
 
+ssize_t
+__posix_readv (int fildes, const struct iovec* iov, int iovcnt)
+{
+  auto* const io = posix::file_descriptors_manager::io (fildes);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return io->readv (iov, iovcnt);
+}
+
+ssize_t
+__posix_pread (int fildes, void* buf, size_t nbyte, off_t offset)
+{
+  auto* const io = posix::file_descriptors_manager::io (fildes);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return io->pread (buf, nbyte, offset);
+}
+
+ssize_t
+__posix_pwrite (int fildes, const void* buf, size_t nbyte, off_t offset)
+{
+  auto* const io = posix::file_descriptors_manager::io (fildes);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return io->pwrite (buf, nbyte, offset);
+}
+
+ssize_t
+__posix_preadv (int fildes, const struct iovec* iov, int iovcnt,
+                off_t offset)
+{
+  auto* const io = posix::file_descriptors_manager::io (fildes);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return io->preadv (iov, iovcnt, offset);
+}
+
+ssize_t
+__posix_pwritev (int fildes, const struct iovec* iov, int iovcnt,
+                 off_t offset)
+{
+  auto* const io = posix::file_descriptors_manager::io (fildes);
+  if (io == nullptr)
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return io->pwritev (iov, iovcnt, offset);
+}
+
+ssize_t
+__posix_sendfile (int out_fd, int in_fd, off_t* offset, size_t count)
+{
+  auto* const out = posix::file_descriptors_manager::io (out_fd);
+  auto* const in = posix::file_descriptors_manager::io (in_fd);
+  if ((out == nullptr) || (in == nullptr))
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return out->sendfile (*in, offset, count);
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+/**
+ * @details
+ * Any pair of descriptors is accepted, neither needs to be a pipe;
+ * the flags are ignored.
+ */
+ssize_t
+__posix_splice (int fd_in, off_t* off_in, int fd_out, off_t* off_out,
+                size_t len, unsigned int flags)
+{
+  auto* const in = posix::file_descriptors_manager::io (fd_in);
+  auto* const out = posix::file_descriptors_manager::io (fd_out);
+  if ((out == nullptr) || (in == nullptr))
+    {
+      errno = EBADF;
+      return -1;
+    }
+  return out->splice (*in, off_in, off_out, len);
+}
+
+#pragma GCC diagnostic pop
+
 int
 __posix_ioctl (int fildes, int request, ...)
 {
@@ -177,7 +279,9 @@ __posix_ioctl (int fildes, int request, ...)
     }
 
   // Works only on STREAMS (CherDevices, in this implementation)
-  if ((io->get_type () & posix::io::type::char_device) == 0)
+  // and on block devices.
+  if ((io->get_type ()
+      & (posix::io::type::char_device | posix::io::type::block_device)) == 0)
     {
       errno = ENOTTY; // Not a stream.
       return -1;
@@ -185,7 +289,7 @@ __posix_ioctl (int fildes, int request, ...)
 
   va_list args;
   va_start(args, request);
-  int ret = (static_cast<posix::char_device*> (io))->vioctl (request, args);
+  int ret = (static_cast<posix::device*> (io))->vioctl (request, args);
   va_end(args);
 
   return ret;
@@ -415,6 +519,12 @@ __posix_fsync (int fildes)
       return -1;
     }
 
+  // Character devices can only push their buffered data.
+  if ((io->get_type () & posix::io::type::char_device) != 0)
+    {
+      return io->flush ();
+    }
+
   // Works only on files (Does not work on sockets, pipes or FIFOs...)
   if ((io->get_type () & posix::io::type::file) == 0)
     {
@@ -425,6 +535,209 @@ __posix_fsync (int fildes)
   return (static_cast<posix::file*> (io))->fsync ();
 }
 
+// ----------------------------------------------------------------------------
+
+/**
+ * @details
+ * The pipe is created in the first pool constructed.
+ */
+int
+__posix_pipe (int fildes[2])
+{
+  if (fildes == nullptr)
+    {
+      errno = EFAULT;
+      return -1;
+    }
+
+  auto* const pool = posix::pipe_pool::default_pool ();
+  if (pool == nullptr)
+    {
+      errno = ENFILE; // No pipes configured.
+      return -1;
+    }
+
+  posix::pipe* ends[2];
+  if (pool->create (ends) < 0)
+    {
+      return -1;
+    }
+
+  fildes[0] = ends[0]->file_descriptor ();
+  fildes[1] = ends[1]->file_descriptor ();
+  return 0;
+}
+
+int
+__posix_poll (struct pollfd fds[], nfds_t nfds, int timeout)
+{
+  return posix::poll (fds, nfds, timeout);
+}
+
+/**
+ * @details
+ * Implemented on top of `poll()`; the descriptors in the three
+ * sets are translated to POLLIN, POLLOUT and POLLPRI events,
+ * and the timeout is rounded up to milliseconds.
+ */
+int
+__posix_select (int nfds, fd_set* readfds, fd_set* writefds, fd_set* errorfds,
+                struct timeval* timeout)
+{
+  if (nfds < 0 || nfds > FD_SETSIZE)
+    {
+      errno = EINVAL;
+      return -1;
+    }
+
+  int ms = -1; // Wait forever.
+  if (timeout != nullptr)
+    {
+      if (timeout->tv_sec < 0 || timeout->tv_usec < 0
+          || timeout->tv_usec >= 1000000)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (timeout->tv_sec >= INT_MAX / 1000 - 1)
+        {
+          ms = INT_MAX;
+        }
+      else
+        {
+          ms = static_cast<int> (timeout->tv_sec * 1000
+              + (timeout->tv_usec + 999) / 1000);
+        }
+    }
+
+  // Count the descriptors of interest; all must be valid.
+  std::size_t count = 0;
+  for (int fd = 0; fd < nfds; ++fd)
+    {
+      if ((readfds != nullptr && FD_ISSET(fd, readfds))
+          || (writefds != nullptr && FD_ISSET(fd, writefds))
+          || (errorfds != nullptr && FD_ISSET(fd, errorfds)))
+        {
+          if (posix::file_descriptors_manager::io (fd) == nullptr)
+            {
+              errno = EBADF;
+              return -1;
+            }
+          ++count;
+        }
+    }
+
+  struct pollfd local_fds[OS_INTEGER_POSIX_IO_POLL_LOCAL_FDS];
+  struct pollfd* fds = local_fds;
+  if (count > OS_INTEGER_POSIX_IO_POLL_LOCAL_FDS)
+    {
+      fds = new (std::nothrow) struct pollfd[count];
+      if (fds == nullptr)
+        {
+          errno = ENOMEM;
+          return -1;
+        }
+    }
+
+  std::size_t n = 0;
+  for (int fd = 0; fd < nfds; ++fd)
+    {
+      short events = 0;
+      if (readfds != nullptr && FD_ISSET(fd, readfds))
+        {
+          events |= POLLIN;
+        }
+      if (writefds != nullptr && FD_ISSET(fd, writefds))
+        {
+          events |= POLLOUT;
+        }
+      if (errorfds != nullptr && FD_ISSET(fd, errorfds))
+        {
+          events |= POLLPRI;
+        }
+      if (events != 0)
+        {
+          fds[n].fd = fd;
+          fds[n].events = events;
+          fds[n].revents = 0;
+          ++n;
+        }
+    }
+
+  int ret = posix::poll (fds, count, ms);
+  if (ret > 0)
+    {
+      // Return only the ready descriptors in the sets.
+      ret = 0;
+      for (std::size_t i = 0; i < count; ++i)
+        {
+          int const fd = fds[i].fd;
+          short const revents = fds[i].revents;
+          if (fds[i].events & POLLIN)
+            {
+              if (revents & (POLLIN | POLLHUP | POLLERR))
+                {
+                  ++ret;
+                }
+              else
+                {
+                  FD_CLR(fd, readfds);
+                }
+            }
+          if (fds[i].events & POLLOUT)
+            {
+              if (revents & (POLLOUT | POLLERR))
+                {
+                  ++ret;
+                }
+              else
+                {
+                  FD_CLR(fd, writefds);
+                }
+            }
+          if (fds[i].events & POLLPRI)
+            {
+              if (revents & POLLPRI)
+                {
+                  ++ret;
+                }
+              else
+                {
+                  FD_CLR(fd, errorfds);
+                }
+            }
+        }
+    }
+  else if (ret == 0)
+    {
+      // Timeout, no descriptor is ready.
+      for (std::size_t i = 0; i < count; ++i)
+        {
+          int const fd = fds[i].fd;
+          if (readfds != nullptr)
+            {
+              FD_CLR(fd, readfds);
+            }
+          if (writefds != nullptr)
+            {
+              FD_CLR(fd, writefds);
+            }
+          if (errorfds != nullptr)
+            {
+              FD_CLR(fd, errorfds);
+            }
+        }
+    }
+
+  if (fds != local_fds)
+    {
+      delete[] fds;
+    }
+
+  return ret;
+}
+
 // ----------------------------------------------------------------------------
 // ----- POSIX file functions -----
 
@@ -555,7 +868,7 @@ __posix_closedir (DIR* dirp)
 // The other are socket specific functions.
 
 // In addition, the following IO functions should work on sockets:
-// close(), read(), write(), writev(), ioctl(), fcntl(), select().
+// close(), read(), write(), writev(), ioctl(), fcntl(), select(), poll().
 
 int
 __posix_socket (int domain, int type, int protocol)
@@ -820,14 +1133,6 @@ __posix_gettimeofday (struct timeval* ptimeval, void* ptimezone)
   return 0;
 }
 
-int
-__posix_select (int nfds, fd_set* readfds, fd_set* writefds, fd_set* errorfds,
-                struct timeval* timeout)
-{
-  errno = ENOSYS; // Not implemented
-  return -1;
-}
-
 clock_t
 __posix_times (struct tms* buf)
 {
@@ -0,0 +1,392 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/dentry-cache.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <cstring>
+#include <cassert>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    /**
+     * @details
+     * All entries and the hash table are allocated here.
+     */
+    dentry_cache::dentry_cache (std::size_t nentries, bool case_insensitive) :
+        num_entries_ (nentries), //
+        lru_list_ (true), //
+        free_list_ (true), //
+        case_insensitive_ (case_insensitive)
+    {
+#if defined(OS_TRACE_POSIX_IO_DENTRY_CACHE)
+      trace::printf ("dentry_cache::%s(%u)=@%p\n", __func__, nentries, this);
+#endif
+
+      assert(num_entries_ > 0);
+
+      // Twice the number of entries, rounded up to a power of 2.
+      std::size_t hash_size = 1;
+      while (hash_size < 2 * num_entries_)
+        {
+          hash_size <<= 1;
+        }
+      hash_mask_ = hash_size - 1;
+
+      hash_table_ = new entry*[hash_size];
+      for (std::size_t i = 0; i < hash_size; ++i)
+        {
+          hash_table_[i] = nullptr;
+        }
+
+      entries_ = new entry[num_entries_];
+      for (std::size_t i = 0; i < num_entries_; ++i)
+        {
+          free_list_.link (entries_[i]);
+        }
+    }
+
+    dentry_cache::~dentry_cache ()
+    {
+#if defined(OS_TRACE_POSIX_IO_DENTRY_CACHE)
+      trace::printf ("dentry_cache::%s() @%p\n", __func__, this);
+#endif
+
+      delete[] entries_;
+      delete[] hash_table_;
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * If found, the entry is also moved to the most recently
+     * used end of the list.
+     */
+    dentry_cache::entry*
+    dentry_cache::lookup (const char* path)
+    {
+      std::size_t len;
+      if (!canonical (path, &len) || len > OS_INTEGER_POSIX_IO_DENTRY_PATH_MAX)
+        {
+          return nullptr;
+        }
+
+      entry* e = find (path, hash (path, len), len);
+      if (e == nullptr)
+        {
+          ++statistics_.misses;
+          return nullptr;
+        }
+
+      ++statistics_.hits;
+      e->lru_links_.unlink ();
+      lru_list_.link (*e);
+
+#if defined(OS_TRACE_POSIX_IO_DENTRY_CACHE)
+      trace::printf ("dentry_cache::%s(\"%s\") %s\n", __func__, path,
+                     e->negative ? "negative" : "positive");
+#endif
+
+      return e;
+    }
+
+    dentry_cache::entry*
+    dentry_cache::insert (const char* path, bool negative, mode_t mode,
+                          uintptr_t cookie)
+    {
+      std::size_t len;
+      if (!canonical (path, &len) || len > OS_INTEGER_POSIX_IO_DENTRY_PATH_MAX)
+        {
+          return nullptr;
+        }
+
+#if defined(OS_TRACE_POSIX_IO_DENTRY_CACHE)
+      trace::printf ("dentry_cache::%s(\"%s\", %s)\n", __func__, path,
+                     negative ? "negative" : "positive");
+#endif
+
+      std::size_t h = hash (path, len);
+      entry* e = find (path, h, len);
+      if (e != nullptr)
+        {
+          e->lru_links_.unlink ();
+        }
+      else
+        {
+          if (!free_list_.empty ())
+            {
+              e = free_list_.unlink_head ();
+            }
+          else
+            {
+              e = lru_list_.unlink_head ();
+              hash_unlink (e);
+              ++statistics_.evictions;
+            }
+
+          std::memcpy (e->path_, path, len);
+          e->path_[len] = '\0';
+          e->length_ = len;
+          e->hash_ = h;
+          e->cookie = 0;
+
+          std::size_t b = h & hash_mask_;
+          e->hash_next_ = hash_table_[b];
+          hash_table_[b] = e;
+        }
+
+      e->negative = negative;
+      e->mode = negative ? 0 : (mode & S_IFMT);
+      if (negative)
+        {
+          e->cookie = 0;
+        }
+      else if (cookie != 0)
+        {
+          e->cookie = cookie;
+        }
+      lru_list_.link (*e);
+
+      return e;
+    }
+
+    /**
+     * @details
+     * The entries below the path are found by scanning all
+     * entries, which is cheap for the small caches used on
+     * embedded systems and avoids keeping parent links.
+     */
+    void
+    dentry_cache::invalidate (const char* path)
+    {
+#if defined(OS_TRACE_POSIX_IO_DENTRY_CACHE)
+      trace::printf ("dentry_cache::%s(\"%s\")\n", __func__, path);
+#endif
+
+      std::size_t len;
+      if (!canonical (path, &len) || len == 1)
+        {
+          // Another spelling of a cached path, or the root.
+          clear ();
+          return;
+        }
+
+      if (len > OS_INTEGER_POSIX_IO_DENTRY_PATH_MAX)
+        {
+          // Neither the path, nor the paths below it, are cached.
+          return;
+        }
+
+      for (std::size_t i = 0; i < num_entries_; ++i)
+        {
+          entry* e = &entries_[i];
+          if (e->length_ < len)
+            {
+              continue;
+            }
+          if (e->length_ > len && e->path_[len] != '/')
+            {
+              continue;
+            }
+          if (matches (e->path_, path, len))
+            {
+              release (e);
+              ++statistics_.invalidations;
+            }
+        }
+    }
+
+    void
+    dentry_cache::clear (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_DENTRY_CACHE)
+      trace::printf ("dentry_cache::%s() @%p\n", __func__, this);
+#endif
+
+      while (!lru_list_.empty ())
+        {
+          release (lru_list_.unlink_head ());
+        }
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * Canonical paths start with `/`, have no empty, `.` or
+     * `..` components and no trailing `/`, except the root itself.
+     */
+    bool
+    dentry_cache::canonical (const char* path, std::size_t* length) const
+    {
+      if (path == nullptr || path[0] != '/')
+        {
+          return false;
+        }
+
+      const char* p = path + 1;
+      while (*p != '\0')
+        {
+          const char* c = p;
+          while (*p != '\0' && *p != '/')
+            {
+              ++p;
+            }
+
+          std::size_t n = static_cast<std::size_t> (p - c);
+          if (n == 0)
+            {
+              // Empty component, like in `//` or a trailing `/`.
+              return false;
+            }
+          if (c[0] == '.' && (n == 1 || (n == 2 && c[1] == '.')))
+            {
+              return false;
+            }
+
+          if (*p == '/')
+            {
+              ++p;
+              if (*p == '\0')
+                {
+                  return false;
+                }
+            }
+        }
+
+      *length = static_cast<std::size_t> (p - path);
+      return true;
+    }
+
+    std::size_t
+    dentry_cache::hash (const char* path, std::size_t len) const
+    {
+      if (!case_insensitive_)
+        {
+          return hash_name (path, len);
+        }
+
+      // Same as hash_name(), with the ASCII letters folded.
+      uint32_t h = 2166136261u;
+      for (std::size_t i = 0; i < len; ++i)
+        {
+          uint8_t ch = static_cast<uint8_t> (path[i]);
+          if (ch >= 'A' && ch <= 'Z')
+            {
+              ch = static_cast<uint8_t> (ch - 'A' + 'a');
+            }
+          h ^= ch;
+          h *= 16777619u;
+        }
+      return h;
+    }
+
+    bool
+    dentry_cache::matches (const char* path1, const char* path2,
+                           std::size_t len) const
+    {
+      if (!case_insensitive_)
+        {
+          return std::memcmp (path1, path2, len) == 0;
+        }
+
+      for (std::size_t i = 0; i < len; ++i)
+        {
+          char ch1 = path1[i];
+          char ch2 = path2[i];
+          if (ch1 >= 'A' && ch1 <= 'Z')
+            {
+              ch1 = static_cast<char> (ch1 - 'A' + 'a');
+            }
+          if (ch2 >= 'A' && ch2 <= 'Z')
+            {
+              ch2 = static_cast<char> (ch2 - 'A' + 'a');
+            }
+          if (ch1 != ch2)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+
+    dentry_cache::entry*
+    dentry_cache::find (const char* path, std::size_t h, std::size_t len)
+    {
+      entry* e = hash_table_[h & hash_mask_];
+      while (e != nullptr)
+        {
+          if (e->hash_ == h && e->length_ == len
+              && matches (e->path_, path, len))
+            {
+              return e;
+            }
+          e = e->hash_next_;
+        }
+      return nullptr;
+    }
+
+    void
+    dentry_cache::hash_unlink (entry* e)
+    {
+      entry** pp = &hash_table_[e->hash_ & hash_mask_];
+      while (*pp != nullptr)
+        {
+          if (*pp == e)
+            {
+              *pp = e->hash_next_;
+              break;
+            }
+          pp = &((*pp)->hash_next_);
+        }
+      e->hash_next_ = nullptr;
+    }
+
+    void
+    dentry_cache::release (entry* e)
+    {
+      hash_unlink (e);
+      e->lru_links_.unlink ();
+      e->length_ = 0;
+      e->negative = false;
+      e->cookie = 0;
+      free_list_.link (*e);
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -59,6 +59,7 @@ namespace os
 #endif
 
       registry_links_.unlink ();
+      hash_links_.unlink ();
 
       name_ = nullptr;
     }
@@ -129,6 +130,12 @@ namespace os
         {
           ret = io::close ();
         }
+      else
+        {
+          // Other users keep it open, but the buffered data is
+          // expected to reach the device after each close().
+          ret = flush_buffer ();
+        }
 
       if (impl ().open_count_ > 0)
         {
@@ -166,6 +173,31 @@ namespace os
 
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      switch (static_cast<unsigned int> (request))
+        {
+        case IOSTATGET:
+          {
+            io_statistics* st = va_arg(args, io_statistics*);
+            if (st == nullptr)
+              {
+                errno = EINVAL;
+                return -1;
+              }
+
+            *st = statistics ();
+            return 0;
+          }
+
+        case IOSTATCLR:
+          statistics ().clear ();
+          return 0;
+
+        default:
+          break;
+        }
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       return impl ().do_vioctl (request, args);
     }
 
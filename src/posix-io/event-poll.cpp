@@ -0,0 +1,361 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/event-poll.h>
+#include <cmsis-plus/posix-io/file-descriptors-manager.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <cerrno>
+#include <mutex>
+#include <new>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    event_poll::event_poll (const char* name) :
+        interests_ (true), //
+        ready_ (true), //
+        mutex_
+          { name }, //
+        sem_
+          { name, 0 }
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      trace::printf ("event_poll::%s()=@%p\n", __func__, this);
+#endif
+    }
+
+    event_poll::~event_poll ()
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      trace::printf ("event_poll::%s() @%p\n", __func__, this);
+#endif
+
+      while (!interests_.empty ())
+        {
+          delete interests_.unlink_head ();
+        }
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * The descriptor is initially placed in the ready list, so
+     * the next `wait()` reports its current state, even if it
+     * became ready before being registered.
+     */
+    int
+    event_poll::add (int fildes, uint32_t events, void* data)
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      trace::printf ("event_poll::%s(%d, 0x%X) @%p\n", __func__, fildes,
+                     events, this);
+#endif
+
+      auto* const io = file_descriptors_manager::io (fildes);
+      if (io == nullptr)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      std::lock_guard<rtos::mutex> lock
+        { mutex_ };
+
+      if (find (fildes) != nullptr)
+        {
+          errno = EEXIST;
+          return -1;
+        }
+
+      auto* const in = new (std::nothrow) interest (*this, fildes, io);
+      if (in == nullptr)
+        {
+          errno = ENOMEM;
+          return -1;
+        }
+      in->events_ = events;
+      in->data_ = data;
+
+      interests_.link (*in);
+      io->impl ().link_waiter (*in);
+
+      make_ready (*in);
+
+      return 0;
+    }
+
+    int
+    event_poll::modify (int fildes, uint32_t events, void* data)
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      trace::printf ("event_poll::%s(%d, 0x%X) @%p\n", __func__, fildes,
+                     events, this);
+#endif
+
+      std::lock_guard<rtos::mutex> lock
+        { mutex_ };
+
+      auto* const in = find (fildes);
+      if (in == nullptr)
+        {
+          errno = ENOENT;
+          return -1;
+        }
+
+      in->events_ = events;
+      in->data_ = data;
+
+      // Check again with the new events.
+      make_ready (*in);
+
+      return 0;
+    }
+
+    int
+    event_poll::remove (int fildes)
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      trace::printf ("event_poll::%s(%d) @%p\n", __func__, fildes, this);
+#endif
+
+      std::lock_guard<rtos::mutex> lock
+        { mutex_ };
+
+      auto* const in = find (fildes);
+      if (in == nullptr)
+        {
+          errno = ENOENT;
+          return -1;
+        }
+
+      delete in;
+
+      return 0;
+    }
+
+    /**
+     * @details
+     * Only the descriptors in the ready list are checked.
+     * Level-triggered descriptors still ready are put back
+     * at the end of the list, to be checked by the next
+     * `wait()`, while the others are removed, until the next
+     * notification.
+     *
+     * Descriptors closed while registered are reported
+     * as POLLNVAL and should be removed.
+     */
+    int
+    event_poll::wait (event* events, std::size_t maxevents, int timeout)
+    {
+#if defined(OS_TRACE_POSIX_IO_EVENT_POLL)
+      trace::printf ("event_poll::%s(%p, %u, %d) @%p\n", __func__, events,
+                     maxevents, timeout, this);
+#endif
+
+      if (events == nullptr || maxevents == 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      rtos::clock::duration_t ticks = 0;
+      if (timeout > 0)
+        {
+          ticks = rtos::clock_systick::ticks_cast (
+              static_cast<uint64_t> (timeout) * 1000);
+        }
+      rtos::clock::timestamp_t const begin = rtos::sysclock.now ();
+
+      errno = 0;
+      std::size_t count = 0;
+      while (true)
+        {
+            {
+              // Keep the interests while they are checked; other
+              // threads may change them in the mean time.
+              std::lock_guard<rtos::mutex> lock
+                { mutex_ };
+
+              ready_list again
+                { true };
+
+              while (count < maxevents)
+                {
+                  interest* in;
+                    {
+                      rtos::interrupts::critical_section ics;
+
+                      if (ready_.empty ())
+                        {
+                          break;
+                        }
+                      in = ready_.unlink_head ();
+                    }
+
+                  int const mask = static_cast<int> (in->events_
+                      & ~edge_triggered);
+
+                  int revents;
+                  if (file_descriptors_manager::io (in->fildes_) != in->io_)
+                    {
+                      revents = POLLNVAL; // Closed or reused.
+                    }
+                  else
+                    {
+                      revents = in->io_->poll (mask);
+                    }
+
+                  if (revents != 0)
+                    {
+                      events[count].events = static_cast<uint32_t> (revents);
+                      events[count].data = in->data_;
+                      ++count;
+
+                      if ((in->events_ & edge_triggered) == 0
+                          && revents != POLLNVAL)
+                        {
+                          again.link (*in);
+                        }
+                    }
+                }
+
+                {
+                  rtos::interrupts::critical_section ics;
+
+                  // Put the level-triggered descriptors back, to be
+                  // checked again by the next wait().
+                  while (!again.empty ())
+                    {
+                      ready_.link (*again.unlink_head ());
+                    }
+                }
+            }
+
+          if (count > 0 || timeout == 0)
+            {
+              break;
+            }
+
+          if (timeout < 0)
+            {
+              sem_.wait ();
+              continue;
+            }
+
+          rtos::clock::duration_t const elapsed =
+              static_cast<rtos::clock::duration_t> (rtos::sysclock.now ()
+                  - begin);
+          if (elapsed >= ticks)
+            {
+              break; // Timeout.
+            }
+          sem_.timed_wait (ticks - elapsed);
+        }
+
+      return static_cast<int> (count);
+    }
+
+    // ------------------------------------------------------------------------
+
+    event_poll::interest*
+    event_poll::find (int fildes)
+    {
+      for (auto&& in : interests_)
+        {
+          if (in.fildes_ == fildes)
+            {
+              return &in;
+            }
+        }
+      return nullptr;
+    }
+
+    void
+    event_poll::make_ready (interest& in)
+    {
+        {
+          rtos::interrupts::critical_section ics;
+
+          if (in.ready_links_.unlinked ())
+            {
+              ready_.link (in);
+            }
+        }
+      sem_.post ();
+    }
+
+    // ========================================================================
+
+    event_poll::interest::interest (event_poll& owner, int fildes,
+                                    class io* io) :
+        owner_ (owner), //
+        io_ (io), //
+        fildes_ (fildes)
+    {
+      ;
+    }
+
+    event_poll::interest::~interest ()
+    {
+      // Unlink from the object in the same critical section, so
+      // a notification cannot link the interest again.
+      rtos::interrupts::critical_section ics;
+
+      links_.unlink ();
+      ready_links_.unlink ();
+      interest_links_.unlink ();
+    }
+
+    /**
+     * @details
+     * Called with interrupts disabled, by `notify_readiness()`;
+     * move the descriptor to the ready list, if not already there,
+     * and wake up the waiting thread.
+     */
+    void
+    event_poll::interest::notify (void)
+    {
+      if (ready_links_.unlinked ())
+        {
+          owner_.ready_.link (*this);
+        }
+      owner_.sem_.post ();
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -51,6 +51,11 @@ namespace os
 
     io** file_descriptors_manager::descriptors_array__;
 
+    file_descriptors_manager::bitmap_word_t*
+    file_descriptors_manager::free_bitmap__;
+
+    std::size_t file_descriptors_manager::used__;
+
     /**
      * @endcond
      */
@@ -70,6 +75,22 @@ namespace os
         {
           descriptors_array__[i] = nullptr;
         }
+
+      // All descriptors are free, except the reserved ones,
+      // which are only assigned explicitly.
+      std::size_t const words = (size__ + bitmap_word_bits__ - 1)
+          / bitmap_word_bits__;
+      free_bitmap__ = new bitmap_word_t[words];
+      for (std::size_t i = 0; i < words; ++i)
+        {
+          free_bitmap__[i] = 0;
+        }
+      for (std::size_t i = reserved__; i < size__; ++i)
+        {
+          free_bitmap__[i / bitmap_word_bits__] |=
+              (static_cast<bitmap_word_t> (1) << (i % bitmap_word_bits__));
+        }
+      used__ = 0;
     }
 
     file_descriptors_manager::~file_descriptors_manager ()
@@ -77,7 +98,9 @@ namespace os
       trace::printf ("file_descriptors_manager::%s(%) @%p\n", __func__, this);
 
       delete[] descriptors_array__;
+      delete[] free_bitmap__;
       size__ = 0;
+      used__ = 0;
     }
 
     // ------------------------------------------------------------------------
@@ -118,11 +141,19 @@ namespace os
           return -1;
         }
 
-      for (std::size_t i = reserved__; i < size__; ++i)
+      // Find the first word with free descriptors, and in it
+      // the lowest free descriptor.
+      std::size_t const words = (size__ + bitmap_word_bits__ - 1)
+          / bitmap_word_bits__;
+      for (std::size_t w = 0; w < words; ++w)
         {
-          if (descriptors_array__[i] == nullptr)
+          if (free_bitmap__[w] != 0)
             {
+              std::size_t const i = w * bitmap_word_bits__
+                  + static_cast<std::size_t> (__builtin_ctz (free_bitmap__[w]));
+
               descriptors_array__[i] = io;
+              mark_used (i);
               io->file_descriptor (static_cast<int> (i));
 #if defined(OS_TRACE_POSIX_IO_FILE_DESCRIPTORS_MANAGER)
               trace::printf ("file_descriptors_manager::%s(%p) fd=%d\n",
@@ -153,6 +184,10 @@ namespace os
           return -1;
         }
 
+      if (descriptors_array__[fildes] == nullptr)
+        {
+          mark_used (static_cast<std::size_t> (fildes));
+        }
       descriptors_array__[fildes] = io;
       io->file_descriptor (fildes);
       return fildes;
@@ -171,8 +206,15 @@ namespace os
           return -1;
         }
 
+      if (descriptors_array__[fildes] == nullptr)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
       descriptors_array__[fildes]->clear_file_descriptor ();
       descriptors_array__[fildes] = nullptr;
+      mark_free (static_cast<std::size_t> (fildes));
       return 0;
     }
 
@@ -188,19 +230,34 @@ namespace os
       return reinterpret_cast<class socket*> (io);
     }
 
-    size_t
-    file_descriptors_manager::used (void)
+    // ------------------------------------------------------------------------
+
+    // The reserved descriptors are not in the bitmap and not counted.
+
+    void
+    file_descriptors_manager::mark_used (std::size_t fildes)
+    {
+      if (fildes >= reserved__)
+        {
+          free_bitmap__[fildes / bitmap_word_bits__] &=
+              ~(static_cast<bitmap_word_t> (1)
+                  << (fildes % bitmap_word_bits__));
+          ++used__;
+        }
+    }
+
+    void
+    file_descriptors_manager::mark_free (std::size_t fildes)
     {
-      std::size_t count = reserved__;
-      for (std::size_t i = reserved__; i < file_descriptors_manager::size ();
-          ++i)
+      if (fildes >= reserved__)
         {
-          if (descriptors_array__[i] != nullptr)
+          free_bitmap__[fildes / bitmap_word_bits__] |=
+              (static_cast<bitmap_word_t> (1) << (fildes % bitmap_word_bits__));
+          if (used__ > 0)
             {
-              ++count;
+              --used__;
             }
         }
-      return count;
     }
 
   // ========================================================================
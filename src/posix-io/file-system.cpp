@@ -32,6 +32,7 @@
 #include <cerrno>
 #include <cassert>
 #include <cstring>
+#include <fcntl.h>
 
 // ----------------------------------------------------------------------------
 
@@ -53,6 +54,9 @@ namespace os
 
     file_system::mounted_list file_system::mounted_list__;
 
+    file_system::mounted_hash_list file_system::mounted_hash__[
+        OS_INTEGER_POSIX_IO_MOUNT_BUCKETS];
+
 #pragma GCC diagnostic pop
 
     class file_system* file_system::mounted_root__;
@@ -527,7 +531,7 @@ namespace os
 
       if (path != nullptr)
         {
-          for (auto&& fs : mounted_list__)
+          for (auto&& fs : mounted_bucket (path))
             {
               // Validate the device name by checking duplicates.
               if (std::strcmp (path, fs.mounted_path_) == 0)
@@ -565,7 +569,9 @@ namespace os
       else
         {
           mounted_list__.link (*this);
+          mounted_bucket (path).link (*this);
           mounted_path_ = path;
+          mounted_path_length_ = std::strlen (path);
         }
 
       return 0;
@@ -584,7 +590,14 @@ namespace os
 #endif
 
       mount_manager_links_.unlink ();
+      mount_hash_links_.unlink ();
       mounted_path_ = nullptr;
+      mounted_path_length_ = 0;
+
+      if (impl ().dentries_ != nullptr)
+        {
+          impl ().dentries_->clear ();
+        }
 
       if (this == mounted_root__)
         {
@@ -597,7 +610,7 @@ namespace os
           mounted_root__ = nullptr;
         }
 
-      if (!device ().is_opened ())
+      if (!impl ().device_ready ())
         {
           errno = EBADF; // Not opened.
           return -1;
@@ -608,37 +621,53 @@ namespace os
       return ret;
     }
 
+    /**
+     * @details
+     * Only the mount points with the same first path component
+     * are checked, and the longest matching one is used, so
+     * nested mount points work regardless of the order they
+     * were mounted.
+     */
     file_system*
     file_system::identify_mounted (const char** path1, const char** path2)
     {
       assert(path1 != nullptr);
       assert(*path1 != nullptr);
 
-      for (auto&& fs : mounted_list__)
+      file_system* found = nullptr;
+      for (auto&& fs : mounted_bucket (*path1))
         {
-          auto len = std::strlen (fs.mounted_path_);
+          auto len = fs.mounted_path_length_;
 
           // Check if path1 starts with the mounted path.
-          if (std::strncmp (fs.mounted_path_, *path1, len) == 0)
+          if ((found == nullptr || len > found->mounted_path_length_)
+              && std::strncmp (fs.mounted_path_, *path1, len) == 0)
             {
-              // If so, adjust paths to skip over prefix, but keep '/'.
-              *path1 = (*path1 + len - 1);
-              while ((*path1)[1] == '/')
-                {
-                  *path1 = (*path1 + 1);
-                }
+              found = &fs;
+            }
+        }
+
+      if (found != nullptr)
+        {
+          auto len = found->mounted_path_length_;
 
-              if ((path2 != nullptr) && (*path2 != nullptr))
+          // If so, adjust paths to skip over prefix, but keep '/'.
+          *path1 = (*path1 + len - 1);
+          while ((*path1)[1] == '/')
+            {
+              *path1 = (*path1 + 1);
+            }
+
+          if ((path2 != nullptr) && (*path2 != nullptr))
+            {
+              *path2 = (*path2 + len - 1);
+              while ((*path2)[1] == '/')
                 {
-                  *path2 = (*path2 + len - 1);
-                  while ((*path2)[1] == '/')
-                    {
-                      *path2 = (*path2 + 1);
-                    }
+                  *path2 = (*path2 + 1);
                 }
-
-              return &fs;
             }
+
+          return found;
         }
 
       // If root file system defined, return it.
@@ -651,6 +680,32 @@ namespace os
       return nullptr;
     }
 
+    /**
+     * @cond ignore
+     */
+
+    file_system::mounted_hash_list&
+    file_system::mounted_bucket (const char* path)
+    {
+      // Hash the first path component, without the slashes.
+      while (*path == '/')
+        {
+          ++path;
+        }
+      std::size_t len = 0;
+      while (path[len] != '\0' && path[len] != '/')
+        {
+          ++len;
+        }
+
+      return mounted_hash__[hash_name (path, len)
+          % OS_INTEGER_POSIX_IO_MOUNT_BUCKETS];
+    }
+
+    /**
+     * @endcond
+     */
+
     // ------------------------------------------------------------------------
 
     file*
@@ -672,23 +727,44 @@ namespace os
       trace::printf ("file_system::%s(\"%s\", %u)\n", __func__, path, oflag);
 #endif
 
-      if (!device ().is_opened ())
+      if (!impl ().device_ready ())
         {
           errno = EBADF; // Not opened.
           return nullptr;
         }
 
+      if (((oflag & O_CREAT) == 0) && cached_negative (path))
+        {
+          return nullptr;
+        }
+
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       // Execute the file specific implementation code.
       // Allocation is done by the implementation, where
       // the size is known.
       file* fil = impl ().do_vopen (*this, path, oflag, args);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_other (begin, (fil == nullptr) ? -1 : 0);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       if (fil == nullptr)
         {
+          cache_result (path, -1, 0);
           return nullptr;
         }
 
+      if (((oflag & O_CREAT) != 0) && (impl ().dentries_ != nullptr))
+        {
+          // The file may have been created.
+          impl ().dentries_->invalidate (path);
+        }
+
       // If successful, allocate a file descriptor.
       fil->alloc_file_descriptor ();
 
@@ -702,23 +778,39 @@ namespace os
       trace::printf ("file_system::%s(\"%s\")\n", __func__, dirpath);
 #endif
 
-      if (!device ().is_opened ())
+      if (!impl ().device_ready ())
         {
           errno = EBADF; // Not opened.
           return nullptr;
         }
 
+      if (cached_negative (dirpath))
+        {
+          return nullptr;
+        }
+
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       // Execute the dir specific implementation code.
       // Allocation is done by the implementation, where
       // the size is known.
       directory* dir = impl ().do_opendir (*this, dirpath);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_other (begin, (dir == nullptr) ? -1 : 0);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       if (dir == nullptr)
         {
+          cache_result (dirpath, -1, 0);
           return nullptr;
         }
 
+      cache_result (dirpath, 0, S_IFDIR);
       return dir;
     }
 
@@ -743,15 +835,40 @@ namespace os
           return -1;
         }
 
-      if (!device ().is_opened ())
+      if (!impl ().device_ready ())
         {
           errno = EBADF; // Not opened.
           return -1;
         }
 
+      dentry_cache* dc = impl ().dentries_;
+      if (dc != nullptr)
+        {
+          dentry_cache::entry* e = dc->lookup (path);
+          if ((e != nullptr) && !e->negative)
+            {
+              errno = EEXIST;
+              return -1;
+            }
+        }
+
       errno = 0;
 
-      return impl ().do_mkdir (path, mode);
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      int ret = impl ().do_mkdir (path, mode);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_other (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      if ((ret == 0) && (dc != nullptr))
+        {
+          dc->insert (path, false, S_IFDIR);
+        }
+      return ret;
     }
 
     int
@@ -773,15 +890,35 @@ namespace os
           return -1;
         }
 
-      if (!device ().is_opened ())
+      if (!impl ().device_ready ())
         {
           errno = EBADF; // Not opened.
           return -1;
         }
 
+      if (cached_negative (path))
+        {
+          return -1;
+        }
+
       errno = 0;
 
-      return impl ().do_rmdir (path);
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      int ret = impl ().do_rmdir (path);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_other (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      if ((ret == 0) && (impl ().dentries_ != nullptr))
+        {
+          impl ().dentries_->invalidate (path);
+          impl ().dentries_->insert (path, true);
+        }
+      return ret;
     }
 
     void
@@ -791,7 +928,7 @@ namespace os
       trace::printf ("file_system::%s() @%p\n", __func__, this);
 #endif
 
-      if (!device ().is_opened ())
+      if (!impl ().device_ready ())
         {
           errno = EBADF; // Not opened.
           return;
@@ -799,7 +936,15 @@ namespace os
 
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       impl ().do_sync ();
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_other (begin, 0);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
     }
 
     // ------------------------------------------------------------------------
@@ -823,16 +968,31 @@ namespace os
           return -1;
         }
 
-      if (!device ().is_opened ())
+      if (!impl ().device_ready ())
         {
           errno = EBADF; // Not opened.
           return -1;
         }
 
+      if (cached_negative (path))
+        {
+          return -1;
+        }
+
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       // Execute the implementation specific code.
-      return impl ().do_chmod (path, mode);
+      int ret = impl ().do_chmod (path, mode);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_other (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      return ret;
     }
 
     int
@@ -854,16 +1014,32 @@ namespace os
           return -1;
         }
 
-      if (!device ().is_opened ())
+      if (!impl ().device_ready ())
         {
           errno = EBADF; // Not opened.
           return -1;
         }
 
+      if (cached_negative (path))
+        {
+          return -1;
+        }
+
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       // Execute the implementation specific code.
-      return impl ().do_stat (path, buf);
+      int ret = impl ().do_stat (path, buf);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_other (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      cache_result (path, ret, buf->st_mode);
+      return ret;
     }
 
     int
@@ -885,16 +1061,31 @@ namespace os
           return -1;
         }
 
-      if (!device ().is_opened ())
+      if (!impl ().device_ready ())
         {
           errno = EBADF; // Not opened.
           return -1;
         }
 
+      if (cached_negative (path))
+        {
+          return -1;
+        }
+
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       // Execute the implementation specific code.
-      return impl ().do_truncate (path, length);
+      int ret = impl ().do_truncate (path, length);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_other (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      return ret;
     }
 
     int
@@ -917,16 +1108,37 @@ namespace os
           return -1;
         }
 
-      if (!device ().is_opened ())
+      if (!impl ().device_ready ())
         {
           errno = EBADF; // Not opened.
           return -1;
         }
 
+      if (cached_negative (existing))
+        {
+          return -1;
+        }
+
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       // Execute the implementation specific code.
-      return impl ().do_rename (existing, _new);
+      int ret = impl ().do_rename (existing, _new);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_other (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      if ((ret == 0) && (impl ().dentries_ != nullptr))
+        {
+          impl ().dentries_->invalidate (existing);
+          impl ().dentries_->invalidate (_new);
+          impl ().dentries_->insert (existing, true);
+        }
+      return ret;
     }
 
     int
@@ -948,16 +1160,36 @@ namespace os
           return -1;
         }
 
-      if (!device ().is_opened ())
+      if (!impl ().device_ready ())
         {
           errno = EBADF; // Not opened.
           return -1;
         }
 
+      if (cached_negative (path))
+        {
+          return -1;
+        }
+
       errno = 0;
 
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       // Execute the implementation specific code.
-      return impl ().do_unlink (path);
+      int ret = impl ().do_unlink (path);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_other (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      if ((ret == 0) && (impl ().dentries_ != nullptr))
+        {
+          impl ().dentries_->invalidate (path);
+          impl ().dentries_->insert (path, true);
+        }
+      return ret;
     }
 
     // http://pubs.opengroup.org/onlinepubs/9699919799/functions/utime.html
@@ -980,12 +1212,17 @@ namespace os
           return -1;
         }
 
-      if (!device ().is_opened ())
+      if (!impl ().device_ready ())
         {
           errno = EBADF; // Not opened.
           return -1;
         }
 
+      if (cached_negative (path))
+        {
+          return -1;
+        }
+
       errno = 0;
 
       struct utimbuf tmp;
@@ -995,13 +1232,21 @@ namespace os
           // of the file shall be set to the current time.
           tmp.actime = time (nullptr);
           tmp.modtime = tmp.actime;
-          return impl ().do_utime (path, &tmp);
-        }
-      else
-        {
-          // Execute the implementation specific code.
-          return impl ().do_utime (path, times);
+          times = &tmp;
         }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      // Execute the implementation specific code.
+      int ret = impl ().do_utime (path, times);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_other (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      return ret;
     }
 
     // http://pubs.opengroup.org/onlinepubs/9699919799/functions/fstatvfs.html
@@ -1012,7 +1257,7 @@ namespace os
       trace::printf ("file_system::%s(%p)\n", __func__, buf);
 #endif
 
-      if (!device ().is_opened ())
+      if (!impl ().device_ready ())
         {
           errno = EBADF; // Not opened.
           return -1;
@@ -1020,6 +1265,76 @@ namespace os
 
       return impl ().do_statvfs (buf);
     }
+
+    void
+    file_system::dentries (dentry_cache* cache)
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
+      trace::printf ("file_system::%s(%p) @%p\n", __func__, cache, this);
+#endif
+
+      if (cache != nullptr)
+        {
+          cache->clear ();
+        }
+      impl ().dentries_ = cache;
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * If the path is cached as not existing, set `errno` to
+     * `ENOENT` and return `true`.
+     */
+    bool
+    file_system::cached_negative (const char* path)
+    {
+      dentry_cache* dc = impl ().dentries_;
+      if (dc == nullptr)
+        {
+          return false;
+        }
+
+      // Shared metadata reads may run concurrently.
+      rtos::scheduler::critical_section scs;
+
+      dentry_cache::entry* e = dc->lookup (path);
+      if ((e != nullptr) && e->negative)
+        {
+          errno = ENOENT;
+          return true;
+        }
+      return false;
+    }
+
+    /**
+     * @details
+     * Remember the outcome of an implementation lookup; only
+     * `ENOENT` failures are cached, other errors (like `ENOTDIR`
+     * or I/O errors) do not tell if the path exists.
+     */
+    void
+    file_system::cache_result (const char* path, int ret, mode_t mode)
+    {
+      dentry_cache* dc = impl ().dentries_;
+      if (dc == nullptr)
+        {
+          return;
+        }
+
+      // Shared metadata reads may run concurrently.
+      rtos::scheduler::critical_section scs;
+
+      if (ret == 0)
+        {
+          dc->insert (path, false, mode);
+        }
+      else if (errno == ENOENT)
+        {
+          dc->insert (path, true);
+        }
+    }
     // TODO: check if the file system should keep a static current path for
     // relative paths.
 
@@ -1029,7 +1344,14 @@ namespace os
     // ========================================================================
 
     file_system_impl::file_system_impl (block_device& device) :
-        device_ (device)
+        device_ (&device)
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
+      trace::printf ("file_system_impl::%s()=%p\n", __func__, this);
+#endif
+    }
+
+    file_system_impl::file_system_impl (void)
     {
 #if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
       trace::printf ("file_system_impl::%s()=%p\n", __func__, this);
@@ -1043,6 +1365,42 @@ namespace os
 #endif
     }
 
+    bool
+    file_system_impl::device_ready (void) const
+    {
+      return (device_ == nullptr) || device_->is_opened ();
+    }
+
+    /**
+     * @details
+     * Discarding is only an optimisation, devices without
+     * support are not an error, and are not asked again.
+     */
+    int
+    file_system_impl::discard_blocks (block_device::blknum_t blknum,
+                                      std::size_t nblocks)
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE_SYSTEM)
+      trace::printf ("file_system_impl::%s(%u, %u) @%p\n", __func__, blknum,
+                     nblocks, this);
+#endif
+
+      if ((device_ == nullptr) || !discard_supported_)
+        {
+          return 0;
+        }
+
+      int saved_errno = errno;
+      int ret = device_->discard_blocks (blknum, nblocks);
+      if (ret < 0 && errno == ENOSYS)
+        {
+          discard_supported_ = false;
+          errno = saved_errno;
+          return 0;
+        }
+      return ret;
+    }
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
@@ -31,6 +31,7 @@
 #include <cmsis-plus/diag/trace.h>
 
 #include <cerrno>
+#include <cstdio>
 
 // ----------------------------------------------------------------------------
 
@@ -91,6 +92,11 @@ namespace os
 
       errno = 0;
 
+      if (flush_buffer () < 0)
+        {
+          return -1;
+        }
+
       // Execute the implementation specific code.
       return impl ().do_ftruncate (length);
     }
@@ -104,6 +110,11 @@ namespace os
 
       errno = 0;
 
+      if (flush_buffer () < 0)
+        {
+          return -1;
+        }
+
       // Execute the implementation specific code.
       return impl ().do_fsync ();
     }
@@ -129,6 +140,10 @@ namespace os
 #if defined(OS_TRACE_POSIX_IO_FILE)
       trace::printf ("file_impl::%s()=%p\n", __func__, this);
 #endif
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      parent_statistics_ = &fs.statistics ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
     }
 
     file_impl::~file_impl ()
@@ -159,6 +174,112 @@ namespace os
       return -1;
     }
 
+    /**
+     * @details
+     * Most file systems keep a single position per file; emulate
+     * the positional calls by moving it temporarily. For the
+     * result to be atomic, the file must be lockable.
+     */
+    ssize_t
+    file_impl::do_pread (void* buf, std::size_t nbyte, off_t offset)
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE)
+      trace::printf ("file_impl::%s(%p, %u, %d) @%p\n", __func__, buf, nbyte,
+                     offset, this);
+#endif
+
+      off_t saved_offset = offset_;
+      off_t pos = do_lseek (0, SEEK_CUR);
+      if (pos < 0 || do_lseek (offset, SEEK_SET) < 0)
+        {
+          return -1;
+        }
+
+      ssize_t ret = do_read (buf, nbyte);
+
+      int saved_errno = errno;
+      do_lseek (pos, SEEK_SET);
+      offset_ = saved_offset;
+      errno = saved_errno;
+
+      return ret;
+    }
+
+    ssize_t
+    file_impl::do_pwrite (const void* buf, std::size_t nbyte, off_t offset)
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE)
+      trace::printf ("file_impl::%s(%p, %u, %d) @%p\n", __func__, buf, nbyte,
+                     offset, this);
+#endif
+
+      off_t saved_offset = offset_;
+      off_t pos = do_lseek (0, SEEK_CUR);
+      if (pos < 0 || do_lseek (offset, SEEK_SET) < 0)
+        {
+          return -1;
+        }
+
+      ssize_t ret = do_write (buf, nbyte);
+
+      int saved_errno = errno;
+      do_lseek (pos, SEEK_SET);
+      offset_ = saved_offset;
+      errno = saved_errno;
+
+      return ret;
+    }
+
+    ssize_t
+    file_impl::do_preadv (const struct iovec* iov, int iovcnt, off_t offset)
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE)
+      trace::printf ("file_impl::%s(%p, %d, %d) @%p\n", __func__, iov, iovcnt,
+                     offset, this);
+#endif
+
+      off_t saved_offset = offset_;
+      off_t pos = do_lseek (0, SEEK_CUR);
+      if (pos < 0 || do_lseek (offset, SEEK_SET) < 0)
+        {
+          return -1;
+        }
+
+      ssize_t ret = do_readv (iov, iovcnt);
+
+      int saved_errno = errno;
+      do_lseek (pos, SEEK_SET);
+      offset_ = saved_offset;
+      errno = saved_errno;
+
+      return ret;
+    }
+
+    ssize_t
+    file_impl::do_pwritev (const struct iovec* iov, int iovcnt, off_t offset)
+    {
+#if defined(OS_TRACE_POSIX_IO_FILE)
+      trace::printf ("file_impl::%s(%p, %d, %d) @%p\n", __func__, iov, iovcnt,
+                     offset, this);
+#endif
+
+      off_t saved_offset = offset_;
+      off_t pos = do_lseek (0, SEEK_CUR);
+      if (pos < 0 || do_lseek (offset, SEEK_SET) < 0)
+        {
+          return -1;
+        }
+
+      ssize_t ret = do_writev (iov, iovcnt);
+
+      int saved_errno = errno;
+      do_lseek (pos, SEEK_SET);
+      offset_ = saved_offset;
+      errno = saved_errno;
+
+      return ret;
+    }
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
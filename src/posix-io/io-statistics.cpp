@@ -0,0 +1,119 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/io-statistics.h>
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+#include <cmsis-plus/diag/trace.h>
+
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    void
+    io_statistics::counters::clear (void)
+    {
+      ops = 0;
+      errors = 0;
+      bytes = 0;
+      cycles = 0;
+      max_cycles = 0;
+      std::memset (latency, 0, sizeof(latency));
+    }
+
+    void
+    io_statistics::clear (void)
+    {
+      read.clear ();
+      write.clear ();
+      other.clear ();
+    }
+
+    /**
+     * @details
+     * For each kind of operations, the counters are followed
+     * by the non empty histogram buckets, as `2^i:count` pairs.
+     *
+     * The values are truncated to `unsigned long`, to keep
+     * the requirements on `printf()` low.
+     */
+    void
+    io_statistics::report (const char* name) const
+    {
+      const struct
+      {
+        const char* label;
+        const counters* c;
+      } kinds[] =
+        {
+          { "read", &read },
+          { "write", &write },
+          { "other", &other } };
+
+      for (const auto& k : kinds)
+        {
+          const counters& c = *k.c;
+          if (c.ops == 0)
+            {
+              continue;
+            }
+
+          trace::printf (
+              "%s %s: %lu ops, %lu err, %lu bytes, %lu avg, %lu max cycles\n",
+              name, k.label, static_cast<unsigned long> (c.ops),
+              static_cast<unsigned long> (c.errors),
+              static_cast<unsigned long> (c.bytes),
+              static_cast<unsigned long> (c.cycles / c.ops),
+              static_cast<unsigned long> (c.max_cycles));
+
+          for (std::size_t i = 0; i < OS_INTEGER_POSIX_IO_STATISTICS_BUCKETS;
+              ++i)
+            {
+              if (c.latency[i] != 0)
+                {
+                  trace::printf (" 2^%u:%lu", static_cast<unsigned int> (i),
+                                 static_cast<unsigned long> (c.latency[i]));
+                }
+            }
+          trace::printf ("\n");
+        }
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+// ----------------------------------------------------------------------------
@@ -26,18 +26,26 @@
  */
 
 #include <cmsis-plus/posix-io/device.h>
+#include <cmsis-plus/posix/sys/mman.h>
 #include <cmsis-plus/posix/sys/uio.h>
 #include <cmsis-plus/posix-io/device-registry.h>
 #include <cmsis-plus/posix-io/file.h>
 #include <cmsis-plus/posix-io/file-descriptors-manager.h>
 #include <cmsis-plus/posix-io/file-system.h>
 #include <cmsis-plus/posix-io/io.h>
+#include <cmsis-plus/posix/poll.h>
+
+#include <cmsis-plus/rtos/os.h>
 
 #include <cmsis-plus/diag/trace.h>
 
 #include <cassert>
 #include <cerrno>
 #include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <new>
 
 // ----------------------------------------------------------------------------
 
@@ -142,6 +150,132 @@ namespace os
       return io;
     }
 
+    /**
+     * @details
+     * The readiness of all descriptors is checked; if none is
+     * ready, the calling thread waits on a local semaphore, posted
+     * by the `notify_readiness()` of any of the polled objects, then
+     * all descriptors are checked again, until at least one is ready
+     * or the timeout, in milliseconds, expires. A negative timeout
+     * waits forever, zero does not wait at all.
+     *
+     * The waiters are linked before the first check, so
+     * notifications that arrive between the check and the
+     * wait are not lost.
+     *
+     * Negative descriptors are ignored, descriptors
+     * not opened are reported as POLLNVAL.
+     */
+    int
+    poll (struct pollfd* fds, std::size_t nfds, int timeout)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf ("io::%s(%p, %u, %d)\n", __func__, fds, nfds, timeout);
+#endif
+
+      if (fds == nullptr && nfds > 0)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      poll_waiter local_waiters[OS_INTEGER_POSIX_IO_POLL_LOCAL_FDS];
+      poll_waiter* waiters = local_waiters;
+      if (nfds > OS_INTEGER_POSIX_IO_POLL_LOCAL_FDS)
+        {
+          waiters = new (std::nothrow) poll_waiter[nfds];
+          if (waiters == nullptr)
+            {
+              errno = EAGAIN;
+              return -1;
+            }
+        }
+
+      rtos::semaphore_binary sem
+        { "poll", 0 };
+
+      for (std::size_t i = 0; i < nfds; ++i)
+        {
+          auto* const io = file_descriptors_manager::io (fds[i].fd);
+          if (io != nullptr)
+            {
+              waiters[i].semaphore (&sem);
+              io->impl ().link_waiter (waiters[i]);
+            }
+        }
+
+      rtos::clock::duration_t ticks = 0;
+      if (timeout > 0)
+        {
+          ticks = rtos::clock_systick::ticks_cast (
+              static_cast<uint64_t> (timeout) * 1000);
+        }
+      rtos::clock::timestamp_t const begin = rtos::sysclock.now ();
+
+      errno = 0;
+      int count;
+      while (true)
+        {
+          count = 0;
+          for (std::size_t i = 0; i < nfds; ++i)
+            {
+              fds[i].revents = 0;
+              if (fds[i].fd < 0)
+                {
+                  continue;
+                }
+
+              auto* const io = file_descriptors_manager::io (fds[i].fd);
+              int revents = POLLNVAL;
+              if (io != nullptr)
+                {
+                  revents = io->poll (fds[i].events);
+                }
+              if (revents != 0)
+                {
+                  fds[i].revents = static_cast<short> (revents);
+                  ++count;
+                }
+            }
+
+          if (count > 0 || timeout == 0)
+            {
+              break;
+            }
+
+          if (timeout < 0)
+            {
+              sem.wait ();
+              continue;
+            }
+
+          rtos::clock::duration_t const elapsed =
+              static_cast<rtos::clock::duration_t> (rtos::sysclock.now ()
+                  - begin);
+          if (elapsed >= ticks)
+            {
+              break; // Timeout.
+            }
+          sem.timed_wait (ticks - elapsed);
+        }
+
+      // Unlink before the semaphore goes out of scope.
+      for (std::size_t i = 0; i < nfds; ++i)
+        {
+          waiters[i].unlink ();
+        }
+
+      if (waiters != local_waiters)
+        {
+          delete[] waiters;
+        }
+
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf ("io::%s()=%d\n", __func__, count);
+#endif
+      return count;
+    }
+
     // ========================================================================
 
     io::io (io_impl& impl, type t) :
@@ -161,6 +295,8 @@ namespace os
       trace::printf ("io::%s() @%p\n", __func__, this);
 #endif
 
+      free_buffer ();
+
       file_descriptor_ = no_file_descriptor;
     }
 
@@ -181,8 +317,14 @@ namespace os
 
       errno = 0;
 
+      int ret = flush_buffer ();
+      free_buffer ();
+
       // Execute the implementation specific code.
-      int ret = impl ().do_close ();
+      if (impl ().do_close () < 0)
+        {
+          ret = -1;
+        }
 
       // Remove this IO from the file descriptors registry.
       file_descriptors_manager::deallocate (file_descriptor_);
@@ -215,6 +357,62 @@ namespace os
       return this;
     }
 
+    /**
+     * @details
+     * Called with the object locked; the buffered data is passed
+     * to the implementation, and the data not written, if any,
+     * is kept.
+     */
+    int
+    io::flush_buffer (void)
+    {
+      if ((wbuf_ == nullptr) || (wbuf_->count == 0))
+        {
+          return 0;
+        }
+
+      uint8_t* p = wbuf_->data ();
+      std::size_t done = 0;
+      while (done < wbuf_->count)
+        {
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+          rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+          ssize_t ret = impl ().do_write (p + done, wbuf_->count - done);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+          impl ().account_write (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+          if (ret <= 0)
+            {
+              if (ret == 0)
+                {
+                  errno = EIO;
+                }
+              std::memmove (p, p + done, wbuf_->count - done);
+              wbuf_->count -= done;
+              return -1;
+            }
+          impl ().offset_ += ret;
+          done += static_cast<std::size_t> (ret);
+        }
+
+      wbuf_->count = 0;
+      return 0;
+    }
+
+    void
+    io::free_buffer (void)
+    {
+      if (wbuf_ != nullptr)
+        {
+          wbuf_->mr->deallocate (wbuf_, sizeof(write_buffer) + wbuf_->size);
+          wbuf_ = nullptr;
+        }
+    }
+
     // ------------------------------------------------------------------------
 
     // All these wrappers are required to clear 'errno'.
@@ -256,8 +454,22 @@ namespace os
           return 0; // Nothing to do.
         }
 
+      if (flush_buffer () < 0)
+        {
+          return -1;
+        }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       // Execute the implementation specific code.
       ssize_t ret = impl ().do_read (buf, nbyte);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_read (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       if (ret >= 0)
         {
           impl ().offset_ += ret;
@@ -309,8 +521,50 @@ namespace os
           return 0; // Nothing to do.
         }
 
+      if (wbuf_ != nullptr)
+        {
+          if (nbyte < wbuf_->size)
+            {
+              if ((wbuf_->count + nbyte > wbuf_->size)
+                  && (flush_buffer () < 0))
+                {
+                  return -1;
+                }
+
+              std::memcpy (wbuf_->data () + wbuf_->count, buf, nbyte);
+              wbuf_->count += nbyte;
+
+              if ((wbuf_->count == wbuf_->size)
+                  || ((wbuf_->mode == _IOLBF)
+                      && (std::memchr (buf, '\n', nbyte) != nullptr)))
+                {
+                  // The data was accepted, errors are
+                  // reported by the next call.
+                  flush_buffer ();
+                  errno = 0;
+                }
+              return static_cast<ssize_t> (nbyte);
+            }
+
+          // Larger than the buffer, write it directly,
+          // after the buffered data.
+          if (flush_buffer () < 0)
+            {
+              return -1;
+            }
+        }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       // Execute the implementation specific code.
       ssize_t ret = impl ().do_write (buf, nbyte);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_write (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       if (ret >= 0)
         {
           impl ().offset_ += ret;
@@ -356,8 +610,22 @@ namespace os
 
       errno = 0;
 
+      if (flush_buffer () < 0)
+        {
+          return -1;
+        }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       // Execute the implementation specific code.
       ssize_t ret = impl ().do_writev (iov, iovcnt);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_write (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       if (ret >= 0)
         {
           impl ().offset_ += ret;
@@ -365,25 +633,25 @@ namespace os
       return ret;
     }
 
-    int
-    io::fcntl (int cmd, ...)
-    {
-      // Forward to the variadic version of the function.
-      std::va_list args;
-      va_start(args, cmd);
-      int ret = vfcntl (cmd, args);
-      va_end(args);
-
-      return ret;
-    }
-
-    int
-    io::vfcntl (int cmd, std::va_list args)
+    ssize_t
+    io::readv (const struct iovec* iov, int iovcnt)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(%d) @%p\n", __func__, cmd, this);
+      trace::printf ("io::%s(0x0%X, %d) @%p\n", __func__, iov, iovcnt, this);
 #endif
 
+      if (iov == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if (iovcnt <= 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
       if (!impl ().do_is_opened ())
         {
           errno = EBADF; // Not opened.
@@ -398,25 +666,35 @@ namespace os
 
       errno = 0;
 
-      // Execute the implementation specific code.
-      return impl ().do_vfcntl (cmd, args);
-    }
+      if (flush_buffer () < 0)
+        {
+          return -1;
+        }
 
-    int
-    io::isatty (void)
-    {
-      errno = 0;
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
 
       // Execute the implementation specific code.
-      return impl ().do_isatty ();
+      ssize_t ret = impl ().do_readv (iov, iovcnt);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_read (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      if (ret >= 0)
+        {
+          impl ().offset_ += ret;
+        }
+      return ret;
     }
 
-    // fstat() on a socket returns a zero'd buffer.
-    int
-    io::fstat (struct stat* buf)
+    ssize_t
+    io::pread (void* buf, std::size_t nbyte, off_t offset)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(%p) @%p\n", __func__, buf, this);
+      trace::printf ("io::%s(0x0%X, %u, %d) @%p\n", __func__, buf, nbyte,
+                     offset, this);
 #endif
 
       if (buf == nullptr)
@@ -425,6 +703,12 @@ namespace os
           return -1;
         }
 
+      if (offset < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
       if (!impl ().do_is_opened ())
         {
           errno = EBADF; // Not opened.
@@ -439,64 +723,703 @@ namespace os
 
       errno = 0;
 
+      if (nbyte == 0)
+        {
+          return 0; // Nothing to do.
+        }
+
+      if (flush_buffer () < 0)
+        {
+          return -1;
+        }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
       // Execute the implementation specific code.
-      return impl ().do_fstat (buf);
+      // The current offset is not changed.
+      ssize_t ret = impl ().do_pread (buf, nbyte, offset);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_read (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      return ret;
     }
 
-    off_t
-    io::lseek (off_t offset, int whence)
+    ssize_t
+    io::pwrite (const void* buf, std::size_t nbyte, off_t offset)
     {
 #if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io::%s(%d, %d) @%p\n", __func__, offset, whence, this);
+      trace::printf ("io::%s(0x0%X, %u, %d) @%p\n", __func__, buf, nbyte,
+                     offset, this);
 #endif
 
+      if (buf == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if (offset < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
       if (!impl ().do_is_opened ())
         {
           errno = EBADF; // Not opened.
           return -1;
         }
 
+      if (!impl ().do_is_connected ())
+        {
+          errno = EIO; // Not opened.
+          return -1;
+        }
+
       errno = 0;
 
-      // Execute the implementation specific code.
-      return impl ().do_lseek (offset, whence);
-    }
+      if (nbyte == 0)
+        {
+          return 0; // Nothing to do.
+        }
 
-    // ========================================================================
+      if (flush_buffer () < 0)
+        {
+          return -1;
+        }
 
-    io_impl::io_impl (void)
-    {
-#if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io_impl::%s()=%p\n", __func__, this);
-#endif
-    }
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
 
-    io_impl::~io_impl ()
-    {
-#if defined(OS_TRACE_POSIX_IO_IO)
-      trace::printf ("io_impl::%s() @%p\n", __func__, this);
-#endif
-    }
+      // Execute the implementation specific code.
+      // The current offset is not changed.
+      ssize_t ret = impl ().do_pwrite (buf, nbyte, offset);
 
-    void
-    io_impl::do_deallocate (void)
-    {
-      return;
-    }
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_write (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
 
-    bool
-    io_impl::do_is_connected (void)
-    {
-      return true;
+      return ret;
     }
 
     ssize_t
-    io_impl::do_writev (const struct iovec* iov, int iovcnt)
+    io::preadv (const struct iovec* iov, int iovcnt, off_t offset)
     {
-      ssize_t total = 0;
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf ("io::%s(0x0%X, %d, %d) @%p\n", __func__, iov, iovcnt,
+                     offset, this);
+#endif
 
-      const struct iovec* p = iov;
-      for (int i = 0; i < iovcnt; ++i, ++p)
+      if (iov == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if (iovcnt <= 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (offset < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      if (!impl ().do_is_connected ())
+        {
+          errno = EIO; // Not opened.
+          return -1;
+        }
+
+      errno = 0;
+
+      if (flush_buffer () < 0)
+        {
+          return -1;
+        }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      // Execute the implementation specific code.
+      ssize_t ret = impl ().do_preadv (iov, iovcnt, offset);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_read (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      return ret;
+    }
+
+    ssize_t
+    io::pwritev (const struct iovec* iov, int iovcnt, off_t offset)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf ("io::%s(0x0%X, %d, %d) @%p\n", __func__, iov, iovcnt,
+                     offset, this);
+#endif
+
+      if (iov == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if (iovcnt <= 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (offset < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      if (!impl ().do_is_connected ())
+        {
+          errno = EIO; // Not opened.
+          return -1;
+        }
+
+      errno = 0;
+
+      if (flush_buffer () < 0)
+        {
+          return -1;
+        }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      rtos::clock::timestamp_t begin = rtos::hrclock.now ();
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      // Execute the implementation specific code.
+      ssize_t ret = impl ().do_pwritev (iov, iovcnt, offset);
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+      impl ().account_write (begin, ret);
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+      return ret;
+    }
+
+    int
+    io::fcntl (int cmd, ...)
+    {
+      // Forward to the variadic version of the function.
+      std::va_list args;
+      va_start(args, cmd);
+      int ret = vfcntl (cmd, args);
+      va_end(args);
+
+      return ret;
+    }
+
+    int
+    io::vfcntl (int cmd, std::va_list args)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf ("io::%s(%d) @%p\n", __func__, cmd, this);
+#endif
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      if (!impl ().do_is_connected ())
+        {
+          errno = EIO; // Not opened.
+          return -1;
+        }
+
+      errno = 0;
+
+      // Execute the implementation specific code.
+      return impl ().do_vfcntl (cmd, args);
+    }
+
+    int
+    io::isatty (void)
+    {
+      errno = 0;
+
+      // Execute the implementation specific code.
+      return impl ().do_isatty ();
+    }
+
+    int
+    io::poll (int events)
+    {
+      if (!impl ().do_is_opened ())
+        {
+          return POLLNVAL; // Not opened.
+        }
+
+      // Execute the implementation specific code.
+      int const ret = impl ().do_poll (events);
+
+      return ret & (events | POLLERR | POLLHUP | POLLNVAL);
+    }
+
+    void*
+    io::mmap (std::size_t length, int prot, int flags, off_t offset)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf ("io::%s(%u, %d, %d, %d) @%p\n", __func__, length, prot,
+                     flags, offset, this);
+#endif
+
+      int sharing = flags & (MAP_SHARED | MAP_PRIVATE);
+      if ((length == 0) || (offset < 0)
+          || ((sharing != MAP_SHARED) && (sharing != MAP_PRIVATE)))
+        {
+          errno = EINVAL;
+          return MAP_FAILED;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return MAP_FAILED;
+        }
+
+      errno = 0;
+
+      if (flush_buffer () < 0)
+        {
+          return MAP_FAILED;
+        }
+
+      // Execute the implementation specific code.
+      return impl ().do_mmap (length, prot, flags, offset);
+    }
+
+    int
+    io::munmap (void* addr, std::size_t length)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf ("io::%s(%p, %u) @%p\n", __func__, addr, length, this);
+#endif
+
+      if ((addr == nullptr) || (addr == MAP_FAILED) || (length == 0))
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      errno = 0;
+
+      // Execute the implementation specific code.
+      return impl ().do_munmap (addr, length);
+    }
+
+    ssize_t
+    io::sendfile (io& in, off_t* offset, std::size_t count)
+    {
+      return splice (in, offset, nullptr, count);
+    }
+
+    /**
+     * @details
+     * Both objects are accessed via their public functions,
+     * so lockable objects are locked for each chunk.
+     */
+    ssize_t
+    io::splice (io& in, off_t* in_offset, off_t* out_offset,
+                std::size_t count)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf ("io::%s(@%p, %u) @%p\n", __func__, &in, count, this);
+#endif
+
+      if (((in_offset != nullptr) && (*in_offset < 0))
+          || ((out_offset != nullptr) && (*out_offset < 0)))
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened () || !in.impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      errno = 0;
+
+      if (count == 0)
+        {
+          return 0; // Nothing to do.
+        }
+
+      if (out_offset == nullptr)
+        {
+          if (flush_buffer () < 0)
+            {
+              return -1;
+            }
+
+          // Try the direct transfer first.
+          ssize_t ret = impl ().do_sendfile (in, in_offset, count);
+          if ((ret >= 0) || (errno != ENOSYS))
+            {
+              return ret;
+            }
+          errno = 0;
+        }
+
+      uint8_t buf[OS_INTEGER_POSIX_IO_SPLICE_BUFFER_SIZE];
+      std::size_t total = 0;
+      while (total < count)
+        {
+          std::size_t chunk = count - total;
+          if (chunk > sizeof(buf))
+            {
+              chunk = sizeof(buf);
+            }
+
+          ssize_t nread;
+          if (in_offset != nullptr)
+            {
+              nread = in.pread (buf, chunk, *in_offset);
+            }
+          else
+            {
+              nread = in.read (buf, chunk);
+            }
+          if (nread <= 0)
+            {
+              if ((nread < 0) && (total == 0))
+                {
+                  return -1;
+                }
+              break;
+            }
+
+          ssize_t nwritten;
+          if (out_offset != nullptr)
+            {
+              nwritten = pwrite (buf, static_cast<std::size_t> (nread),
+                                 *out_offset);
+            }
+          else
+            {
+              nwritten = write (buf, static_cast<std::size_t> (nread));
+            }
+
+          std::size_t done =
+              (nwritten > 0) ? static_cast<std::size_t> (nwritten) : 0;
+          if (in_offset != nullptr)
+            {
+              *in_offset += static_cast<off_t> (done);
+            }
+          if (out_offset != nullptr)
+            {
+              *out_offset += static_cast<off_t> (done);
+            }
+          total += done;
+
+          if (done < static_cast<std::size_t> (nread))
+            {
+              if ((in_offset != nullptr)
+                  || (in.lseek (static_cast<off_t> (done) - nread, SEEK_CUR)
+                      >= 0))
+                {
+                  // The bytes not written are left in the input.
+                  if ((nwritten < 0) && (total == 0))
+                    {
+                      return -1;
+                    }
+                  break;
+                }
+
+              // The input is not seekable, the bytes already read
+              // cannot be given back, so they must be written.
+              while (done < static_cast<std::size_t> (nread))
+                {
+                  std::size_t rest = static_cast<std::size_t> (nread) - done;
+                  if (out_offset != nullptr)
+                    {
+                      nwritten = pwrite (buf + done, rest, *out_offset);
+                    }
+                  else
+                    {
+                      nwritten = write (buf + done, rest);
+                    }
+                  if (nwritten <= 0)
+                    {
+                      if (total > 0)
+                        {
+                          // Partial transfer, like for the
+                          // seekable inputs.
+                          break;
+                        }
+                      if (nwritten == 0)
+                        {
+                          errno = EIO;
+                        }
+                      return -1;
+                    }
+
+                  if (out_offset != nullptr)
+                    {
+                      *out_offset += nwritten;
+                    }
+                  done += static_cast<std::size_t> (nwritten);
+                  total += static_cast<std::size_t> (nwritten);
+                }
+              break;
+            }
+
+          if (static_cast<std::size_t> (nread) < chunk)
+            {
+              break; // Short read, no more data for now.
+            }
+        }
+
+      errno = 0;
+      return static_cast<ssize_t> (total);
+    }
+
+    int
+    io::setvbuf (int mode, std::size_t size,
+                 rtos::memory::memory_resource* mr)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf ("io::%s(%d, %u) @%p\n", __func__, mode, size, this);
+#endif
+
+      if (((mode != _IOFBF) && (mode != _IOLBF) && (mode != _IONBF))
+          || ((type_ & (type::file | type::char_device)) == 0))
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      errno = 0;
+
+      if (flush_buffer () < 0)
+        {
+          return -1;
+        }
+      free_buffer ();
+
+      if (mode == _IONBF)
+        {
+          return 0;
+        }
+
+      if (size == 0)
+        {
+          size = OS_INTEGER_POSIX_IO_STREAM_BUFFER_SIZE;
+        }
+      if (mr == nullptr)
+        {
+          mr = rtos::memory::get_default_resource ();
+        }
+
+      void* p = mr->allocate (sizeof(write_buffer) + size);
+      if (p == nullptr)
+        {
+          errno = ENOMEM;
+          return -1;
+        }
+
+      wbuf_ = static_cast<write_buffer*> (p);
+      wbuf_->mr = mr;
+      wbuf_->size = size;
+      wbuf_->count = 0;
+      wbuf_->mode = mode;
+
+      return 0;
+    }
+
+    int
+    io::flush (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf ("io::%s() @%p\n", __func__, this);
+#endif
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      errno = 0;
+
+      return flush_buffer ();
+    }
+
+    // fstat() on a socket returns a zero'd buffer.
+    int
+    io::fstat (struct stat* buf)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf ("io::%s(%p) @%p\n", __func__, buf, this);
+#endif
+
+      if (buf == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      if (!impl ().do_is_connected ())
+        {
+          errno = EIO; // Not opened.
+          return -1;
+        }
+
+      errno = 0;
+
+      if (flush_buffer () < 0)
+        {
+          return -1;
+        }
+
+      // Execute the implementation specific code.
+      return impl ().do_fstat (buf);
+    }
+
+    off_t
+    io::lseek (off_t offset, int whence)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf ("io::%s(%d, %d) @%p\n", __func__, offset, whence, this);
+#endif
+
+      if (!impl ().do_is_opened ())
+        {
+          errno = EBADF; // Not opened.
+          return -1;
+        }
+
+      errno = 0;
+
+      if (flush_buffer () < 0)
+        {
+          return -1;
+        }
+
+      // Execute the implementation specific code.
+      return impl ().do_lseek (offset, whence);
+    }
+
+    // ========================================================================
+
+    poll_waiter::poll_waiter (void)
+    {
+      ;
+    }
+
+    poll_waiter::~poll_waiter ()
+    {
+      unlink ();
+    }
+
+    /**
+     * @details
+     * Can be called from interrupt service routines.
+     */
+    void
+    poll_waiter::notify (void)
+    {
+      if (sem_ != nullptr)
+        {
+          sem_->post ();
+        }
+    }
+
+    void
+    poll_waiter::unlink (void)
+    {
+      rtos::interrupts::critical_section ics;
+
+      links_.unlink ();
+    }
+
+    // ========================================================================
+
+    io_impl::io_impl (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf ("io_impl::%s()=%p\n", __func__, this);
+#endif
+    }
+
+    io_impl::~io_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_IO)
+      trace::printf ("io_impl::%s() @%p\n", __func__, this);
+#endif
+
+      // Waiters still linked are released, to not leave
+      // them pointing into a destroyed object.
+      rtos::interrupts::critical_section ics;
+
+      while (!waiters_.empty ())
+        {
+          waiters_.unlink_head ();
+        }
+    }
+
+    void
+    io_impl::do_deallocate (void)
+    {
+      return;
+    }
+
+    bool
+    io_impl::do_is_connected (void)
+    {
+      return true;
+    }
+
+    ssize_t
+    io_impl::do_writev (const struct iovec* iov, int iovcnt)
+    {
+      ssize_t total = 0;
+
+      const struct iovec* p = iov;
+      for (int i = 0; i < iovcnt; ++i, ++p)
         {
           ssize_t ret = do_write (p->iov_base, p->iov_len);
           if (ret < 0)
@@ -508,9 +1431,115 @@ namespace os
       return total;
     }
 
+    ssize_t
+    io_impl::do_readv (const struct iovec* iov, int iovcnt)
+    {
+      ssize_t total = 0;
+
+      const struct iovec* p = iov;
+      for (int i = 0; i < iovcnt; ++i, ++p)
+        {
+          ssize_t ret = do_read (p->iov_base, p->iov_len);
+          if (ret < 0)
+            {
+              return ret;
+            }
+          total += ret;
+          if (static_cast<std::size_t> (ret) < p->iov_len)
+            {
+              break; // Short read, do not wait for more.
+            }
+        }
+      return total;
+    }
+
+    ssize_t
+    io_impl::do_preadv (const struct iovec* iov, int iovcnt, off_t offset)
+    {
+      ssize_t total = 0;
+
+      const struct iovec* p = iov;
+      for (int i = 0; i < iovcnt; ++i, ++p)
+        {
+          ssize_t ret = do_pread (p->iov_base, p->iov_len, offset + total);
+          if (ret < 0)
+            {
+              return ret;
+            }
+          total += ret;
+          if (static_cast<std::size_t> (ret) < p->iov_len)
+            {
+              break; // End of file.
+            }
+        }
+      return total;
+    }
+
+    ssize_t
+    io_impl::do_pwritev (const struct iovec* iov, int iovcnt, off_t offset)
+    {
+      ssize_t total = 0;
+
+      const struct iovec* p = iov;
+      for (int i = 0; i < iovcnt; ++i, ++p)
+        {
+          ssize_t ret = do_pwrite (p->iov_base, p->iov_len, offset + total);
+          if (ret < 0)
+            {
+              return ret;
+            }
+          total += ret;
+          if (static_cast<std::size_t> (ret) < p->iov_len)
+            {
+              break;
+            }
+        }
+      return total;
+    }
+
+    void
+    io_impl::link_waiter (poll_waiter& waiter)
+    {
+      rtos::interrupts::critical_section ics;
+
+      waiters_.link (waiter);
+    }
+
+    /**
+     * @details
+     * Wake up all threads waiting in `poll()` or `select()` for
+     * this object, which will check again its readiness.
+     *
+     * Can be called from interrupt service routines.
+     */
+    void
+    io_impl::notify_readiness (void)
+    {
+      rtos::interrupts::critical_section ics;
+
+      for (auto&& waiter : waiters_)
+        {
+          waiter.notify ();
+        }
+    }
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 
+    ssize_t
+    io_impl::do_pread (void* buf, std::size_t nbyte, off_t offset)
+    {
+      errno = ESPIPE; // Not seekable.
+      return -1;
+    }
+
+    ssize_t
+    io_impl::do_pwrite (const void* buf, std::size_t nbyte, off_t offset)
+    {
+      errno = ESPIPE; // Not seekable.
+      return -1;
+    }
+
     int
     io_impl::do_vfcntl (int cmd, std::va_list args)
     {
@@ -532,8 +1561,102 @@ namespace os
       return -1;
     }
 
+    int
+    io_impl::do_poll (int events)
+    {
+      return POLLIN | POLLRDNORM | POLLOUT | POLLWRNORM;
+    }
+
+    ssize_t
+    io_impl::do_sendfile (io& in, off_t* offset, std::size_t count)
+    {
+      errno = ENOSYS; // Use the generic transfer.
+      return -1;
+    }
+
 #pragma GCC diagnostic pop
 
+    void*
+    io_impl::do_mmap (std::size_t length, int prot, int flags, off_t offset)
+    {
+      if (((flags & MAP_SHARED) != 0) && ((prot & PROT_WRITE) != 0))
+        {
+          // Changes to a copy cannot be shared.
+          errno = ENODEV;
+          return MAP_FAILED;
+        }
+
+      // Remember the resource, the default might change
+      // until munmap().
+      auto* mr = rtos::memory::get_default_resource ();
+      void* h = mr->allocate (mapping_offset + length);
+      if (h == nullptr)
+        {
+          errno = ENOMEM;
+          return MAP_FAILED;
+        }
+      uint8_t* p = static_cast<uint8_t*> (h) + mapping_offset;
+
+      ssize_t ret = do_pread (p, length, offset);
+      if (ret < 0)
+        {
+          mr->deallocate (h, mapping_offset + length);
+          if (errno == ESPIPE)
+            {
+              // Streams cannot be mapped.
+              errno = ENODEV;
+            }
+          return MAP_FAILED;
+        }
+
+      // Past the end reads as zeroes.
+      std::memset (p + ret, 0, length - static_cast<std::size_t> (ret));
+
+      auto* m = new (h) mapping;
+      m->resource = mr;
+      m->length = length;
+
+        {
+          rtos::scheduler::critical_section scs;
+
+          mappings_.link (*m);
+        }
+
+      return p;
+    }
+
+    int
+    io_impl::do_munmap (void* addr, std::size_t length)
+    {
+      mapping* found = nullptr;
+        {
+          rtos::scheduler::critical_section scs;
+
+          for (auto&& m : mappings_)
+            {
+              if (reinterpret_cast<uint8_t*> (&m) + mapping_offset == addr
+                  && m.length == length)
+                {
+                  found = &m;
+                  break;
+                }
+            }
+          if (found == nullptr)
+            {
+              errno = EINVAL; // Not a copy of this object.
+              return -1;
+            }
+
+          found->links.unlink ();
+        }
+
+      auto* mr = found->resource;
+      found->~mapping ();
+      mr->deallocate (found, mapping_offset + length);
+
+      return 0;
+    }
+
   // ==========================================================================
   } /* namespace posix */
 } /* namespace os */
@@ -0,0 +1,76 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/net-interface.h>
+
+#include <cmsis-plus/diag/trace.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    net_interface::net_interface (net_interface_impl& impl, const char* name) :
+        name_ (name), //
+        impl_ (impl)
+    {
+#if defined(OS_TRACE_POSIX_IO_NET_INTERFACE)
+      trace::printf ("net_interface::%s(\"%s\")=%p\n", __func__, name_, this);
+#endif
+    }
+
+    net_interface::~net_interface ()
+    {
+#if defined(OS_TRACE_POSIX_IO_NET_INTERFACE)
+      trace::printf ("net_interface::%s(\"%s\") %p\n", __func__, name_, this);
+#endif
+    }
+
+    // ========================================================================
+
+    net_interface_impl::net_interface_impl (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_NET_INTERFACE)
+      trace::printf ("net_interface_impl::%s()=%p\n", __func__, this);
+#endif
+    }
+
+    net_interface_impl::~net_interface_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_NET_INTERFACE)
+      trace::printf ("net_interface_impl::%s() @%p\n", __func__, this);
+#endif
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,585 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/pipe.h>
+#include <cmsis-plus/posix-io/file-descriptors-manager.h>
+#include <cmsis-plus/posix/poll.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <mutex>
+#include <new>
+#include <sys/stat.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    pipe::pipe (pipe_channel& channel, bool reader, int oflag) :
+        io
+          { impl_instance_, type::fifo }, //
+        impl_instance_
+          { channel, reader, oflag }
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf ("pipe::%s()=@%p\n", __func__, this);
+#endif
+    }
+
+    pipe::~pipe ()
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf ("pipe::%s() @%p\n", __func__, this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    int
+    pipe::close (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf ("pipe::%s() @%p\n", __func__, this);
+#endif
+
+      pipe_channel& channel = impl ().channel_;
+      bool const was_opened = impl ().do_is_opened ();
+
+      int ret = io::close ();
+
+      if (was_opened)
+        {
+          // May destroy this object, do not use it below.
+          channel.pool_.release (&channel);
+        }
+
+      return ret;
+    }
+
+    ssize_t
+    pipe::peek (const void** pbuf)
+    {
+      if (pbuf == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      if (!impl ().do_is_opened () || !impl ().reader_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      pipe_channel& channel = impl ().channel_;
+      std::lock_guard<rtos::mutex> lock
+        { channel.mutex_ };
+
+      uint8_t* p;
+      std::size_t n = channel.buffer_.front_contiguous_buffer (&p);
+      *pbuf = p;
+
+      return static_cast<ssize_t> (n);
+    }
+
+    ssize_t
+    pipe::consume (std::size_t nbyte)
+    {
+      if (!impl ().do_is_opened () || !impl ().reader_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      pipe_channel& channel = impl ().channel_;
+      std::size_t n;
+        {
+          std::lock_guard<rtos::mutex> lock
+            { channel.mutex_ };
+
+          n = channel.buffer_.advance_front (nbyte);
+        }
+
+      if (n > 0)
+        {
+          channel.writable_sem_.post ();
+          impl ().peer ().notify_readiness ();
+        }
+
+      return static_cast<ssize_t> (n);
+    }
+
+    // ========================================================================
+
+    pipe_impl::pipe_impl (pipe_channel& channel, bool reader, int oflag) :
+        channel_ (channel), //
+        reader_ (reader), //
+        nonblock_ ((oflag & O_NONBLOCK) != 0)
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf ("pipe_impl::%s()=@%p\n", __func__, this);
+#endif
+    }
+
+    pipe_impl::~pipe_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf ("pipe_impl::%s() @%p\n", __func__, this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    bool
+    pipe_impl::do_is_opened (void)
+    {
+      return opened_;
+    }
+
+    ssize_t
+    pipe_impl::do_read (void* buf, std::size_t nbyte)
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf ("pipe_impl::%s(%p, %u) @%p\n", __func__, buf, nbyte, this);
+#endif
+
+      if (!reader_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      while (true)
+        {
+          std::size_t count;
+          bool more;
+          bool writer_opened;
+            {
+              std::lock_guard<rtos::mutex> lock
+                { channel_.mutex_ };
+
+              count = channel_.buffer_.pop_front (static_cast<uint8_t*> (buf),
+                                                  nbyte);
+              more = !channel_.buffer_.empty ();
+              writer_opened = peer ().opened_;
+            }
+
+          if (count > 0)
+            {
+              if (more)
+                {
+                  // Let other readers continue.
+                  channel_.readable_sem_.post ();
+                }
+              channel_.writable_sem_.post ();
+              peer ().notify_readiness ();
+
+              return static_cast<ssize_t> (count);
+            }
+
+          if (!writer_opened)
+            {
+              return 0; // End of file.
+            }
+
+          if (nonblock_)
+            {
+              errno = EAGAIN;
+              return -1;
+            }
+
+          // Block and wait for bytes to arrive.
+          channel_.readable_sem_.wait ();
+        }
+    }
+
+    ssize_t
+    pipe_impl::do_write (const void* buf, std::size_t nbyte)
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf ("pipe_impl::%s(%p, %u) @%p\n", __func__, buf, nbyte, this);
+#endif
+
+      if (reader_)
+        {
+          errno = EBADF;
+          return -1;
+        }
+
+      bool const atomic = (nbyte <= atomic_size ());
+
+      std::size_t total = 0;
+      while (true)
+        {
+          std::size_t count = 0;
+          bool more = false;
+          bool reader_opened;
+            {
+              std::lock_guard<rtos::mutex> lock
+                { channel_.mutex_ };
+
+              reader_opened = peer ().opened_;
+              if (reader_opened)
+                {
+                  std::size_t const room = channel_.buffer_.size ()
+                      - channel_.buffer_.length ();
+                  if (!atomic || (room >= nbyte))
+                    {
+                      count = channel_.buffer_.push_back (
+                          static_cast<const uint8_t*> (buf) + total,
+                          nbyte - total);
+                    }
+                  more = !channel_.buffer_.full ();
+                }
+            }
+
+          if (!reader_opened)
+            {
+              if (total > 0)
+                {
+                  return static_cast<ssize_t> (total);
+                }
+              errno = EPIPE;
+              return -1;
+            }
+
+          if (count > 0)
+            {
+              total += count;
+              if (more)
+                {
+                  // Let other writers continue.
+                  channel_.writable_sem_.post ();
+                }
+              channel_.readable_sem_.post ();
+              peer ().notify_readiness ();
+            }
+
+          if (total == nbyte)
+            {
+              return static_cast<ssize_t> (total);
+            }
+
+          if (nonblock_)
+            {
+              if (total > 0)
+                {
+                  return static_cast<ssize_t> (total);
+                }
+              errno = EAGAIN;
+              return -1;
+            }
+
+          // Block and wait for the buffer to be freed.
+          channel_.writable_sem_.wait ();
+        }
+    }
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    off_t
+    pipe_impl::do_lseek (off_t offset, int whence)
+    {
+      errno = ESPIPE; // Not seekable.
+      return -1;
+    }
+
+#pragma GCC diagnostic pop
+
+    int
+    pipe_impl::do_vfcntl (int cmd, std::va_list args)
+    {
+      switch (cmd)
+        {
+        case F_GETFL:
+          return (reader_ ? O_RDONLY : O_WRONLY)
+              | (nonblock_ ? O_NONBLOCK : 0);
+
+        case F_SETFL:
+          nonblock_ = ((va_arg(args, int) & O_NONBLOCK) != 0);
+          return 0;
+
+        default:
+          errno = EINVAL;
+          return -1;
+        }
+    }
+
+    int
+    pipe_impl::do_fstat (struct stat* buf)
+    {
+      std::memset (buf, 0, sizeof(*buf));
+      buf->st_mode = S_IFIFO | (reader_ ? S_IRUSR : S_IWUSR);
+
+      std::lock_guard<rtos::mutex> lock
+        { channel_.mutex_ };
+
+      buf->st_size = static_cast<off_t> (channel_.buffer_.length ());
+      buf->st_blksize = static_cast<blksize_t> (channel_.buffer_.size ());
+
+      return 0;
+    }
+
+    /**
+     * @details
+     * The write end is ready when a write of `OS_INTEGER_POSIX_IO_PIPE_BUF`
+     * bytes would not block. The read end reports POLLHUP after the write
+     * end is closed, the write end reports POLLERR after the read
+     * end is closed.
+     */
+    int
+    pipe_impl::do_poll (int events)
+    {
+      std::lock_guard<rtos::mutex> lock
+        { channel_.mutex_ };
+
+      int ret = 0;
+      if (reader_)
+        {
+          if (!channel_.buffer_.empty ())
+            {
+              ret |= (POLLIN | POLLRDNORM);
+            }
+          if (!peer ().opened_)
+            {
+              ret |= POLLHUP;
+            }
+        }
+      else
+        {
+          if (!peer ().opened_)
+            {
+              ret |= POLLERR;
+            }
+          else if (channel_.buffer_.size () - channel_.buffer_.length ()
+              >= atomic_size ())
+            {
+              ret |= (POLLOUT | POLLWRNORM);
+            }
+        }
+      return ret & (events | POLLERR | POLLHUP);
+    }
+
+    int
+    pipe_impl::do_close (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf ("pipe_impl::%s() @%p\n", __func__, this);
+#endif
+
+        {
+          std::lock_guard<rtos::mutex> lock
+            { channel_.mutex_ };
+
+          opened_ = false;
+        }
+
+      // Wake up the other end, to return end of file or EPIPE.
+      channel_.readable_sem_.post ();
+      channel_.writable_sem_.post ();
+      peer ().notify_readiness ();
+
+      return 0;
+    }
+
+    std::size_t
+    pipe_impl::atomic_size (void)
+    {
+      std::size_t const size = channel_.buffer_.size ();
+      return (size < OS_INTEGER_POSIX_IO_PIPE_BUF) ?
+          size : OS_INTEGER_POSIX_IO_PIPE_BUF;
+    }
+
+    // ========================================================================
+
+    pipe_channel::pipe_channel (pipe_pool& pool, uint8_t* buf, std::size_t size,
+                                int oflag) :
+        pool_ (pool), //
+        buffer_
+          { buf, size }, //
+        read_end_
+          { *this, true, oflag }, //
+        write_end_
+          { *this, false, oflag }
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf ("pipe_channel::%s(%p, %u)=@%p\n", __func__, buf, size,
+                     this);
+#endif
+    }
+
+    pipe_channel::~pipe_channel ()
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf ("pipe_channel::%s() @%p\n", __func__, this);
+#endif
+    }
+
+    // ========================================================================
+
+    pipe_pool* pipe_pool::default_pool__;
+
+    /**
+     * @details
+     * Each block of the pool stores the shared state and the
+     * buffer of a pipe.
+     */
+    pipe_pool::pipe_pool (std::size_t pipes, std::size_t buffer_size_bytes,
+                          rtos::memory::memory_resource* mr) :
+        block_pool
+          { "pipes" }, //
+        mr_ (mr), //
+        buffer_size_bytes_ (buffer_size_bytes)
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf ("pipe_pool::%s(%u, %u)=@%p\n", __func__, pipes,
+                     buffer_size_bytes, this);
+#endif
+
+      std::size_t const block_size_bytes = rtos::memory::align_size (
+          sizeof(pipe_channel) + buffer_size_bytes, alignof(pipe_channel));
+
+      arena_size_bytes_ = pipes * block_size_bytes;
+      arena_ = mr_->allocate (arena_size_bytes_);
+      if (arena_ == nullptr)
+        {
+          estd::__throw_bad_alloc ();
+        }
+
+      internal_construct_ (pipes, block_size_bytes, arena_, arena_size_bytes_);
+
+      if (default_pool__ == nullptr)
+        {
+          default_pool__ = this;
+        }
+    }
+
+    pipe_pool::~pipe_pool ()
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf ("pipe_pool::%s() @%p\n", __func__, this);
+#endif
+
+      if (default_pool__ == this)
+        {
+          default_pool__ = nullptr;
+        }
+
+      mr_->deallocate (arena_, arena_size_bytes_);
+    }
+
+    // ------------------------------------------------------------------------
+
+    int
+    pipe_pool::create (class pipe* ends[2], int oflag)
+    {
+#if defined(OS_TRACE_POSIX_IO_PIPE)
+      trace::printf ("pipe_pool::%s(%p, 0x%X) @%p\n", __func__, ends, oflag,
+                     this);
+#endif
+
+      if (ends == nullptr)
+        {
+          errno = EFAULT;
+          return -1;
+        }
+
+      void* block;
+        {
+          rtos::interrupts::critical_section ics;
+
+          block = allocate (block_size_bytes_);
+        }
+      if (block == nullptr)
+        {
+          errno = ENFILE; // No more pipes.
+          return -1;
+        }
+
+      auto* channel = new (block) pipe_channel (
+          *this, static_cast<uint8_t*> (block) + sizeof(pipe_channel),
+          buffer_size_bytes_, oflag);
+
+      if (file_descriptors_manager::allocate (&channel->read_end_) < 0)
+        {
+          channel->ends_ = 1;
+          release (channel);
+          return -1;
+        }
+
+      if (file_descriptors_manager::allocate (&channel->write_end_) < 0)
+        {
+          file_descriptors_manager::deallocate (
+              channel->read_end_.file_descriptor ());
+          channel->ends_ = 1;
+          release (channel);
+          return -1;
+        }
+
+      ends[0] = &channel->read_end_;
+      ends[1] = &channel->write_end_;
+
+      return 0;
+    }
+
+    /**
+     * @details
+     * Called when an end is closed; the block is returned
+     * to the pool after the last one.
+     */
+    void
+    pipe_pool::release (pipe_channel* channel)
+    {
+        {
+          std::lock_guard<rtos::mutex> lock
+            { channel->mutex_ };
+
+          if (--channel->ends_ > 0)
+            {
+              return;
+            }
+        }
+
+      channel->~pipe_channel ();
+
+      rtos::interrupts::critical_section ics;
+
+      deallocate (channel, block_size_bytes_);
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,131 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/shared-locker.h>
+
+#include <cassert>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    void
+    shared_locker::lock (void)
+    {
+      mutex_.lock ();
+
+      // Announce the intention, to stop new shared owners.
+      ++waiting_writers_;
+      while (writer_ || (readers_ > 0))
+        {
+          cond_.wait (mutex_);
+        }
+      --waiting_writers_;
+      writer_ = true;
+
+      mutex_.unlock ();
+    }
+
+    bool
+    shared_locker::try_lock (void)
+    {
+      mutex_.lock ();
+
+      bool ret = !writer_ && (readers_ == 0);
+      if (ret)
+        {
+          writer_ = true;
+        }
+
+      mutex_.unlock ();
+      return ret;
+    }
+
+    void
+    shared_locker::unlock (void)
+    {
+      mutex_.lock ();
+
+      writer_ = false;
+      cond_.broadcast ();
+
+      mutex_.unlock ();
+    }
+
+    void
+    shared_locker::lock_shared (void)
+    {
+      mutex_.lock ();
+
+      while (writer_ || (waiting_writers_ > 0))
+        {
+          cond_.wait (mutex_);
+        }
+      ++readers_;
+
+      mutex_.unlock ();
+    }
+
+    bool
+    shared_locker::try_lock_shared (void)
+    {
+      mutex_.lock ();
+
+      bool ret = !writer_ && (waiting_writers_ == 0);
+      if (ret)
+        {
+          ++readers_;
+        }
+
+      mutex_.unlock ();
+      return ret;
+    }
+
+    void
+    shared_locker::unlock_shared (void)
+    {
+      mutex_.lock ();
+
+      assert(readers_ > 0);
+      if (--readers_ == 0)
+        {
+          // Wake up the exclusive owners.
+          cond_.broadcast ();
+        }
+
+      mutex_.unlock ();
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
@@ -0,0 +1,1499 @@
+/*
+ * This file is part of the µOS++ distribution.
+ *   (https://github.com/micro-os-plus)
+ * Copyright (c) 2018 Liviu Ionescu.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use,
+ * copy, modify, merge, publish, distribute, sublicense, and/or
+ * sell copies of the Software, and to permit persons to whom
+ * the Software is furnished to do so, subject to the following
+ * conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+ * OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cmsis-plus/posix-io/tmpfs.h>
+
+#include <cmsis-plus/posix/sys/uio.h>
+#include <cmsis-plus/posix/sys/statvfs.h>
+#include <cmsis-plus/diag/trace.h>
+
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <fcntl.h>
+#include <utime.h>
+
+// ----------------------------------------------------------------------------
+
+namespace os
+{
+  namespace posix
+  {
+    // ========================================================================
+
+    /**
+     * @cond ignore
+     */
+
+    // The longest name that fits in a directory entry.
+    static constexpr std::size_t tmpfs_name_max = sizeof(dirent::d_name) - 1;
+
+    /**
+     * @endcond
+     */
+
+    // ========================================================================
+
+    /**
+     * @details
+     * Nothing is allocated here; the hash table is allocated
+     * with the first entry.
+     *
+     * @param [in] mr Memory resource used for all file system data.
+     * @param [in] max_bytes Limit of the file data; 0 for no limit.
+     */
+    tmpfs_file_system_impl::tmpfs_file_system_impl (
+        rtos::memory::memory_resource* mr, std::size_t max_bytes) :
+        mr_ (mr), //
+        max_bytes_ (max_bytes)
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_file_system_impl::%s(%u)=@%p\n", __func__,
+                     max_bytes, this);
+#endif
+
+      root_.mode_ = S_IFDIR | 0777;
+      root_.ino_ = next_ino_++;
+      root_.atime_ = root_.mtime_ = root_.ctime_ = time (nullptr);
+    }
+
+    tmpfs_file_system_impl::tmpfs_file_system_impl (
+        rtos::mutex& locker, rtos::memory::memory_resource* mr,
+        std::size_t max_bytes) :
+        tmpfs_file_system_impl
+          { mr, max_bytes }
+    {
+      locker_ = &locker;
+    }
+
+    tmpfs_file_system_impl::~tmpfs_file_system_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_file_system_impl::%s() @%p\n", __func__, this);
+#endif
+
+      remove_all (&root_);
+
+      if (hash_table_ != nullptr)
+        {
+          mr_->deallocate (hash_table_, hash_size_ * sizeof(node*),
+                           alignof(node*));
+        }
+    }
+
+    // ------------------------------------------------------------------------
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+    /**
+     * @details
+     * All files and directories are removed; those still open
+     * are released when closed.
+     */
+    int
+    tmpfs_file_system_impl::do_vmkfs (int options, std::va_list args)
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_file_system_impl::%s() @%p\n", __func__, this);
+#endif
+
+      remove_all (&root_);
+
+      return 0;
+    }
+
+    int
+    tmpfs_file_system_impl::do_vmount (unsigned int flags, std::va_list args)
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_file_system_impl::%s() @%p\n", __func__, this);
+#endif
+
+      return 0;
+    }
+
+    /**
+     * @details
+     * The content is kept, and is available again at the next mount.
+     */
+    int
+    tmpfs_file_system_impl::do_umount (unsigned int flags)
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_file_system_impl::%s() @%p\n", __func__, this);
+#endif
+
+      return 0;
+    }
+
+#pragma GCC diagnostic pop
+
+    file*
+    tmpfs_file_system_impl::do_vopen (class file_system& fs, const char* path,
+                                      int oflag, std::va_list args)
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_file_system_impl::%s(\"%s\", %u) @%p\n", __func__,
+                     path, oflag, this);
+#endif
+
+      node* parent;
+      const char* name;
+      std::size_t len;
+      node* n = resolve (path, &parent, &name, &len);
+      if (n != nullptr)
+        {
+          if (((oflag & O_CREAT) != 0) && ((oflag & O_EXCL) != 0))
+            {
+              errno = EEXIST;
+              return nullptr;
+            }
+          if (S_ISDIR(n->mode_))
+            {
+              errno = EISDIR;
+              return nullptr;
+            }
+        }
+      else
+        {
+          if (((oflag & O_CREAT) == 0) || (parent == nullptr))
+            {
+              return nullptr;
+            }
+
+          // The mode is passed as int, after the default promotions.
+          mode_t mode = static_cast<mode_t> (va_arg(args, int));
+          n = create (parent, name, len, S_IFREG | (mode & 0777));
+          if (n == nullptr)
+            {
+              return nullptr;
+            }
+        }
+
+      if (((oflag & O_TRUNC) != 0) && ((oflag & O_ACCMODE) != O_RDONLY))
+        {
+          resize (n, 0);
+        }
+
+      file* fil;
+      if (locker_ != nullptr)
+        {
+          fil = fs.allocate_file<file_lockable<tmpfs_file_impl, rtos::mutex>> (
+              *locker_);
+        }
+      else
+        {
+          fil = fs.allocate_file<file_implementable<tmpfs_file_impl>> ();
+        }
+
+      auto& impl = static_cast<tmpfs_file_impl&> (fil->impl ());
+      impl.node_ = n;
+      impl.oflag_ = oflag;
+      open_node (n);
+
+      return fil;
+    }
+
+    directory*
+    tmpfs_file_system_impl::do_opendir (class file_system& fs,
+                                        const char* dirname)
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_file_system_impl::%s(\"%s\") @%p\n", __func__,
+                     dirname, this);
+#endif
+
+      node* parent;
+      const char* name;
+      std::size_t len;
+      node* n = resolve (dirname, &parent, &name, &len);
+      if (n == nullptr)
+        {
+          return nullptr;
+        }
+      if (!S_ISDIR(n->mode_))
+        {
+          errno = ENOTDIR;
+          return nullptr;
+        }
+
+      directory* dir;
+      if (locker_ != nullptr)
+        {
+          dir = fs.allocate_directory<
+              directory_lockable<tmpfs_directory_impl, rtos::mutex>> (
+              *locker_);
+        }
+      else
+        {
+          dir = fs.allocate_directory<
+              directory_implementable<tmpfs_directory_impl>> ();
+        }
+
+      auto& impl = static_cast<tmpfs_directory_impl&> (dir->impl ());
+      impl.node_ = n;
+      impl.do_rewind ();
+      open_node (n);
+
+      return dir;
+    }
+
+    int
+    tmpfs_file_system_impl::do_mkdir (const char* path, mode_t mode)
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_file_system_impl::%s(\"%s\", 0%o) @%p\n",
+                     __func__, path, mode, this);
+#endif
+
+      node* parent;
+      const char* name;
+      std::size_t len;
+      node* n = resolve (path, &parent, &name, &len);
+      if (n != nullptr)
+        {
+          errno = EEXIST;
+          return -1;
+        }
+      if (parent == nullptr)
+        {
+          return -1;
+        }
+
+      n = create (parent, name, len, S_IFDIR | (mode & 0777));
+      if (n == nullptr)
+        {
+          return -1;
+        }
+
+      return 0;
+    }
+
+    int
+    tmpfs_file_system_impl::do_rmdir (const char* path)
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_file_system_impl::%s(\"%s\") @%p\n", __func__,
+                     path, this);
+#endif
+
+      node* parent;
+      const char* name;
+      std::size_t len;
+      node* n = resolve (path, &parent, &name, &len);
+      if (n == nullptr)
+        {
+          return -1;
+        }
+      if (!S_ISDIR(n->mode_))
+        {
+          errno = ENOTDIR;
+          return -1;
+        }
+      if (n == &root_)
+        {
+          errno = EBUSY;
+          return -1;
+        }
+      if (parent == nullptr)
+        {
+          // Paths ending in `.` or `..`.
+          errno = EINVAL;
+          return -1;
+        }
+      if (n->first_child_ != nullptr)
+        {
+          errno = ENOTEMPTY;
+          return -1;
+        }
+
+      remove (n);
+
+      return 0;
+    }
+
+    void
+    tmpfs_file_system_impl::do_sync (void)
+    {
+      ;
+    }
+
+    int
+    tmpfs_file_system_impl::do_chmod (const char* path, mode_t mode)
+    {
+      node* parent;
+      const char* name;
+      std::size_t len;
+      node* n = resolve (path, &parent, &name, &len);
+      if (n == nullptr)
+        {
+          return -1;
+        }
+
+      n->mode_ = (n->mode_ & S_IFMT) | (mode & 07777);
+      n->ctime_ = time (nullptr);
+
+      return 0;
+    }
+
+    int
+    tmpfs_file_system_impl::do_stat (const char* path, struct stat* buf)
+    {
+      node* parent;
+      const char* name;
+      std::size_t len;
+      node* n = resolve (path, &parent, &name, &len);
+      if (n == nullptr)
+        {
+          return -1;
+        }
+
+      fill_stat (n, buf);
+
+      return 0;
+    }
+
+    int
+    tmpfs_file_system_impl::do_truncate (const char* path, off_t length)
+    {
+      node* parent;
+      const char* name;
+      std::size_t len;
+      node* n = resolve (path, &parent, &name, &len);
+      if (n == nullptr)
+        {
+          return -1;
+        }
+      if (S_ISDIR(n->mode_))
+        {
+          errno = EISDIR;
+          return -1;
+        }
+      if (length < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      return resize (n, length);
+    }
+
+    /**
+     * @details
+     * An existing destination is replaced, if compatible;
+     * files open with the old name remain valid.
+     */
+    int
+    tmpfs_file_system_impl::do_rename (const char* existing, const char* _new)
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_file_system_impl::%s(\"%s\", \"%s\") @%p\n",
+                     __func__, existing, _new, this);
+#endif
+
+      node* old_parent;
+      const char* old_name;
+      std::size_t old_len;
+      node* src = resolve (existing, &old_parent, &old_name, &old_len);
+      if (src == nullptr)
+        {
+          return -1;
+        }
+      if (old_parent == nullptr)
+        {
+          // The root, `.` or `..`.
+          errno = EBUSY;
+          return -1;
+        }
+
+      node* new_parent;
+      const char* new_name;
+      std::size_t new_len;
+      node* dst = resolve (_new, &new_parent, &new_name, &new_len);
+      if (new_parent == nullptr)
+        {
+          if (dst != nullptr)
+            {
+              errno = EBUSY;
+            }
+          return -1;
+        }
+      if (dst == src)
+        {
+          return 0;
+        }
+
+      if (S_ISDIR(src->mode_))
+        {
+          // A directory cannot be moved below itself.
+          for (node* d = new_parent; d != nullptr; d = d->parent_)
+            {
+              if (d == src)
+                {
+                  errno = EINVAL;
+                  return -1;
+                }
+            }
+        }
+
+      if (dst != nullptr)
+        {
+          if (S_ISDIR(dst->mode_))
+            {
+              if (!S_ISDIR(src->mode_))
+                {
+                  errno = EISDIR;
+                  return -1;
+                }
+              if (dst->first_child_ != nullptr)
+                {
+                  errno = ENOTEMPTY;
+                  return -1;
+                }
+            }
+          else if (S_ISDIR(src->mode_))
+            {
+              errno = ENOTDIR;
+              return -1;
+            }
+        }
+
+      // Allocate the new name first, nothing is changed on failure.
+      char* s = static_cast<char*> (mr_->allocate (new_len + 1, 1));
+      if (s == nullptr)
+        {
+          errno = ENOSPC;
+          return -1;
+        }
+      std::memcpy (s, new_name, new_len);
+      s[new_len] = '\0';
+
+      if (dst != nullptr)
+        {
+          remove (dst);
+        }
+
+      detach (src);
+      mr_->deallocate (src->name_, src->name_length_ + 1, 1);
+      src->name_ = s;
+      src->name_length_ = new_len;
+      attach (src, new_parent);
+      src->ctime_ = time (nullptr);
+
+      return 0;
+    }
+
+    int
+    tmpfs_file_system_impl::do_unlink (const char* path)
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_file_system_impl::%s(\"%s\") @%p\n", __func__,
+                     path, this);
+#endif
+
+      node* parent;
+      const char* name;
+      std::size_t len;
+      node* n = resolve (path, &parent, &name, &len);
+      if (n == nullptr)
+        {
+          return -1;
+        }
+      if (S_ISDIR(n->mode_))
+        {
+          errno = EISDIR;
+          return -1;
+        }
+
+      remove (n);
+
+      return 0;
+    }
+
+    int
+    tmpfs_file_system_impl::do_utime (const char* path,
+                                      const struct utimbuf* times)
+    {
+      node* parent;
+      const char* name;
+      std::size_t len;
+      node* n = resolve (path, &parent, &name, &len);
+      if (n == nullptr)
+        {
+          return -1;
+        }
+
+      if (times != nullptr)
+        {
+          n->atime_ = times->actime;
+          n->mtime_ = times->modtime;
+        }
+      else
+        {
+          n->atime_ = n->mtime_ = time (nullptr);
+        }
+
+      return 0;
+    }
+
+    /**
+     * @details
+     * Without a limit, the free space is the free space of
+     * the memory resource.
+     */
+    int
+    tmpfs_file_system_impl::do_statvfs (struct statvfs* buf)
+    {
+      std::memset (buf, 0, sizeof(struct statvfs));
+
+      std::size_t used = used_bytes_ / page_size;
+      std::size_t total;
+      if (max_bytes_ != 0)
+        {
+          total = max_bytes_ / page_size;
+        }
+      else
+        {
+          total = used + mr_->free_bytes () / page_size;
+        }
+
+      buf->f_bsize = page_size;
+      buf->f_frsize = page_size;
+      buf->f_blocks = static_cast<fsblkcnt_t> (total);
+      buf->f_bfree = static_cast<fsblkcnt_t> (total > used ? total - used : 0);
+      buf->f_bavail = buf->f_bfree;
+      buf->f_files = static_cast<fsfilcnt_t> (num_nodes_ + 1);
+      buf->f_namemax = tmpfs_name_max;
+
+      return 0;
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * The parent is mixed in the hash, so the same name in
+     * different directories goes to different buckets.
+     */
+    std::size_t
+    tmpfs_file_system_impl::hash (const node* parent, const char* name,
+                                  std::size_t len) const
+    {
+      return hash_name (name, len)
+          ^ (reinterpret_cast<uintptr_t> (parent) >> 3);
+    }
+
+    tmpfs_file_system_impl::node*
+    tmpfs_file_system_impl::lookup (const node* parent, const char* name,
+                                    std::size_t len) const
+    {
+      if (hash_table_ == nullptr)
+        {
+          return nullptr;
+        }
+
+      std::size_t h = hash (parent, name, len);
+      node* n = hash_table_[h & (hash_size_ - 1)];
+      while (n != nullptr)
+        {
+          if (n->hash_ == h && n->parent_ == parent && n->name_length_ == len
+              && std::memcmp (n->name_, name, len) == 0)
+            {
+              return n;
+            }
+          n = n->hash_next_;
+        }
+      return nullptr;
+    }
+
+    /**
+     * @details
+     * Returns the node of the path, or `nullptr` and `errno`.
+     *
+     * The parent directory and the last name of the path are
+     * returned even if the last name is not found, so it can
+     * be created. For the root, `.` and `..` the parent is `nullptr`,
+     * since they can be neither created nor removed;
+     * the same when an intermediate directory is missing.
+     *
+     * A regular file followed by a slash is not found,
+     * with `ENOTDIR`.
+     */
+    tmpfs_file_system_impl::node*
+    tmpfs_file_system_impl::resolve (const char* path, node** parent,
+                                     const char** name, std::size_t* len)
+    {
+      *parent = nullptr;
+      *name = nullptr;
+      *len = 0;
+
+      node* n = &root_;
+      const char* p = path;
+      while (true)
+        {
+          while (*p == '/')
+            {
+              ++p;
+            }
+          if (*p == '\0')
+            {
+              return n;
+            }
+
+          const char* c = p;
+          while (*p != '\0' && *p != '/')
+            {
+              ++p;
+            }
+          std::size_t l = static_cast<std::size_t> (p - c);
+
+          *parent = nullptr;
+          if (!S_ISDIR(n->mode_))
+            {
+              errno = ENOTDIR;
+              return nullptr;
+            }
+
+          if (c[0] == '.' && l == 1)
+            {
+              continue;
+            }
+          if (c[0] == '.' && l == 2 && c[1] == '.')
+            {
+              if (n->parent_ != nullptr)
+                {
+                  n = n->parent_;
+                }
+              continue;
+            }
+          if (l > tmpfs_name_max)
+            {
+              errno = ENAMETOOLONG;
+              return nullptr;
+            }
+
+          node* child = lookup (n, c, l);
+          if (child == nullptr)
+            {
+              errno = ENOENT;
+              while (*p == '/')
+                {
+                  ++p;
+                }
+              if (*p == '\0')
+                {
+                  // Only the last name is missing.
+                  *parent = n;
+                  *name = c;
+                  *len = l;
+                }
+              return nullptr;
+            }
+
+          if (*p == '/' && !S_ISDIR(child->mode_))
+            {
+              // Followed by more names, or by a trailing slash.
+              errno = ENOTDIR;
+              return nullptr;
+            }
+
+          *parent = n;
+          *name = c;
+          *len = l;
+          n = child;
+        }
+    }
+
+    tmpfs_file_system_impl::node*
+    tmpfs_file_system_impl::create (node* parent, const char* name,
+                                    std::size_t len, mode_t mode)
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_file_system_impl::%s(\"%.*s\", 0%o) @%p\n",
+                     __func__, len, name, mode, this);
+#endif
+
+      if (hash_table_ == nullptr)
+        {
+          grow_hash_table ();
+          if (hash_table_ == nullptr)
+            {
+              errno = ENOSPC;
+              return nullptr;
+            }
+        }
+
+      void* p = mr_->allocate (sizeof(node), alignof(node));
+      if (p == nullptr)
+        {
+          errno = ENOSPC;
+          return nullptr;
+        }
+      char* s = static_cast<char*> (mr_->allocate (len + 1, 1));
+      if (s == nullptr)
+        {
+          mr_->deallocate (p, sizeof(node), alignof(node));
+          errno = ENOSPC;
+          return nullptr;
+        }
+      std::memcpy (s, name, len);
+      s[len] = '\0';
+
+      node* n = new (p) node;
+      n->name_ = s;
+      n->name_length_ = len;
+      n->mode_ = mode;
+      n->ino_ = next_ino_++;
+      n->atime_ = n->mtime_ = n->ctime_ = time (nullptr);
+
+      attach (n, parent);
+
+      return n;
+    }
+
+    void
+    tmpfs_file_system_impl::attach (node* n, node* parent)
+    {
+      n->parent_ = parent;
+      n->hash_ = hash (parent, n->name_, n->name_length_);
+
+      std::size_t b = n->hash_ & (hash_size_ - 1);
+      n->hash_next_ = hash_table_[b];
+      hash_table_[b] = n;
+
+      // Append, to keep the position of the open directory streams.
+      n->seq_ = parent->next_seq_++;
+      n->next_sibling_ = nullptr;
+      n->prev_sibling_ = parent->last_child_;
+      if (parent->last_child_ != nullptr)
+        {
+          parent->last_child_->next_sibling_ = n;
+        }
+      else
+        {
+          parent->first_child_ = n;
+        }
+      parent->last_child_ = n;
+      ++parent->num_children_;
+      parent->mtime_ = parent->ctime_ = time (nullptr);
+
+      ++num_nodes_;
+      if (num_nodes_ > 2 * hash_size_)
+        {
+          // If this fails, the old table is still usable.
+          grow_hash_table ();
+        }
+    }
+
+    void
+    tmpfs_file_system_impl::detach (node* n)
+    {
+      node** pp = &hash_table_[n->hash_ & (hash_size_ - 1)];
+      while (*pp != nullptr)
+        {
+          if (*pp == n)
+            {
+              *pp = n->hash_next_;
+              break;
+            }
+          pp = &((*pp)->hash_next_);
+        }
+      n->hash_next_ = nullptr;
+
+      node* parent = n->parent_;
+      if (n->prev_sibling_ != nullptr)
+        {
+          n->prev_sibling_->next_sibling_ = n->next_sibling_;
+        }
+      else
+        {
+          parent->first_child_ = n->next_sibling_;
+        }
+      if (n->next_sibling_ != nullptr)
+        {
+          n->next_sibling_->prev_sibling_ = n->prev_sibling_;
+        }
+      else
+        {
+          parent->last_child_ = n->prev_sibling_;
+        }
+      n->next_sibling_ = nullptr;
+      n->prev_sibling_ = nullptr;
+
+      --parent->num_children_;
+      // Open directory streams must find their position again.
+      ++parent->generation_;
+      parent->mtime_ = parent->ctime_ = time (nullptr);
+
+      n->parent_ = nullptr;
+      --num_nodes_;
+    }
+
+    void
+    tmpfs_file_system_impl::remove (node* n)
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_file_system_impl::%s(\"%s\") @%p\n", __func__,
+                     n->name_, this);
+#endif
+
+      detach (n);
+      if (n->open_count_ > 0)
+        {
+          // Released by the last close.
+          n->removed_ = true;
+        }
+      else
+        {
+          release (n);
+        }
+    }
+
+    void
+    tmpfs_file_system_impl::release (node* n)
+    {
+      resize (n, 0);
+      mr_->deallocate (n->name_, n->name_length_ + 1, 1);
+
+      n->~node ();
+      mr_->deallocate (n, sizeof(node), alignof(node));
+    }
+
+    void
+    tmpfs_file_system_impl::remove_all (node* dir)
+    {
+      while (dir->first_child_ != nullptr)
+        {
+          node* n = dir->first_child_;
+          if (S_ISDIR(n->mode_))
+            {
+              remove_all (n);
+            }
+          remove (n);
+        }
+    }
+
+    void
+    tmpfs_file_system_impl::grow_hash_table (void)
+    {
+      std::size_t size =
+          (hash_size_ != 0) ? 2 * hash_size_ : OS_INTEGER_POSIX_IO_TMPFS_BUCKETS;
+
+      node** table = static_cast<node**> (mr_->allocate (size * sizeof(node*),
+                                                         alignof(node*)));
+      if (table == nullptr)
+        {
+          return;
+        }
+      for (std::size_t i = 0; i < size; ++i)
+        {
+          table[i] = nullptr;
+        }
+
+      for (std::size_t i = 0; i < hash_size_; ++i)
+        {
+          node* n = hash_table_[i];
+          while (n != nullptr)
+            {
+              node* next = n->hash_next_;
+              std::size_t b = n->hash_ & (size - 1);
+              n->hash_next_ = table[b];
+              table[b] = n;
+              n = next;
+            }
+        }
+
+      if (hash_table_ != nullptr)
+        {
+          mr_->deallocate (hash_table_, hash_size_ * sizeof(node*),
+                           alignof(node*));
+        }
+      hash_table_ = table;
+      hash_size_ = size;
+    }
+
+    /**
+     * @details
+     * Extending a file only changes its size; the pages
+     * are allocated when written. Shrinking it releases
+     * the pages past the end, and clears the rest of
+     * the last page, which may be read again if the file
+     * is extended later.
+     */
+    int
+    tmpfs_file_system_impl::resize (node* n, off_t length)
+    {
+      // The length was validated as not negative.
+      std::size_t len = static_cast<std::size_t> (length);
+      std::size_t needed = (len + page_size - 1) / page_size;
+
+      for (std::size_t i = needed; i < n->num_pages_; ++i)
+        {
+          if (n->pages_[i] != nullptr)
+            {
+              mr_->deallocate (n->pages_[i], page_size, 1);
+              n->pages_[i] = nullptr;
+              used_bytes_ -= page_size;
+            }
+        }
+
+      std::size_t tail = len % page_size;
+      if (tail != 0 && needed <= n->num_pages_
+          && n->pages_[needed - 1] != nullptr)
+        {
+          std::memset (n->pages_[needed - 1] + tail, 0, page_size - tail);
+        }
+
+      if (length == 0 && n->pages_ != nullptr)
+        {
+          mr_->deallocate (n->pages_, n->num_pages_ * sizeof(uint8_t*),
+                           alignof(uint8_t*));
+          n->pages_ = nullptr;
+          n->num_pages_ = 0;
+        }
+
+      if (n->size_ != length)
+        {
+          n->size_ = length;
+          n->mtime_ = n->ctime_ = time (nullptr);
+        }
+
+      return 0;
+    }
+
+    /**
+     * @details
+     * Pages never written (holes) read as zeroes.
+     */
+    ssize_t
+    tmpfs_file_system_impl::read_data (node* n, void* buf, std::size_t nbyte,
+                                       off_t offset)
+    {
+      if (offset >= n->size_)
+        {
+          return 0;
+        }
+      std::size_t avail = static_cast<std::size_t> (n->size_ - offset);
+      if (nbyte > avail)
+        {
+          nbyte = avail;
+        }
+
+      uint8_t* p = static_cast<uint8_t*> (buf);
+      std::size_t done = 0;
+      while (done < nbyte)
+        {
+          std::size_t pos = static_cast<std::size_t> (offset) + done;
+          std::size_t pg = pos / page_size;
+          std::size_t in = pos % page_size;
+          std::size_t chunk = page_size - in;
+          if (chunk > nbyte - done)
+            {
+              chunk = nbyte - done;
+            }
+
+          if (pg < n->num_pages_ && n->pages_[pg] != nullptr)
+            {
+              std::memcpy (p + done, n->pages_[pg] + in, chunk);
+            }
+          else
+            {
+              std::memset (p + done, 0, chunk);
+            }
+          done += chunk;
+        }
+
+      n->atime_ = time (nullptr);
+
+      return static_cast<ssize_t> (done);
+    }
+
+    /**
+     * @details
+     * If there is no space for all data, as much as possible
+     * is written; if nothing can be written, the error is `ENOSPC`.
+     */
+    ssize_t
+    tmpfs_file_system_impl::write_data (node* n, const void* buf,
+                                        std::size_t nbyte, off_t offset)
+    {
+      if (nbyte == 0)
+        {
+          return 0;
+        }
+
+      std::size_t last = (static_cast<std::size_t> (offset) + nbyte - 1)
+          / page_size;
+      if (last >= n->num_pages_)
+        {
+          // Grow the page table, by doubling.
+          std::size_t num = (n->num_pages_ != 0) ? n->num_pages_ : 4;
+          while (num <= last)
+            {
+              num *= 2;
+            }
+
+          uint8_t** pages = static_cast<uint8_t**> (mr_->allocate (
+              num * sizeof(uint8_t*), alignof(uint8_t*)));
+          if (pages == nullptr)
+            {
+              errno = ENOSPC;
+              return -1;
+            }
+          for (std::size_t i = 0; i < num; ++i)
+            {
+              pages[i] = (i < n->num_pages_) ? n->pages_[i] : nullptr;
+            }
+          if (n->pages_ != nullptr)
+            {
+              mr_->deallocate (n->pages_, n->num_pages_ * sizeof(uint8_t*),
+                               alignof(uint8_t*));
+            }
+          n->pages_ = pages;
+          n->num_pages_ = num;
+        }
+
+      const uint8_t* p = static_cast<const uint8_t*> (buf);
+      std::size_t done = 0;
+      while (done < nbyte)
+        {
+          std::size_t pos = static_cast<std::size_t> (offset) + done;
+          std::size_t pg = pos / page_size;
+          std::size_t in = pos % page_size;
+          std::size_t chunk = page_size - in;
+          if (chunk > nbyte - done)
+            {
+              chunk = nbyte - done;
+            }
+
+          if (n->pages_[pg] == nullptr)
+            {
+              if (max_bytes_ != 0 && used_bytes_ + page_size > max_bytes_)
+                {
+                  break;
+                }
+              void* page = mr_->allocate (page_size, 1);
+              if (page == nullptr)
+                {
+                  break;
+                }
+              std::memset (page, 0, page_size);
+              n->pages_[pg] = static_cast<uint8_t*> (page);
+              used_bytes_ += page_size;
+            }
+
+          std::memcpy (n->pages_[pg] + in, p + done, chunk);
+          done += chunk;
+        }
+
+      if (done == 0)
+        {
+          errno = ENOSPC;
+          return -1;
+        }
+
+      if (offset + static_cast<off_t> (done) > n->size_)
+        {
+          n->size_ = offset + static_cast<off_t> (done);
+        }
+      n->mtime_ = n->ctime_ = time (nullptr);
+
+      return static_cast<ssize_t> (done);
+    }
+
+    void
+    tmpfs_file_system_impl::fill_stat (const node* n, struct stat* buf) const
+    {
+      std::memset (buf, 0, sizeof(struct stat));
+
+      std::size_t pages = 0;
+      for (std::size_t i = 0; i < n->num_pages_; ++i)
+        {
+          if (n->pages_[i] != nullptr)
+            {
+              ++pages;
+            }
+        }
+
+      // Directories are also linked from their `.` entry and
+      // from the `..` entry of each subdirectory.
+      std::size_t links = 1;
+      if (S_ISDIR(n->mode_))
+        {
+          ++links;
+          for (const node* c = n->first_child_; c != nullptr;
+              c = c->next_sibling_)
+            {
+              if (S_ISDIR(c->mode_))
+                {
+                  ++links;
+                }
+            }
+        }
+
+      buf->st_ino = n->ino_;
+      buf->st_mode = n->mode_;
+      buf->st_nlink = static_cast<nlink_t> (links);
+      buf->st_size = n->size_;
+      buf->st_atime = n->atime_;
+      buf->st_mtime = n->mtime_;
+      buf->st_ctime = n->ctime_;
+      buf->st_blksize = page_size;
+      // In 512 bytes units.
+      buf->st_blocks = static_cast<decltype(buf->st_blocks)> (pages * page_size
+          / 512);
+    }
+
+    void
+    tmpfs_file_system_impl::open_node (node* n)
+    {
+      ++n->open_count_;
+    }
+
+    void
+    tmpfs_file_system_impl::close_node (node* n)
+    {
+      --n->open_count_;
+      if (n->open_count_ == 0 && n->removed_)
+        {
+          release (n);
+        }
+    }
+
+    // ========================================================================
+
+    tmpfs_file_impl::tmpfs_file_impl (class file_system& fs) :
+        file_impl
+          { fs }
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_file_impl::%s()=@%p\n", __func__, this);
+#endif
+    }
+
+    tmpfs_file_impl::~tmpfs_file_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_file_impl::%s() @%p\n", __func__, this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    bool
+    tmpfs_file_impl::do_is_opened (void)
+    {
+      return (node_ != nullptr);
+    }
+
+    ssize_t
+    tmpfs_file_impl::do_read (void* buf, std::size_t nbyte)
+    {
+      return do_pread (buf, nbyte, offset_);
+    }
+
+    /**
+     * @details
+     * With `O_APPEND` the data goes to the end of the file,
+     * even if it was extended through other descriptors.
+     */
+    ssize_t
+    tmpfs_file_impl::do_write (const void* buf, std::size_t nbyte)
+    {
+      if ((oflag_ & O_APPEND) != 0)
+        {
+          offset_ = node_->size_;
+        }
+      return do_pwrite (buf, nbyte, offset_);
+    }
+
+    ssize_t
+    tmpfs_file_impl::do_readv (const struct iovec* iov, int iovcnt)
+    {
+      return do_preadv (iov, iovcnt, offset_);
+    }
+
+    ssize_t
+    tmpfs_file_impl::do_writev (const struct iovec* iov, int iovcnt)
+    {
+      if ((oflag_ & O_APPEND) != 0)
+        {
+          offset_ = node_->size_;
+        }
+      return do_pwritev (iov, iovcnt, offset_);
+    }
+
+    ssize_t
+    tmpfs_file_impl::do_pread (void* buf, std::size_t nbyte, off_t offset)
+    {
+      if ((oflag_ & O_ACCMODE) == O_WRONLY)
+        {
+          errno = EBADF;
+          return -1;
+        }
+      if (offset < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      return fs_impl ().read_data (node_, buf, nbyte, offset);
+    }
+
+    ssize_t
+    tmpfs_file_impl::do_pwrite (const void* buf, std::size_t nbyte,
+                                off_t offset)
+    {
+      if ((oflag_ & O_ACCMODE) == O_RDONLY)
+        {
+          errno = EBADF;
+          return -1;
+        }
+      if (offset < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      return fs_impl ().write_data (node_, buf, nbyte, offset);
+    }
+
+    ssize_t
+    tmpfs_file_impl::do_preadv (const struct iovec* iov, int iovcnt,
+                                off_t offset)
+    {
+      if ((oflag_ & O_ACCMODE) == O_WRONLY)
+        {
+          errno = EBADF;
+          return -1;
+        }
+      if (offset < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      ssize_t total = 0;
+      for (int i = 0; i < iovcnt; ++i)
+        {
+          ssize_t ret = fs_impl ().read_data (node_, iov[i].iov_base,
+                                              iov[i].iov_len, offset + total);
+          total += ret;
+          if (static_cast<std::size_t> (ret) < iov[i].iov_len)
+            {
+              break;
+            }
+        }
+      return total;
+    }
+
+    ssize_t
+    tmpfs_file_impl::do_pwritev (const struct iovec* iov, int iovcnt,
+                                 off_t offset)
+    {
+      if ((oflag_ & O_ACCMODE) == O_RDONLY)
+        {
+          errno = EBADF;
+          return -1;
+        }
+      if (offset < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      ssize_t total = 0;
+      for (int i = 0; i < iovcnt; ++i)
+        {
+          ssize_t ret = fs_impl ().write_data (node_, iov[i].iov_base,
+                                               iov[i].iov_len, offset + total);
+          if (ret < 0)
+            {
+              return (total > 0) ? total : -1;
+            }
+          total += ret;
+          if (static_cast<std::size_t> (ret) < iov[i].iov_len)
+            {
+              break;
+            }
+        }
+      return total;
+    }
+
+    int
+    tmpfs_file_impl::do_fstat (struct stat* buf)
+    {
+      fs_impl ().fill_stat (node_, buf);
+      return 0;
+    }
+
+    off_t
+    tmpfs_file_impl::do_lseek (off_t offset, int whence)
+    {
+      off_t pos;
+      switch (whence)
+        {
+        case SEEK_SET:
+          pos = offset;
+          break;
+
+        case SEEK_CUR:
+          pos = offset_ + offset;
+          break;
+
+        case SEEK_END:
+          pos = node_->size_ + offset;
+          break;
+
+        default:
+          errno = EINVAL;
+          return -1;
+        }
+
+      if (pos < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      offset_ = pos;
+      return pos;
+    }
+
+    int
+    tmpfs_file_impl::do_ftruncate (off_t length)
+    {
+      if ((oflag_ & O_ACCMODE) == O_RDONLY || length < 0)
+        {
+          errno = EINVAL;
+          return -1;
+        }
+
+      return fs_impl ().resize (node_, length);
+    }
+
+    int
+    tmpfs_file_impl::do_fsync (void)
+    {
+      return 0;
+    }
+
+    int
+    tmpfs_file_impl::do_close (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_file_impl::%s() @%p\n", __func__, this);
+#endif
+
+      fs_impl ().close_node (node_);
+      node_ = nullptr;
+
+      return 0;
+    }
+
+    // ========================================================================
+
+    tmpfs_directory_impl::tmpfs_directory_impl (class file_system& fs) :
+        directory_impl
+          { fs }
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_directory_impl::%s()=@%p\n", __func__, this);
+#endif
+    }
+
+    tmpfs_directory_impl::~tmpfs_directory_impl ()
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_directory_impl::%s() @%p\n", __func__, this);
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+
+    /**
+     * @details
+     * If entries were removed since the previous call, the
+     * one remembered may no longer exist, and the next entry
+     * is found again by its sequence number; the entries
+     * not removed are neither skipped nor returned twice.
+     */
+    struct dirent*
+    tmpfs_directory_impl::do_read (void)
+    {
+      if (generation_ != node_->generation_)
+        {
+          next_ = node_->first_child_;
+          while (next_ != nullptr && next_->seq_ <= last_seq_)
+            {
+              next_ = next_->next_sibling_;
+            }
+          generation_ = node_->generation_;
+        }
+
+      if (next_ == nullptr)
+        {
+          // End of directory, errno not changed.
+          return nullptr;
+        }
+
+      std::memcpy (dir_entry_.d_name, next_->name_, next_->name_length_ + 1);
+      dir_entry_.d_ino = next_->ino_;
+
+      last_seq_ = next_->seq_;
+      next_ = next_->next_sibling_;
+
+      return &dir_entry_;
+    }
+
+    void
+    tmpfs_directory_impl::do_rewind (void)
+    {
+      next_ = node_->first_child_;
+      last_seq_ = 0;
+      generation_ = node_->generation_;
+    }
+
+    int
+    tmpfs_directory_impl::do_close (void)
+    {
+#if defined(OS_TRACE_POSIX_IO_TMPFS)
+      trace::printf ("tmpfs_directory_impl::%s() @%p\n", __func__, this);
+#endif
+
+      fs_impl ().close_node (node_);
+      node_ = nullptr;
+
+      return 0;
+    }
+
+  // ==========================================================================
+  } /* namespace posix */
+} /* namespace os */
+
+// ----------------------------------------------------------------------------
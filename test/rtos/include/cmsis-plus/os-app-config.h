@@ -69,6 +69,8 @@
 #define OS_INCLUDE_RTOS_STATISTICS_THREAD_CONTEXT_SWITCHES  (1)
 #define OS_INCLUDE_RTOS_STATISTICS_THREAD_CPU_CYCLES        (1)
 
+#define OS_INCLUDE_POSIX_IO_STATISTICS                      (1)
+
 // ----------------------------------------------------------------------------
 
 #if defined(USE_FREERTOS)
@@ -131,14 +133,19 @@
 #define OS_TRACE_POSIX_IO_CHAR_DEVICE
 #define OS_TRACE_POSIX_IO_BLOCK_DEVICE
 #define OS_TRACE_POSIX_IO_BLOCK_DEVICE_PARTITION
+#define OS_TRACE_POSIX_IO_BLOCK_DEVICE_RAM
+#define OS_TRACE_POSIX_IO_DENTRY_CACHE
 #define OS_TRACE_POSIX_IO_DIRECTORY
+#define OS_TRACE_POSIX_IO_EVENT_POLL
 #define OS_TRACE_POSIX_IO_FILE
 #define OS_TRACE_POSIX_IO_FILE_DESCRIPTORS_MANAGER
 #define OS_TRACE_POSIX_IO_FILE_SYSTEM
 #define OS_TRACE_POSIX_IO_IO
 #define OS_TRACE_POSIX_IO_NET_INTERFACE
 #define OS_TRACE_POSIX_IO_NET_STACK
+#define OS_TRACE_POSIX_IO_PIPE
 #define OS_TRACE_POSIX_IO_SOCKET
+#define OS_TRACE_POSIX_IO_TMPFS
 #define OS_TRACE_POSIX_IO_TTY
 #define OS_TRACE_POSIX_IO_CHAN_FATFS
 #endif
@@ -65,6 +65,9 @@ extern "C"
     do_write_block (const void* buf, blknum_t blknum, std::size_t nblocks)
         override;
 
+    virtual int
+    do_discard (blknum_t blknum, std::size_t nblocks) override;
+
     virtual int
     do_vioctl (int request, std::va_list args) override;
 
@@ -33,7 +33,29 @@
 #include <cmsis-plus/posix-io/char-device.h>
 #include <cmsis-plus/posix-io/block-device.h>
 #include <cmsis-plus/posix-io/block-device-partition.h>
+#include <cmsis-plus/posix-io/block-device-cache.h>
+#include <cmsis-plus/posix-io/block-device-queue.h>
+#include <cmsis-plus/posix-io/block-device-ram.h>
+#include <cmsis-plus/posix-io/block-device-worker.h>
+#include <cmsis-plus/posix-io/dentry-cache.h>
+#include <cmsis-plus/posix-io/device-registry.h>
+#include <cmsis-plus/posix-io/event-poll.h>
 #include <cmsis-plus/posix-io/file-descriptors-manager.h>
+#include <cmsis-plus/posix-io/net-interface.h>
+#include <cmsis-plus/posix-io/net-stack.h>
+#include <cmsis-plus/posix-io/pipe.h>
+#include <cmsis-plus/posix-io/shared-locker.h>
+#include <cmsis-plus/posix-io/socket.h>
+#include <cmsis-plus/posix-io/tmpfs.h>
+
+#include <cmsis-plus/posix-driver/circular-buffer.h>
+#include <cmsis-plus/posix-driver/frame-codec.h>
+#include <cmsis-plus/posix-driver/device-serial-buffered.h>
+
+#include <cmsis-plus/posix/poll.h>
+#include <cmsis-plus/posix/sys/mman.h>
+#include <cmsis-plus/posix/sys/ioctl.h>
+#include <cmsis-plus/posix/sys/uio.h>
 
 #include <stdio.h>
 #include <string.h>
@@ -102,6 +124,9 @@ public:
   virtual int
   do_close (void) override;
 
+  virtual int
+  do_poll (int events) override;
+
 };
 
 #pragma GCC diagnostic pop
@@ -178,6 +203,12 @@ my_char_impl::do_close (void)
   return -1;
 }
 
+int
+my_char_impl::do_poll (int events)
+{
+  return 0;
+}
+
 #pragma GCC diagnostic pop
 
 // ----------------------------------------------------------------------------
@@ -233,6 +264,16 @@ my_block_impl::do_write_block (const void* buf,
   return static_cast<ssize_t> (nblocks);
 }
 
+int
+my_block_impl::do_discard (posix::block_device::blknum_t blknum,
+                           std::size_t nblocks)
+{
+  // Like an erased flash.
+  memset (&arena_[blknum * block_logical_size_bytes_ / sizeof(elem_t)], 0xFF,
+          nblocks * block_logical_size_bytes_);
+  return 0;
+}
+
 int
 my_block_impl::do_vioctl (int request, std::va_list args)
 {
@@ -255,170 +296,2251 @@ my_block_impl::do_close (void)
 
 // ----------------------------------------------------------------------------
 
-#pragma GCC diagnostic push
-#if defined(__clang__)
-#pragma clang diagnostic ignored "-Wexit-time-destructors"
-#pragma clang diagnostic ignored "-Wglobal-constructors"
-#pragma clang diagnostic ignored "-Wweak-template-vtables"
-#endif
+// Simulate a slow device, with a fixed cost for each command.
+class my_slow_block_impl : public my_block_impl
+{
+public:
 
-// Explicit template instantiation.
-template class posix::char_device_implementable<my_char_impl>;
-using my_char = posix::char_device_implementable<my_char_impl>;
+  using my_block_impl::my_block_impl;
 
-static uint8_t cbuf[4];
+  virtual ssize_t
+  do_read_block (void* buf, blknum_t blknum, std::size_t nblocks) override;
 
-static my_char mc
-  { "mc", cbuf, sizeof(cbuf) };
+  virtual ssize_t
+  do_write_block (const void* buf, blknum_t blknum, std::size_t nblocks)
+      override;
+};
 
-static my_char mc2
-  { "mc2", cbuf, sizeof(cbuf), 7 };
+ssize_t
+my_slow_block_impl::do_read_block (void* buf,
+                                   posix::block_device::blknum_t blknum,
+                                   std::size_t nblocks)
+{
+  rtos::sysclock.sleep_for (1);
+  return my_block_impl::do_read_block (buf, blknum, nblocks);
+}
+
+ssize_t
+my_slow_block_impl::do_write_block (const void* buf,
+                                    posix::block_device::blknum_t blknum,
+                                    std::size_t nblocks)
+{
+  rtos::sysclock.sleep_for (1);
+  return my_block_impl::do_write_block (buf, blknum, nblocks);
+}
 
 // ----------------------------------------------------------------------------
 
-// Explicit template instantiation.
-template class posix::block_device_implementable<my_block_impl>;
+// Count the read commands, to check the cache read-ahead.
+class my_counting_block_impl : public my_block_impl
+{
+public:
 
-// Explicit template instantiation.
-template class posix::block_device_lockable<my_block_impl, os::rtos::mutex>;
-using my_block = posix::block_device_lockable<my_block_impl, os::rtos::mutex>;
+  using my_block_impl::my_block_impl;
 
-static os::rtos::mutex mx1
-  { "mx1" };
+  virtual int
+  do_vopen (const char* path, int oflag, std::va_list args) override;
 
-// /dev/mb
-static my_block mb
-  { "mb", mx1, 512u, 512u, 2u + 3u };
+  virtual ssize_t
+  do_read_block (void* buf, blknum_t blknum, std::size_t nblocks) override;
 
-// Explicit template instantiation.
-template class posix::block_device_partition_implementable<>;
-using my_partition1 = posix::block_device_partition_implementable<>;
+  // Applied at the next open, to simulate a media change.
+  std::size_t block_scale = 1;
 
-// /dev/mb1
-static my_partition1 p1
-  { "mb-p1", mb };
+  // If not zero, at most these many blocks are read per call.
+  std::size_t limit_nblocks = 0;
 
-// Explicit template instantiation.
-template class posix::block_device_partition_lockable<
-    posix::block_device_partition_impl, rtos::mutex>;
-using my_partition2 = posix::block_device_partition_lockable<posix::block_device_partition_impl, rtos::mutex>;
+  std::size_t reads = 0;
+  std::size_t max_nblocks = 0;
+};
 
-static rtos::mutex mx2
-  { "mx2" };
+int
+my_counting_block_impl::do_vopen (const char* path, int oflag,
+                                  std::va_list args)
+{
+  // Keep the total size.
+  std::size_t total = num_blocks_ * block_logical_size_bytes_;
+  block_logical_size_bytes_ = 512u * block_scale;
+  block_physical_size_bytes_ = block_logical_size_bytes_;
+  num_blocks_ = total / block_logical_size_bytes_;
 
-// /dev/mb2
-// The mutex is not really needed, but it is used to test the template.
-static my_partition2 p2
-  { "mb-p2", mb, mx2 };
+  return my_block_impl::do_vopen (path, oflag, args);
+}
 
-// ----------
+ssize_t
+my_counting_block_impl::do_read_block (void* buf,
+                                       posix::block_device::blknum_t blknum,
+                                       std::size_t nblocks)
+{
+  ++reads;
+  if (nblocks > max_nblocks)
+    {
+      max_nblocks = nblocks;
+    }
+  if (limit_nblocks != 0 && nblocks > limit_nblocks)
+    {
+      nblocks = limit_nblocks;
+    }
+  return my_block_impl::do_read_block (buf, blknum, nblocks);
+}
 
-// Used to allocate the C file descriptors.
-static posix::file_descriptors_manager fdm
-  { 5 };
+// ----------------------------------------------------------------------------
 
-#pragma GCC diagnostic pop
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
 
-// ----------
+// A serial driver that sends immediately and receives the bytes
+// passed to inject(), which also simulates the interrupts.
+class my_serial : public driver::Serial
+{
+public:
 
-static const char* test_name = "Test POSIX I/O";
+  my_serial () = default;
 
-#pragma GCC diagnostic push
-#if defined(__GNUC__) && !defined(__clang__)
-#pragma GCC diagnostic ignored "-Wunused-but-set-variable"
-#endif
+  // Simulate the reception of bytes, followed by an idle line.
+  void
+  inject (const void* buf, std::size_t nbyte);
 
-int
-test_posix_io_api (bool extra __attribute__((unused)))
-{
-  static uint8_t* buff;
-  buff = new uint8_t[512];
+  driver::serial::Capabilities capa
+    { };
 
-  ssize_t res;
+  uint8_t sent[16];
+  std::size_t sent_count = 0;
 
-  std::size_t bsz = 0;
+  // If set, inject() only stores the bytes; the test signals the events.
+  bool quiet = false;
 
-  printf ("\n%s - Block device partitions - C++ API.\n", test_name);
-    {
-      posix::block_device::blknum_t bks = 0;
+protected:
 
-      // The number of blocks is known only after open().
-      res = mb.open ();
-      assert(res >= 0);
+  virtual const driver::Version&
+  do_get_version (void) noexcept override;
 
-      bks = mb.blocks ();
-      bsz = mb.block_logical_size_bytes ();
-      assert(bsz > 0);
+  virtual driver::return_t
+  do_power (driver::Power state) noexcept override;
 
-      res = mb.close ();
-      assert(res >= 0);
+  virtual const driver::serial::Capabilities&
+  do_get_capabilities (void) noexcept override;
 
-      static constexpr std::size_t nr = 3;
+  virtual driver::return_t
+  do_send (const void* data, std::size_t num) noexcept override;
 
-      // p1 is the large one.
-      p1.configure (0, bks - nr);
-      // p2 is small, nr blocks, at the end.
-      p2.configure (bks - nr, nr);
-    }
+  virtual driver::return_t
+  do_receive (void* data, std::size_t num) noexcept override;
 
-  printf ("\n%s - Block device locked - C++ API.\n", test_name);
-    {
-      res = p2.open ();
-      assert(res >= 0);
+  virtual driver::return_t
+  do_transfer (const void* data_out, void* data_in, std::size_t num)
+      noexcept override;
 
-      for (std::size_t i = 0; i < p2.blocks (); ++i)
+  virtual std::size_t
+  do_get_tx_count (void) noexcept override;
+
+  virtual std::size_t
+  do_get_rx_count (void) noexcept override;
+
+  virtual driver::return_t
+  do_configure (driver::serial::config_t cfg, driver::serial::config_arg_t arg)
+      noexcept override;
+
+  virtual driver::return_t
+  do_control (driver::serial::control_t ctrl) noexcept override;
+
+  virtual driver::serial::Status&
+  do_get_status (void) noexcept override;
+
+  virtual driver::return_t
+  do_control_modem_line (driver::serial::Modem_control ctrl)
+      noexcept override;
+
+  virtual driver::serial::Modem_status&
+  do_get_modem_status (void) noexcept override;
+
+private:
+
+  driver::Version version_
+    { 0x0100, 0x0100 };
+
+  uint8_t* rx_data_ = nullptr;
+  std::size_t rx_num_ = 0;
+  std::size_t rx_count_ = 0;
+  std::size_t tx_count_ = 0;
+  bool rx_circular_ = false;
+};
+
+#pragma GCC diagnostic pop
+
+void
+my_serial::inject (const void* buf, std::size_t nbyte)
+{
+  const uint8_t* p = static_cast<const uint8_t*> (buf);
+  for (std::size_t i = 0; i < nbyte; ++i)
+    {
+      rx_data_[rx_count_++] = p[i];
+      if (rx_count_ == rx_num_)
         {
-          res = p2.read_block (buff, i);
-          assert(res >= 0);
-          buff[0] = static_cast<uint8_t> (i);
-          buff[bsz - 1] = static_cast<uint8_t> (i);
-          res = p2.write_block (buff, i);
-          assert(res >= 0);
+          if (rx_circular_)
+            {
+              rx_count_ = 0;
+            }
+          if (!quiet)
+            {
+              // When not circular, the receiver is re-armed here.
+              signal_event (driver::serial::Event::receive_complete);
+            }
         }
-
-      for (std::size_t i = 0; i < p2.blocks (); ++i)
+      else if (rx_circular_ && rx_count_ == rx_num_ / 2 && !quiet)
         {
-          memset (buff, 0xFF, bsz);
-          res = p2.read_block (buff, i);
-          assert(res >= 0);
-          assert(buff[0] == i);
-          assert(buff[bsz - 1] == i);
+          signal_event (driver::serial::Event::receive_half_complete);
         }
+    }
+  if (!quiet)
+    {
+      signal_event (driver::serial::Event::rx_timeout);
+    }
+}
 
-      res = p2.read_block (buff, p2.blocks ());
-      assert(res == -1);
+const driver::Version&
+my_serial::do_get_version (void) noexcept
+{
+  return version_;
+}
 
-      res = p2.write_block (buff, p2.blocks ());
-      assert(res == -1);
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
 
-      p2.close ();
-    }
+driver::return_t
+my_serial::do_power (driver::Power state) noexcept
+{
+  return driver::RETURN_OK;
+}
 
-  printf ("\n%s - Block device unlocked - C++ API.\n", test_name);
-    {
-      res = p1.open ();
-      assert(res >= 0);
+const driver::serial::Capabilities&
+my_serial::do_get_capabilities (void) noexcept
+{
+  return capa;
+}
 
-      res = p1.close ();
-      assert(res >= 0);
+driver::return_t
+my_serial::do_send (const void* data, std::size_t num) noexcept
+{
+  if (num > sizeof(sent) - sent_count)
+    {
+      num = sizeof(sent) - sent_count;
     }
+  memcpy (sent + sent_count, data, num);
+  sent_count += num;
+  tx_count_ = num;
 
-  printf ("\n%s - Block device - intermixed opens - C++ API.\n", test_name);
+  return driver::RETURN_OK;
+}
+
+driver::return_t
+my_serial::do_receive (void* data, std::size_t num) noexcept
+{
+  rx_data_ = static_cast<uint8_t*> (data);
+  rx_num_ = num;
+  rx_count_ = 0;
+
+  return driver::RETURN_OK;
+}
+
+driver::return_t
+my_serial::do_transfer (const void* data_out, void* data_in,
+                        std::size_t num) noexcept
+{
+  return driver::ERROR_UNSUPPORTED;
+}
+
+std::size_t
+my_serial::do_get_tx_count (void) noexcept
+{
+  return tx_count_;
+}
+
+std::size_t
+my_serial::do_get_rx_count (void) noexcept
+{
+  return rx_count_;
+}
+
+driver::return_t
+my_serial::do_configure (driver::serial::config_t cfg,
+                         driver::serial::config_arg_t arg) noexcept
+{
+  return driver::RETURN_OK;
+}
+
+driver::return_t
+my_serial::do_control (driver::serial::control_t ctrl) noexcept
+{
+  if (ctrl == driver::serial::Control::enable_rx_circular)
     {
-      int res1 = p1.open ();
-      assert(res1 >= 0);
-      int res2 = p2.open ();
-      assert(res2 >= 0);
-      res1 = p1.close ();
-      assert(res1 >= 0);
+      if (!capa.receive_circular)
+        {
+          return driver::ERROR_UNSUPPORTED;
+        }
+      rx_circular_ = true;
+    }
+  else if (ctrl == driver::serial::Control::abort_receive)
+    {
+      rx_circular_ = false;
+    }
+  return driver::RETURN_OK;
+}
 
-      buff[0] = 0xFF;
-      res = p2.read_block (buff, 0);
-      assert(res >= 0);
-      assert(buff[0] == 0);
+driver::serial::Status&
+my_serial::do_get_status (void) noexcept
+{
+  return status_;
+}
 
-      res2 = p2.close ();
-      assert(res2 >= 0);
+driver::return_t
+my_serial::do_control_modem_line (driver::serial::Modem_control ctrl) noexcept
+{
+  return driver::RETURN_OK;
+}
+
+driver::serial::Modem_status&
+my_serial::do_get_modem_status (void) noexcept
+{
+  return modem_status_;
+}
+
+#pragma GCC diagnostic pop
+
+// ----------------------------------------------------------------------------
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpadded"
+
+// A socket that receives the bytes passed to deliver(), possibly
+// from another thread, and is always writable.
+class my_socket_impl : public posix::socket_impl
+{
+public:
+
+  my_socket_impl () = default;
+
+  // Simulate the reception of bytes.
+  void
+  deliver (const void* buf, std::size_t nbyte);
+
+  virtual bool
+  do_is_opened (void) override;
+
+  virtual ssize_t
+  do_read (void* buf, std::size_t nbyte) override;
+
+  virtual ssize_t
+  do_write (const void* buf, std::size_t nbyte) override;
+
+  virtual off_t
+  do_lseek (off_t offset, int whence) override;
+
+  virtual int
+  do_close (void) override;
+
+  virtual int
+  do_poll (int events) override;
+
+  virtual class posix::socket*
+  do_accept (struct sockaddr* address, socklen_t* address_len) override;
+
+  virtual int
+  do_bind (const struct sockaddr* address, socklen_t address_len) override;
+
+  virtual int
+  do_connect (const struct sockaddr* address, socklen_t address_len)
+      override;
+
+  virtual int
+  do_getpeername (struct sockaddr* address, socklen_t* address_len)
+      override;
+
+  virtual int
+  do_getsockname (struct sockaddr* address, socklen_t* address_len)
+      override;
+
+  virtual int
+  do_getsockopt (int level, int option_name, void* option_value,
+                 socklen_t* option_len) override;
+
+  virtual int
+  do_listen (int backlog) override;
+
+  virtual ssize_t
+  do_recv (void* buffer, size_t length, int flags) override;
+
+  virtual ssize_t
+  do_recvfrom (void* buffer, size_t length, int flags,
+               struct sockaddr* address, socklen_t* address_len) override;
+
+  virtual ssize_t
+  do_recvmsg (struct msghdr* message, int flags) override;
+
+  virtual ssize_t
+  do_send (const void* buffer, size_t length, int flags) override;
+
+  virtual ssize_t
+  do_sendmsg (const struct msghdr* message, int flags) override;
+
+  virtual ssize_t
+  do_sendto (const void* message, size_t length, int flags,
+             const struct sockaddr* dest_addr, socklen_t dest_len) override;
+
+  virtual int
+  do_setsockopt (int level, int option_name, const void* option_value,
+                 socklen_t option_len) override;
+
+  virtual int
+  do_shutdown (int how) override;
+
+  virtual int
+  do_sockatmark (void) override;
+
+private:
+
+  uint8_t rx_data_[8];
+  std::size_t rx_count_ = 0;
+};
+
+#pragma GCC diagnostic pop
+
+void
+my_socket_impl::deliver (const void* buf, std::size_t nbyte)
+{
+    {
+      rtos::interrupts::critical_section ics;
+
+      if (nbyte > sizeof(rx_data_) - rx_count_)
+        {
+          nbyte = sizeof(rx_data_) - rx_count_;
+        }
+      memcpy (rx_data_ + rx_count_, buf, nbyte);
+      rx_count_ += nbyte;
+    }
+  notify_readiness ();
+}
+
+bool
+my_socket_impl::do_is_opened (void)
+{
+  return true;
+}
+
+ssize_t
+my_socket_impl::do_read (void* buf, std::size_t nbyte)
+{
+  return do_recv (buf, nbyte, 0);
+}
+
+ssize_t
+my_socket_impl::do_write (const void* buf, std::size_t nbyte)
+{
+  return do_send (buf, nbyte, 0);
+}
+
+int
+my_socket_impl::do_close (void)
+{
+  return 0;
+}
+
+int
+my_socket_impl::do_poll (int events)
+{
+  int ret = 0;
+  if (events & POLLIN)
+    {
+      rtos::interrupts::critical_section ics;
+
+      if (rx_count_ > 0)
+        {
+          ret |= POLLIN;
+        }
+    }
+  if (events & POLLOUT)
+    {
+      ret |= POLLOUT;
+    }
+  return ret;
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+ssize_t
+my_socket_impl::do_recv (void* buffer, size_t length, int flags)
+{
+  rtos::interrupts::critical_section ics;
+
+  if (rx_count_ == 0)
+    {
+      errno = EAGAIN;
+      return -1;
+    }
+  if (length > rx_count_)
+    {
+      length = rx_count_;
+    }
+  memcpy (buffer, rx_data_, length);
+  memmove (rx_data_, rx_data_ + length, rx_count_ - length);
+  rx_count_ -= length;
+  return static_cast<ssize_t> (length);
+}
+
+ssize_t
+my_socket_impl::do_send (const void* buffer, size_t length, int flags)
+{
+  return static_cast<ssize_t> (length);
+}
+
+off_t
+my_socket_impl::do_lseek (off_t offset, int whence)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+class posix::socket*
+my_socket_impl::do_accept (struct sockaddr* address, socklen_t* address_len)
+{
+  errno = ENOSYS; // Not implemented
+  return nullptr;
+}
+
+int
+my_socket_impl::do_bind (const struct sockaddr* address,
+                         socklen_t address_len)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+int
+my_socket_impl::do_connect (const struct sockaddr* address,
+                            socklen_t address_len)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+int
+my_socket_impl::do_getpeername (struct sockaddr* address,
+                                socklen_t* address_len)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+int
+my_socket_impl::do_getsockname (struct sockaddr* address,
+                                socklen_t* address_len)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+int
+my_socket_impl::do_getsockopt (int level, int option_name,
+                               void* option_value, socklen_t* option_len)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+int
+my_socket_impl::do_listen (int backlog)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+ssize_t
+my_socket_impl::do_recvfrom (void* buffer, size_t length, int flags,
+                             struct sockaddr* address, socklen_t* address_len)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+ssize_t
+my_socket_impl::do_recvmsg (struct msghdr* message, int flags)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+ssize_t
+my_socket_impl::do_sendmsg (const struct msghdr* message, int flags)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+ssize_t
+my_socket_impl::do_sendto (const void* message, size_t length, int flags,
+                           const struct sockaddr* dest_addr,
+                           socklen_t dest_len)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+int
+my_socket_impl::do_setsockopt (int level, int option_name,
+                               const void* option_value, socklen_t option_len)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+int
+my_socket_impl::do_shutdown (int how)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+int
+my_socket_impl::do_sockatmark (void)
+{
+  errno = ENOSYS; // Not implemented
+  return -1;
+}
+
+#pragma GCC diagnostic pop
+
+// ----------------------------------------------------------------------------
+
+// The sockets are created directly by the test.
+class my_net_stack_impl : public posix::net_stack_impl
+{
+public:
+
+  using posix::net_stack_impl::net_stack_impl;
+
+  virtual class posix::socket*
+  do_socket (int domain, int type, int protocol) override;
+};
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+
+class posix::socket*
+my_net_stack_impl::do_socket (int domain, int type, int protocol)
+{
+  errno = ENOSYS; // Not implemented
+  return nullptr;
+}
+
+#pragma GCC diagnostic pop
+
+// ----------------------------------------------------------------------------
+
+#pragma GCC diagnostic push
+#if defined(__clang__)
+#pragma clang diagnostic ignored "-Wexit-time-destructors"
+#pragma clang diagnostic ignored "-Wglobal-constructors"
+#pragma clang diagnostic ignored "-Wweak-template-vtables"
+#endif
+
+// Explicit template instantiation.
+template class posix::char_device_implementable<my_char_impl>;
+using my_char = posix::char_device_implementable<my_char_impl>;
+
+static uint8_t cbuf[4];
+
+static my_char mc
+  { "mc", cbuf, sizeof(cbuf) };
+
+static my_char mc2
+  { "mc2", cbuf, sizeof(cbuf), 7 };
+
+// ----------------------------------------------------------------------------
+
+// Explicit template instantiation.
+template class posix::block_device_implementable<my_block_impl>;
+
+// Explicit template instantiation.
+template class posix::block_device_lockable<my_block_impl, os::rtos::mutex>;
+using my_block = posix::block_device_lockable<my_block_impl, os::rtos::mutex>;
+
+static os::rtos::mutex mx1
+  { "mx1" };
+
+// /dev/mb
+static my_block mb
+  { "mb", mx1, 512u, 512u, 2u + 3u };
+
+// Explicit template instantiation.
+template class posix::block_device_partition_implementable<>;
+using my_partition1 = posix::block_device_partition_implementable<>;
+
+// /dev/mb1
+static my_partition1 p1
+  { "mb-p1", mb };
+
+// Explicit template instantiation.
+template class posix::block_device_partition_lockable<
+    posix::block_device_partition_impl, rtos::mutex>;
+using my_partition2 = posix::block_device_partition_lockable<posix::block_device_partition_impl, rtos::mutex>;
+
+static rtos::mutex mx2
+  { "mx2" };
+
+// /dev/mb2
+// The mutex is not really needed, but it is used to test the template.
+static my_partition2 p2
+  { "mb-p2", mb, mx2 };
+
+// Explicit template instantiation.
+template class posix::block_device_cache_implementable<>;
+using my_cache = posix::block_device_cache_implementable<>;
+
+// /dev/mb-c, a 2 buffers cache on top of the entire device.
+static my_cache mc1
+  { "mb-c", mb, 2u };
+
+// Explicit template instantiation.
+template class posix::block_device_implementable<my_counting_block_impl>;
+using my_counting_block = posix::block_device_implementable<
+    my_counting_block_impl>;
+
+// /dev/cbd
+static my_counting_block cbd
+  { "cbd", 512u, 512u, 64u };
+
+// /dev/cbd-c, a 16 buffers cache, up to 8 blocks read ahead.
+static my_cache cbdc
+  { "cbd-c", cbd, 16u };
+
+// Explicit template instantiation.
+template class posix::block_device_implementable<my_slow_block_impl>;
+using my_slow_block = posix::block_device_implementable<my_slow_block_impl>;
+
+// /dev/sb
+static my_slow_block sb
+  { "sb", 512u, 512u, 40u };
+
+// Explicit template instantiation.
+template class posix::block_device_queue_implementable<>;
+using my_queue = posix::block_device_queue_implementable<>;
+
+// /dev/sb-q, up to 16 blocks queued.
+static my_queue sq
+  { "sb-q", sb, 16u };
+
+// Explicit template instantiation.
+template class posix::tty_implementable<
+    posix::device_serial_buffered_impl<rtos::interrupts::critical_section>>;
+using my_serial_device = posix::device_serial_buffered<
+    rtos::interrupts::critical_section>;
+
+static my_serial ser_drv;
+
+static uint8_t ser_rx[16];
+static posix::circular_buffer_bytes ser_rx_buf
+  { ser_rx, sizeof(ser_rx), sizeof(ser_rx) };
+
+// /dev/ser, sending directly from the user buffer.
+static my_serial_device ser
+  { "ser", &ser_drv, &ser_rx_buf, nullptr };
+
+static posix::net_interface_impl net_if_impl;
+
+static posix::net_interface net_if
+  { net_if_impl, "if" };
+
+// Explicit template instantiation.
+template class posix::net_stack_implementable<my_net_stack_impl>;
+using my_net_stack = posix::net_stack_implementable<my_net_stack_impl>;
+
+static my_net_stack net
+  { "net", net_if };
+
+// Explicit template instantiation.
+template class posix::socket_implementable<my_socket_impl>;
+using my_socket = posix::socket_implementable<my_socket_impl>;
+
+// ----------
+
+// Used to allocate the C file descriptors.
+static posix::file_descriptors_manager fdm
+  { 5 };
+
+#pragma GCC diagnostic pop
+
+// ----------
+
+static const char* test_name = "Test POSIX I/O";
+
+#pragma GCC diagnostic push
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wunused-but-set-variable"
+#endif
+
+int
+test_posix_io_api (bool extra __attribute__((unused)))
+{
+  static uint8_t* buff;
+  buff = new uint8_t[512];
+
+  ssize_t res;
+
+  std::size_t bsz = 0;
+
+  printf ("\n%s - Block device partitions - C++ API.\n", test_name);
+    {
+      posix::block_device::blknum_t bks = 0;
+
+      // The number of blocks is known only after open().
+      res = mb.open ();
+      assert(res >= 0);
+
+      bks = mb.blocks ();
+      bsz = mb.block_logical_size_bytes ();
+      assert(bsz > 0);
+
+      res = mb.close ();
+      assert(res >= 0);
+
+      static constexpr std::size_t nr = 3;
+
+      // p1 is the large one.
+      p1.configure (0, bks - nr);
+      // p2 is small, nr blocks, at the end.
+      p2.configure (bks - nr, nr);
+    }
+
+  printf ("\n%s - Block device locked - C++ API.\n", test_name);
+    {
+      res = p2.open ();
+      assert(res >= 0);
+
+      for (std::size_t i = 0; i < p2.blocks (); ++i)
+        {
+          res = p2.read_block (buff, i);
+          assert(res >= 0);
+          buff[0] = static_cast<uint8_t> (i);
+          buff[bsz - 1] = static_cast<uint8_t> (i);
+          res = p2.write_block (buff, i);
+          assert(res >= 0);
+        }
+
+      for (std::size_t i = 0; i < p2.blocks (); ++i)
+        {
+          memset (buff, 0xFF, bsz);
+          res = p2.read_block (buff, i);
+          assert(res >= 0);
+          assert(buff[0] == i);
+          assert(buff[bsz - 1] == i);
+        }
+
+      res = p2.read_block (buff, p2.blocks ());
+      assert(res == -1);
+
+      res = p2.write_block (buff, p2.blocks ());
+      assert(res == -1);
+
+      p2.close ();
+    }
+
+  printf ("\n%s - Block device unlocked - C++ API.\n", test_name);
+    {
+      res = p1.open ();
+      assert(res >= 0);
+
+      res = p1.close ();
+      assert(res >= 0);
+    }
+
+  printf ("\n%s - Block device - intermixed opens - C++ API.\n", test_name);
+    {
+      int res1 = p1.open ();
+      assert(res1 >= 0);
+      int res2 = p2.open ();
+      assert(res2 >= 0);
+      res1 = p1.close ();
+      assert(res1 >= 0);
+
+      buff[0] = 0xFF;
+      res = p2.read_block (buff, 0);
+      assert(res >= 0);
+      assert(buff[0] == 0);
+
+      res2 = p2.close ();
+      assert(res2 >= 0);
+    }
+
+  printf ("\n%s - Block device cache - C++ API.\n", test_name);
+    {
+      res = mc1.open ();
+      assert(res >= 0);
+      assert(mc1.blocks () == mb.blocks ());
+
+      mc1.statistics ().clear ();
+
+      buff[0] = 0x5A;
+      res = mc1.write_block (buff, 0);
+      assert(res >= 0);
+
+      // Still in the cache, not yet written to the device.
+      buff[0] = 0xFF;
+      res = mc1.read_block (buff, 0);
+      assert(res >= 0);
+      assert(buff[0] == 0x5A);
+      assert(mc1.statistics ().hits == 1);
+
+      // Fill the cache with other blocks, to evict the dirty one.
+      res = mc1.read_block (buff, 1);
+      assert(res >= 0);
+      res = mc1.read_block (buff, 2);
+      assert(res >= 0);
+      assert(mc1.statistics ().write_backs == 1);
+
+      buff[0] = 0xFF;
+      res = mb.read_block (buff, 0);
+      assert(res >= 0);
+      assert(buff[0] == 0x5A);
+
+      res = mc1.close ();
+      assert(res >= 0);
+    }
+
+  printf ("\n%s - Block device cache read-ahead - C++ API.\n", test_name);
+    {
+      static uint8_t blk[1024];
+
+      res = cbdc.open ();
+      assert(res >= 0);
+
+      // Sequential single block reads; the parent gets multi-block
+      // reads, larger each time the prefetched blocks are used.
+      std::size_t blknum = 0;
+      std::size_t prev = 0;
+      for (; blknum < 8; ++blknum)
+        {
+          res = cbdc.read_block (blk, blknum);
+          assert(res == 1);
+          assert(cbd.impl ().max_nblocks >= prev);
+          prev = cbd.impl ().max_nblocks;
+        }
+      assert(cbd.impl ().max_nblocks > 2);
+      assert(cbd.impl ().reads < blknum);
+      assert(cbdc.statistics ().read_ahead_hits > 0);
+
+      // A smaller limit shrinks the window.
+      cbdc.read_ahead (2);
+      cbd.impl ().max_nblocks = 0;
+      for (; blknum < 24; ++blknum)
+        {
+          res = cbdc.read_block (blk, blknum);
+          assert(res == 1);
+        }
+      assert(cbd.impl ().max_nblocks > 0 && cbd.impl ().max_nblocks <= 2);
+
+      // Disabled.
+      cbdc.read_ahead (0);
+      cbd.impl ().max_nblocks = 0;
+      for (; blknum < 32; ++blknum)
+        {
+          res = cbdc.read_block (blk, blknum);
+          assert(res == 1);
+        }
+      assert(cbd.impl ().max_nblocks == 1);
+
+      res = cbdc.close ();
+      assert(res >= 0);
+
+      // Reopened with larger blocks, the prefetch buffer must follow.
+      cbd.impl ().block_scale = 2;
+      res = cbdc.open ();
+      assert(res >= 0);
+      assert(cbdc.block_logical_size_bytes () == 1024u);
+
+      cbdc.read_ahead (8);
+      cbd.impl ().max_nblocks = 0;
+      for (blknum = 0; blknum < 16; ++blknum)
+        {
+          res = cbdc.read_block (blk, blknum);
+          assert(res == 1);
+        }
+      assert(cbd.impl ().max_nblocks > 2);
+
+      res = cbdc.close ();
+      assert(res >= 0);
+    }
+
+  printf ("\n%s - Block device scatter/gather - C++ API.\n", test_name);
+    {
+      res = p2.open ();
+      assert(res >= 0);
+
+      static uint8_t other[512];
+
+      // Two separate buffers, written to consecutive blocks.
+      buff[0] = 0x11;
+      other[0] = 0x22;
+      struct iovec iov[2] =
+        {
+          { buff, bsz },
+          { other, bsz } };
+      res = p2.writev_block (iov, 2, 0);
+      assert(res == 2);
+
+      // Read back in the reverse order.
+      iov[0].iov_base = other;
+      iov[1].iov_base = buff;
+      res = p2.readv_block (iov, 2, 0);
+      assert(res == 2);
+      assert(other[0] == 0x11);
+      assert(buff[0] == 0x22);
+
+      // Not an integral number of blocks.
+      iov[0].iov_len = bsz / 2;
+      res = p2.readv_block (iov, 1, 0);
+      assert(res == -1);
+
+      res = p2.close ();
+      assert(res >= 0);
+
+      // Stop at the first short transfer.
+      static uint8_t blks[2 * 512];
+      cbd.impl ().block_scale = 1;
+      cbd.impl ().limit_nblocks = 1;
+      res = cbd.open ();
+      assert(res >= 0);
+
+      iov[0].iov_base = blks;
+      iov[0].iov_len = sizeof(blks);
+      iov[1].iov_base = other;
+      iov[1].iov_len = sizeof(other);
+      res = cbd.readv_block (iov, 2, 0);
+      assert(res == 1);
+
+      cbd.impl ().limit_nblocks = 0;
+      res = cbd.close ();
+      assert(res >= 0);
+    }
+
+  printf ("\n%s - Block device positional I/O - C++ API.\n", test_name);
+    {
+      res = p2.open ();
+      assert(res >= 0);
+
+      buff[0] = 0x44;
+      res = p2.pwrite (buff, bsz, static_cast<off_t> (2 * bsz));
+      assert(res == static_cast<ssize_t> (bsz));
+
+      // The current offset is not changed.
+      off_t off = p2.lseek (0, SEEK_CUR);
+      assert(off == 0);
+
+      buff[0] = 0xFF;
+      struct iovec iov[1] =
+        {
+          { buff, bsz } };
+      res = p2.preadv (iov, 1, static_cast<off_t> (2 * bsz));
+      assert(res == static_cast<ssize_t> (bsz));
+      assert(buff[0] == 0x44);
+
+      res = p2.close ();
+      assert(res >= 0);
+    }
+
+  printf ("\n%s - Block device discard - C++ API.\n", test_name);
+    {
+      res = p2.open ();
+      assert(res >= 0);
+
+      buff[0] = 0x33;
+      res = p2.write_block (buff, 1);
+      assert(res >= 0);
+
+      // The partition offset is applied.
+      res = p2.discard_blocks (1, 1);
+      assert(res == 0);
+      res = mb.read_block (buff, mb.blocks () - p2.blocks () + 1);
+      assert(res >= 0);
+      assert(buff[0] == 0xFF);
+
+      res = p2.discard_blocks (1, p2.blocks ());
+      assert(res == -1);
+
+      uint64_t range[2] =
+        { bsz, bsz };
+      res = p2.ioctl (BLKDISCARD, range);
+      assert(res == 0);
+
+      // Not aligned to the block size.
+      range[1] = bsz / 2;
+      res = p2.ioctl (BLKDISCARD, range);
+      assert(res == -1);
+
+      // The end of the range wraps around.
+      range[1] = UINT64_MAX - bsz + 1;
+      res = p2.ioctl (BLKDISCARD, range);
+      assert(res == -1);
+
+      res = p2.close ();
+      assert(res >= 0);
+    }
+
+  printf ("\n%s - Block device async - C++ API.\n", test_name);
+    {
+      res = mb.open ();
+      assert(res >= 0);
+
+      // Without a worker, the request is completed during the submit.
+      posix::block_device_request rq;
+      buff[0] = 0x3C;
+      res = mb.submit_write_block (rq, buff, 3);
+      assert(res >= 0);
+      assert(rq.done ());
+      assert(rq.wait () == 1);
+
+      // With a worker, the completion is notified via the callback.
+      posix::block_device_worker wrk
+        { "mb-w" };
+      mb.worker (&wrk);
+
+      static volatile int completed;
+      completed = 0;
+      posix::block_device_request rq2
+        { [](posix::block_device_request& req, void* args)
+          {
+            *static_cast<volatile int*>(args) = static_cast<int>(req.result ());
+          }, const_cast<int*> (&completed) };
+
+      buff[0] = 0xFF;
+      res = mb.submit_read_block (rq2, buff, 3);
+      assert(res >= 0);
+      assert(rq2.wait () == 1);
+      assert(completed == 1);
+      assert(buff[0] == 0x3C);
+
+      // The request can be reused once completed.
+      completed = 0;
+      res = mb.submit_read_block (rq2, buff, 3);
+      assert(res >= 0);
+      assert(rq2.wait () == 1);
+      assert(completed == 1);
+
+      // A destroyed worker completes the queued requests.
+      posix::block_device_request rq3;
+        {
+          posix::block_device_worker wrk2
+            { "mb-w2" };
+          mb.worker (&wrk2);
+
+          res = mb.submit_read_block (rq3, buff, 3);
+          assert(res >= 0);
+
+          mb.worker (nullptr);
+        }
+      assert(rq3.done ());
+      assert(rq3.wait () == 1);
+
+      res = mb.close ();
+      assert(res >= 0);
+    }
+
+  printf ("\n%s - Device registry - C++ API.\n", test_name);
+    {
+      using registry = posix::device_registry<posix::device>;
+
+      assert(registry::identify_device ("/dev/mb") == &mb);
+      assert(registry::identify_device ("/dev/mb-p2") == &p2);
+      assert(registry::identify_device ("/dev/none") == nullptr);
+      assert(registry::identify_device ("/mb") == nullptr);
+    }
+
+  printf ("\n%s - File descriptors - C++ API.\n", test_name);
+    {
+      std::size_t used = posix::file_descriptors_manager::used ();
+
+      res = mb.open ();
+      assert(res >= 0);
+      int fd = mb.file_descriptor ();
+      res = sb.open ();
+      assert(res >= 0);
+      assert(sb.file_descriptor () > fd);
+      assert(posix::file_descriptors_manager::used () == used + 2);
+
+      // The lowest available descriptor is reused.
+      res = mb.close ();
+      assert(res >= 0);
+      assert(posix::file_descriptors_manager::used () == used + 1);
+      res = mb.open ();
+      assert(res >= 0);
+      assert(mb.file_descriptor () == fd);
+
+      res = mb.close ();
+      assert(res >= 0);
+      res = sb.close ();
+      assert(res >= 0);
+      assert(posix::file_descriptors_manager::used () == used);
+    }
+
+  printf ("\n%s - Poll - C++ API.\n", test_name);
+    {
+      res = mb.open ();
+      assert(res >= 0);
+
+      // Block devices never block, so they are always ready.
+      struct pollfd fds[2];
+      fds[0].fd = mb.file_descriptor ();
+      fds[0].events = POLLIN | POLLOUT;
+      fds[1].fd = -1; // Ignored.
+      fds[1].events = POLLIN;
+      res = posix::poll (fds, 2, 0);
+      assert(res == 1);
+      assert(fds[0].revents == (POLLIN | POLLOUT));
+      assert(fds[1].revents == 0);
+
+      res = mb.close ();
+      assert(res >= 0);
+
+      // Closed descriptors are reported as invalid.
+      res = posix::poll (fds, 1, 0);
+      assert(res == 1);
+      assert(fds[0].revents == POLLNVAL);
+
+      // Without descriptors, only wait for the timeout.
+      rtos::clock::timestamp_t begin = rtos::sysclock.now ();
+      res = posix::poll (nullptr, 0, 5);
+      assert(res == 0);
+      assert(rtos::sysclock.now () - begin
+          >= rtos::clock_systick::ticks_cast (5000u));
+    }
+
+  printf ("\n%s - Socket poll - C++ API.\n", test_name);
+    {
+      my_socket so
+        { net };
+      int fd = posix::file_descriptors_manager::allocate (&so);
+      assert(fd >= 0);
+
+      // Nothing received, only writable.
+      struct pollfd fds[1];
+      fds[0].fd = fd;
+      fds[0].events = POLLIN | POLLOUT;
+      res = posix::poll (fds, 1, 0);
+      assert(res == 1 && fds[0].revents == POLLOUT);
+
+      // Without data, wait for the timeout.
+      fds[0].events = POLLIN;
+      res = posix::poll (fds, 1, 5);
+      assert(res == 0 && fds[0].revents == 0);
+
+      // Wait until the peer delivers data and notifies.
+      struct peer
+      {
+        static void*
+        run (void* args)
+        {
+          rtos::sysclock.sleep_for (2);
+          static_cast<my_socket*> (args)->impl ().deliver ("abc", 3);
+          return nullptr;
+        }
+      };
+
+      rtos::thread th
+        { "peer", peer::run, &so };
+      res = posix::poll (fds, 1, -1);
+      assert(res == 1 && fds[0].revents == POLLIN);
+      th.join ();
+
+      res = so.recv (buff, 10, 0);
+      assert(res == 3 && memcmp (buff, "abc", 3) == 0);
+
+      res = so.close ();
+      assert(res == 0);
+    }
+
+  printf ("\n%s - Event poll - C++ API.\n", test_name);
+    {
+      res = mb.open ();
+      assert(res >= 0);
+      int fd = mb.file_descriptor ();
+
+      posix::event_poll ep
+        { "ep" };
+      posix::event_poll::event evs[2];
+
+      res = ep.add (fd, POLLIN | posix::event_poll::edge_triggered, &mb);
+      assert(res == 0);
+
+      // Newly added descriptors are checked once.
+      res = ep.wait (evs, 2, 0);
+      assert(res == 1);
+      assert(evs[0].events == POLLIN);
+      assert(evs[0].data == &mb);
+
+      // Edge-triggered, reported again only after a notification.
+      res = ep.wait (evs, 2, 0);
+      assert(res == 0);
+      mb.impl ().notify_readiness ();
+      res = ep.wait (evs, 2, 0);
+      assert(res == 1);
+
+      // Level-triggered, reported while ready.
+      res = ep.modify (fd, POLLOUT, &mb);
+      assert(res == 0);
+      res = ep.wait (evs, 2, 0);
+      assert(res == 1);
+      res = ep.wait (evs, 2, 0);
+      assert(res == 1);
+      assert(evs[0].events == POLLOUT);
+
+      res = ep.remove (fd);
+      assert(res == 0);
+      res = ep.wait (evs, 2, 0);
+      assert(res == 0);
+
+      res = mb.close ();
+      assert(res >= 0);
+    }
+
+  printf ("\n%s - Block device queue - C++ API.\n", test_name);
+    {
+      // A file system like pattern: consecutive data blocks, each
+      // followed by an update of the same allocation table block.
+      static constexpr std::size_t nblks = 32;
+      static constexpr posix::block_device::blknum_t table = 39;
+
+      res = sb.open ();
+      assert(res >= 0);
+
+      rtos::clock::timestamp_t begin = rtos::sysclock.now ();
+      for (std::size_t i = 0; i < nblks; ++i)
+        {
+          buff[0] = static_cast<uint8_t> (i);
+          res = sb.write_block (buff, i);
+          assert(res >= 0);
+          res = sb.write_block (buff, table);
+          assert(res >= 0);
+        }
+      auto direct = static_cast<rtos::clock::duration_t> (rtos::sysclock.now ()
+          - begin);
+
+      res = sq.open ();
+      assert(res >= 0);
+
+      begin = rtos::sysclock.now ();
+      for (std::size_t i = 0; i < nblks; ++i)
+        {
+          buff[0] = static_cast<uint8_t> (i + 1);
+          res = sq.write_block (buff, i);
+          assert(res >= 0);
+          res = sq.write_block (buff, table);
+          assert(res >= 0);
+        }
+      sq.sync ();
+      auto queued = static_cast<rtos::clock::duration_t> (rtos::sysclock.now ()
+          - begin);
+
+      printf ("%u blocks, direct %u ticks, queued %u ticks, %u transfers\n",
+              static_cast<unsigned int> (2 * nblks),
+              static_cast<unsigned int> (direct),
+              static_cast<unsigned int> (queued),
+              static_cast<unsigned int> (sq.statistics ().transfers));
+      assert(queued < direct);
+
+      for (std::size_t i = 0; i < nblks; ++i)
+        {
+          res = sb.read_block (buff, i);
+          assert(res >= 0);
+          assert(buff[0] == i + 1);
+        }
+
+      res = sq.close ();
+      assert(res >= 0);
+      res = sb.close ();
+      assert(res >= 0);
+    }
+
+  printf ("\n%s - Block device RAM - C++ API.\n", test_name);
+    {
+      posix::block_device_ram rd
+        { "rd", 512u, 16u };
+
+      res = rd.open ();
+      assert(res >= 0);
+      assert(rd.blocks () == 16);
+      assert(rd.block_logical_size_bytes () == 512);
+
+      // Starts zeroed.
+      buff[0] = 0xAA;
+      res = rd.read_block (buff, 3);
+      assert(res == 1);
+      assert(buff[0] == 0);
+
+      static uint8_t other[512];
+
+      buff[0] = 0x11;
+      other[0] = 0x22;
+      struct iovec iov[2] =
+        {
+          { buff, 512 },
+          { other, 512 } };
+      res = rd.writev_block (iov, 2, 4);
+      assert(res == 2);
+      res = rd.read_block (buff, 5);
+      assert(res == 1);
+      assert(buff[0] == 0x22);
+
+      // Discarded blocks read back as zeroes.
+      res = rd.discard_blocks (5, 1);
+      assert(res == 0);
+      res = rd.read_block (buff, 5);
+      assert(res == 1);
+      assert(buff[0] == 0);
+
+      // A fixed cost per command.
+      static uint8_t blks[4 * 512];
+      rd.impl ().latency (2, 0);
+      rtos::clock::timestamp_t begin = rtos::sysclock.now ();
+      res = rd.read_block (blks, 0, 4);
+      assert(res == 4);
+      assert(rtos::sysclock.now () - begin >= 2);
+      rd.impl ().latency (0, 0);
+
+      // The content survives a close.
+      res = rd.close ();
+      assert(res >= 0);
+      res = rd.open ();
+      assert(res >= 0);
+      res = rd.read_block (buff, 4);
+      assert(res == 1);
+      assert(buff[0] == 0x11);
+
+      res = rd.close ();
+      assert(res >= 0);
+    }
+
+  printf ("\n%s - Dentry cache - C++ API.\n", test_name);
+    {
+      posix::dentry_cache dc
+        { 2 };
+
+      // Negative and positive entries.
+      assert(dc.lookup ("/missing") == nullptr);
+      dc.insert ("/missing", true);
+      dc.insert ("/dir", false, S_IFDIR, 7);
+      auto* e = dc.lookup ("/missing");
+      assert(e != nullptr && e->negative);
+      e = dc.lookup ("/dir");
+      assert(e != nullptr && !e->negative && e->cookie == 7);
+
+      // Only canonical paths are cached.
+      assert(dc.insert ("/dir/", true) == nullptr);
+      assert(dc.insert ("/dir/../x", true) == nullptr);
+
+      // The least recently used entry is reused.
+      dc.insert ("/dir/file", true);
+      assert(dc.lookup ("/missing") == nullptr);
+      assert(dc.statistics ().evictions == 1);
+
+      // Invalidating a directory drops the entries below it.
+      dc.invalidate ("/dir");
+      assert(dc.lookup ("/dir") == nullptr);
+      assert(dc.lookup ("/dir/file") == nullptr);
+      assert(dc.statistics ().invalidations == 2);
+    }
+
+  printf ("\n%s - Tmpfs - C++ API.\n", test_name);
+    {
+      posix::file_system_implementable<posix::tmpfs_file_system_impl> tmpfs
+        { "tmpfs", nullptr };
+
+      res = tmpfs.mount ("/tmp/");
+      assert(res == 0);
+      assert(!tmpfs.impl ().has_device ());
+
+      posix::io* f = posix::open ("/tmp/a.txt", O_CREAT | O_RDWR, 0644);
+      assert(f != nullptr);
+      res = f->write ("abc", 3);
+      assert(res == 3);
+      assert(f->lseek (0, SEEK_SET) == 0);
+      res = f->read (buff, 10);
+      assert(res == 3);
+      assert(memcmp (buff, "abc", 3) == 0);
+
+      // Holes read as zeroes.
+      res = f->pwrite ("z", 1, 1000);
+      assert(res == 1);
+      res = f->pread (buff, 512, 0);
+      assert(res == 512);
+      assert(buff[2] == 'c' && buff[3] == 0);
+      res = f->pread (buff, 512, 512);
+      assert(res == 489);
+      assert(buff[487] == 0 && buff[488] == 'z');
+      res = f->close ();
+      assert(res == 0);
+
+      res = posix::mkdir ("/tmp/d", 0755);
+      assert(res == 0);
+      res = posix::rename ("/tmp/a.txt", "/tmp/d/b.txt");
+      assert(res == 0);
+
+      struct stat st;
+      res = posix::stat ("/tmp/d/b.txt", &st);
+      assert(res == 0 && st.st_size == 1001);
+      assert(st.st_nlink == 1);
+
+      // A regular file cannot be followed by a slash.
+      res = posix::stat ("/tmp/d/b.txt/", &st);
+      assert(res == -1 && errno == ENOTDIR);
+      f = posix::open ("/tmp/d/b.txt/", O_RDONLY);
+      assert(f == nullptr && errno == ENOTDIR);
+
+      // Directories are linked from each subdirectory.
+      res = posix::stat ("/tmp/d", &st);
+      assert(res == 0 && st.st_nlink == 2);
+      res = posix::mkdir ("/tmp/d/e/", 0755);
+      assert(res == 0);
+      res = posix::stat ("/tmp/d/", &st);
+      assert(res == 0 && st.st_nlink == 3);
+      res = posix::rmdir ("/tmp/d/e");
+      assert(res == 0);
+
+      posix::directory* dir = posix::opendir ("/tmp/d");
+      assert(dir != nullptr);
+      struct dirent* de = dir->read ();
+      assert(de != nullptr && strcmp (de->d_name, "b.txt") == 0);
+      assert(dir->read () == nullptr);
+      res = dir->close ();
+      assert(res == 0);
+
+      res = posix::rmdir ("/tmp/d");
+      assert(res == -1 && errno == ENOTEMPTY);
+      res = posix::unlink ("/tmp/d/b.txt");
+      assert(res == 0);
+      res = posix::stat ("/tmp/d/b.txt", &st);
+      assert(res == -1 && errno == ENOENT);
+      res = posix::rmdir ("/tmp/d");
+      assert(res == 0);
+
+      res = tmpfs.umount ();
+      assert(res == 0);
+    }
+
+  printf ("\n%s - Memory mapping - C++ API.\n", test_name);
+    {
+      posix::block_device_ram rd
+        { "rd", 512u, 8u };
+
+      res = rd.open ();
+      assert(res >= 0);
+
+      // Memory addressable, mapped directly.
+      auto* p = static_cast<uint8_t*> (rd.mmap (1024, PROT_READ, MAP_SHARED,
+                                                512));
+      assert(p != MAP_FAILED);
+      buff[0] = 0x5A;
+      res = rd.write_block (buff, 1);
+      assert(res == 1);
+      assert(p[0] == 0x5A);
+      assert(rd.munmap (p, 4096) == -1 && errno == EINVAL);
+      res = rd.munmap (p, 1024);
+      assert(res == 0);
+
+      assert(rd.mmap (1024, PROT_READ, MAP_SHARED, 7 * 512) == MAP_FAILED);
+      assert(errno == ENXIO);
+
+      res = rd.close ();
+      assert(res >= 0);
+
+      // Files in memory are not contiguous, mapped as a copy.
+      posix::file_system_implementable<posix::tmpfs_file_system_impl> tmpfs
+        { "tmpfs", nullptr };
+
+      res = tmpfs.mount ("/tmp/");
+      assert(res == 0);
+
+      posix::io* f = posix::open ("/tmp/m", O_CREAT | O_RDWR, 0644);
+      assert(f != nullptr);
+      res = f->write ("map", 3);
+      assert(res == 3);
+
+      auto* m = static_cast<char*> (f->mmap (100, PROT_READ, MAP_PRIVATE, 0));
+      assert(m != MAP_FAILED);
+      assert(memcmp (m, "map", 3) == 0 && m[3] == 0);
+
+      // Only the mappings of the object are released.
+      assert(f->munmap (m, 50) == -1 && errno == EINVAL);
+      assert(f->munmap (m + 1, 100) == -1 && errno == EINVAL);
+      res = f->munmap (m, 100);
+      assert(res == 0);
+      assert(f->munmap (m, 100) == -1 && errno == EINVAL);
+
+      // Changes to a copy cannot be shared.
+      assert(f->mmap (100, PROT_WRITE, MAP_SHARED, 0) == MAP_FAILED);
+      assert(errno == ENODEV);
+
+      res = f->close ();
+      assert(res == 0);
+      res = tmpfs.umount ();
+      assert(res == 0);
+    }
+
+  printf ("\n%s - Sendfile - C++ API.\n", test_name);
+    {
+      posix::file_system_implementable<posix::tmpfs_file_system_impl> tmpfs
+        { "tmpfs", nullptr };
+
+      res = tmpfs.mount ("/tmp/");
+      assert(res == 0);
+
+      posix::io* in = posix::open ("/tmp/in", O_CREAT | O_RDWR, 0644);
+      assert(in != nullptr);
+      for (int i = 0; i < 400; ++i)
+        {
+          buff[i] = static_cast<uint8_t> (i);
+        }
+      res = in->write (buff, 400);
+      assert(res == 400);
+
+      posix::io* out = posix::open ("/tmp/out", O_CREAT | O_RDWR, 0644);
+      assert(out != nullptr);
+
+      // From a given position, the source offset is not changed.
+      off_t off = 100;
+      res = out->sendfile (*in, &off, 1000);
+      assert(res == 300);
+      assert(off == 400);
+      assert(in->lseek (0, SEEK_CUR) == 400);
+
+      // From the current position.
+      in->lseek (0, SEEK_SET);
+      res = out->sendfile (*in, nullptr, 50);
+      assert(res == 50);
+      assert(in->lseek (0, SEEK_CUR) == 50);
+
+      // At a given position in the destination.
+      off = 0;
+      off_t out_off = 350;
+      res = out->splice (*in, &off, &out_off, 10);
+      assert(res == 10);
+      assert(out_off == 360);
+      assert(out->lseek (0, SEEK_CUR) == 350);
+
+      memset (buff, 0, 400);
+      res = out->pread (buff, 400, 0);
+      assert(res == 360);
+      assert(buff[0] == 100 && buff[299] == 143);
+      assert(buff[300] == 0 && buff[349] == 49);
+      assert(buff[350] == 0 && buff[359] == 9);
+
+      res = out->close ();
+      assert(res == 0);
+      res = in->close ();
+      assert(res == 0);
+      res = tmpfs.umount ();
+      assert(res == 0);
+    }
+
+  printf ("\n%s - Pipe - C++ API.\n", test_name);
+    {
+      posix::pipe_pool pipes
+        { 1, 64 };
+
+      posix::pipe* ends[2];
+      res = pipes.create (ends, O_NONBLOCK);
+      assert(res == 0);
+
+      // A single pipe in the pool.
+      posix::pipe* more[2];
+      assert(pipes.create (more) == -1);
+      assert(errno == ENFILE);
+
+      res = ends[0]->read (buff, 10);
+      assert(res == -1 && errno == EAGAIN);
+      assert(ends[0]->poll (POLLIN) == 0);
+
+      res = ends[1]->write ("pipe", 4);
+      assert(res == 4);
+      assert(ends[0]->poll (POLLIN) == POLLIN);
+
+      // Peek without copying.
+      const void* p;
+      res = ends[0]->peek (&p);
+      assert(res == 4 && memcmp (p, "pipe", 4) == 0);
+      res = ends[0]->consume (1);
+      assert(res == 1);
+
+      res = ends[0]->read (buff, 10);
+      assert(res == 3 && memcmp (buff, "ipe", 3) == 0);
+
+      // Atomic writes are not split.
+      memset (buff, 'x', 100);
+      res = ends[1]->write (buff, 60);
+      assert(res == 60);
+      res = ends[1]->write (buff, 10);
+      assert(res == -1 && errno == EAGAIN);
+      res = ends[1]->write (buff, 100);
+      assert(res == 4);
+
+      res = ends[0]->read (buff, 100);
+      assert(res == 64);
+
+      // End of file after the write end is closed.
+      res = ends[1]->close ();
+      assert(res == 0);
+      assert(ends[0]->poll (POLLIN) == POLLHUP);
+      res = ends[0]->read (buff, 10);
+      assert(res == 0);
+
+      res = ends[0]->close ();
+      assert(res == 0);
+
+      // Returned to the pool.
+      res = pipes.create (ends);
+      assert(res == 0);
+
+      res = ends[0]->close ();
+      assert(res == 0);
+      res = ends[1]->write ("x", 1);
+      assert(res == -1 && errno == EPIPE);
+      res = ends[1]->close ();
+      assert(res == 0);
+
+      // Splice between pipes, which cannot give back the bytes
+      // read; after a short write, the rest is written again, and
+      // if this fails, the bytes already transferred are returned.
+      posix::pipe_pool small_pipes
+        { 1, 32 };
+      posix::pipe* outs[2];
+      res = small_pipes.create (outs, O_NONBLOCK);
+      assert(res == 0);
+      res = pipes.create (ends, O_NONBLOCK);
+      assert(res == 0);
+
+      memset (buff, 'y', 64);
+      res = ends[1]->write (buff, 48);
+      assert(res == 48);
+      res = outs[1]->splice (*ends[0], nullptr, nullptr, 48);
+      assert(res == 32);
+      res = outs[0]->read (buff, 64);
+      assert(res == 32);
+
+      // Nothing transferred, the error is reported.
+      res = ends[1]->write (buff, 48);
+      assert(res == 48);
+      res = outs[1]->write (buff, 32);
+      assert(res == 32);
+      res = outs[1]->splice (*ends[0], nullptr, nullptr, 48);
+      assert(res == -1 && errno == EAGAIN);
+
+      for (auto pp : { ends[0], ends[1], outs[0], outs[1] })
+        {
+          res = pp->close ();
+          assert(res == 0);
+        }
+    }
+
+  printf ("\n%s - Write buffering - C++ API.\n", test_name);
+    {
+      posix::file_system_implementable<posix::tmpfs_file_system_impl> tmpfs
+        { "tmpfs", nullptr };
+
+      res = tmpfs.mount ("/tmp/");
+      assert(res == 0);
+
+      posix::io* io = posix::open ("/tmp/buf", O_CREAT | O_RDWR, 0644);
+      assert(io != nullptr);
+      posix::io* rd = posix::open ("/tmp/buf", O_RDONLY);
+      assert(rd != nullptr);
+
+      res = io->setvbuf (_IOFBF + _IOLBF + _IONBF, 0);
+      assert(res == -1 && errno == EINVAL);
+
+      struct stat st;
+
+      // Fully buffered, kept until flushed.
+      res = io->setvbuf (_IOFBF, 16);
+      assert(res == 0);
+      res = io->write ("abc", 3);
+      assert(res == 3);
+      res = rd->fstat (&st);
+      assert(res == 0 && st.st_size == 0);
+      res = io->flush ();
+      assert(res == 0);
+      res = io->fstat (&st);
+      assert(res == 0 && st.st_size == 3);
+
+      // Line buffered, written at the end of the line.
+      res = io->setvbuf (_IOLBF, 16);
+      assert(res == 0);
+      res = io->write ("de\n", 3);
+      assert(res == 3);
+      res = rd->fstat (&st);
+      assert(res == 0 && st.st_size == 6);
+
+      // Larger writes are passed directly, after the buffered data.
+      res = io->write ("f", 1);
+      assert(res == 1);
+      memset (buff, 'x', 20);
+      res = io->write (buff, 20);
+      assert(res == 20);
+
+      // Reads see the buffered data.
+      res = io->pread (buff, 100, 0);
+      assert(res == 27 && memcmp (buff, "abcde\nfxx", 9) == 0);
+
+      res = io->write ("gh", 2);
+      assert(res == 2);
+      res = io->close ();
+      assert(res == 0);
+
+      res = rd->fstat (&st);
+      assert(res == 0 && st.st_size == 29);
+      res = rd->close ();
+      assert(res == 0);
+
+      res = tmpfs.umount ();
+      assert(res == 0);
+    }
+
+  printf ("\n%s - Shared locker - C++ API.\n", test_name);
+    {
+      static_assert(!posix::locker_traits<rtos::mutex>::is_shared, "");
+      static_assert(posix::locker_traits<posix::shared_locker>::is_shared,
+          "");
+
+      posix::shared_locker sl;
+
+      // Several shared owners, but no exclusive one.
+      sl.lock_shared ();
+      assert(sl.try_lock_shared ());
+      assert(!sl.try_lock ());
+      sl.unlock_shared ();
+      sl.unlock_shared ();
+
+      // A single exclusive owner.
+      assert(sl.try_lock ());
+      assert(!sl.try_lock_shared ());
+      assert(!sl.try_lock ());
+      sl.unlock ();
+
+        {
+          posix::shared_lock_guard<posix::shared_locker> lock
+            { sl };
+          assert(sl.try_lock_shared ());
+          assert(!sl.try_lock ());
+          sl.unlock_shared ();
+        }
+      assert(sl.try_lock ());
+      sl.unlock ();
+    }
+
+  printf ("\n%s - SPSC circular buffer - C++ API.\n", test_name);
+    {
+      uint8_t storage[8];
+      posix::circular_buffer_spsc_bytes cb
+        { storage, sizeof(storage), 6, 2 };
+
+      assert(cb.empty () && cb.size () == 8);
+
+      res = static_cast<int> (cb.push_back (
+          reinterpret_cast<const uint8_t*> ("abcdef"), 6));
+      assert(res == 6);
+      assert(cb.above_high_water_mark ());
+
+      uint8_t tmp[8];
+      res = static_cast<int> (cb.pop_front (tmp, 4));
+      assert(res == 4 && memcmp (tmp, "abcd", 4) == 0);
+      assert(cb.below_low_water_mark ());
+
+      // Wrap around the end of the storage.
+      res = static_cast<int> (cb.push_back (
+          reinterpret_cast<const uint8_t*> ("ghijklmn"), 8));
+      assert(res == 6);
+      assert(cb.full ());
+      assert(cb.push_back ('x') == 0);
+
+      uint8_t* p;
+      res = static_cast<int> (cb.front_contiguous_buffer (&p));
+      assert(res == 4 && *p == 'e');
+      cb.advance_front (static_cast<std::size_t> (res));
+
+      res = static_cast<int> (cb.back_contiguous_buffer (&p));
+      assert(res == 4);
+      p[0] = 'o';
+      cb.advance_back (1);
+
+      res = static_cast<int> (cb.pop_front (tmp, sizeof(tmp)));
+      assert(res == 5 && memcmp (tmp, "ijklo", 5) == 0);
+      assert(cb.empty ());
+    }
+
+  printf ("\n%s - Frame codecs - C++ API.\n", test_name);
+    {
+      struct frames
+      {
+        std::size_t count;
+        std::size_t len;
+        uint8_t last[304];
+
+        static void
+        handler (void* arg, const uint8_t* frame, std::size_t len)
+        {
+          frames* f = static_cast<frames*> (arg);
+          ++f->count;
+          f->len = len;
+          memcpy (f->last, frame, len);
+        }
+      } fr
+        { 0, 0,
+          { 0 } };
+
+      uint8_t payload[300];
+      for (std::size_t i = 0; i < sizeof(payload); ++i)
+        {
+          payload[i] = static_cast<uint8_t> (i); // Has 0x00, 0xC0, 0xDB.
+        }
+
+      uint8_t fbuf[300];
+      uint8_t enc[700];
+
+      posix::slip_codec slip
+        { fbuf, sizeof(fbuf), frames::handler, &fr };
+      posix::cobs_codec cobs
+        { fbuf, sizeof(fbuf), frames::handler, &fr };
+      posix::length_prefix_codec lp
+        { fbuf, sizeof(fbuf), frames::handler, &fr };
+
+      posix::frame_codec* codecs[] =
+        { &slip, &cobs, &lp };
+      for (auto c : codecs)
+        {
+          std::size_t n = c->encode (payload, sizeof(payload), enc,
+                                     sizeof(enc));
+          assert(n > sizeof(payload));
+          assert(c->encode (payload, sizeof(payload), enc, 10) == 0);
+
+          // Split in two segments, like a wrapped receive buffer.
+          struct iovec iov[2];
+          iov[0].iov_base = enc;
+          iov[0].iov_len = 123;
+          iov[1].iov_base = enc + 123;
+          iov[1].iov_len = n - 123;
+
+          fr.count = 0;
+          assert(c->decode (iov, 2) == 1);
+          assert(fr.count == 1 && fr.len == sizeof(payload));
+          assert(memcmp (fr.last, payload, sizeof(payload)) == 0);
+
+          // Two frames in a single call.
+          n = c->encode ("ab", 2, enc, sizeof(enc));
+          memcpy (enc + n, enc, n);
+          assert(c->decode (enc, 2 * n) == 2);
+          assert(fr.len == 2 && memcmp (fr.last, "ab", 2) == 0);
+
+          // Frames that fail the check are dropped.
+          c->checker ([] (void*, const uint8_t*, std::size_t)
+            { return false;}, nullptr);
+          assert(c->decode (enc, n) == 0);
+          assert(c->errors () == 1);
+          c->checker (nullptr);
+        }
+
+      // Too long for the buffer.
+      posix::slip_codec small
+        { fbuf, 4, frames::handler, &fr };
+      std::size_t n = small.encode ("abcdef", 6, enc, sizeof(enc));
+      assert(small.decode (enc, n - 1) == 0);
+      assert(small.decode (enc + n - 1, 1) == 0);
+      assert(small.errors () == 1);
+      n = small.encode ("abc", 3, enc, sizeof(enc));
+      assert(small.decode (enc, n) == 1);
+    }
+
+#if defined(OS_INCLUDE_POSIX_IO_STATISTICS)
+
+  printf ("\n%s - Statistics - C++ API.\n", test_name);
+    {
+      posix::block_device_ram rd
+        { "rd", 512u, 8u };
+
+      res = rd.open ();
+      assert(res >= 0);
+
+      static uint8_t blks[2 * 512];
+      res = rd.write_block (buff, 1, 1);
+      assert(res == 1);
+      res = rd.read_block (blks, 0, 2);
+      assert(res == 2);
+      res = rd.read_block (blks, 7, 2);
+      assert(res == -1);
+
+      // Invalid requests are not accounted.
+      posix::io_statistics st;
+      res = rd.ioctl (IOSTATGET, &st);
+      assert(res == 0);
+      assert(st.write.ops == 1 && st.write.bytes == 512);
+      assert(st.read.ops == 1 && st.read.bytes == 1024);
+      assert(st.read.errors == 0);
+
+      std::size_t n = 0;
+      for (auto c : st.read.latency)
+        {
+          n += c;
+        }
+      assert(n == 1);
+
+      rd.statistics ().report ("rd");
+
+      res = rd.ioctl (IOSTATCLR);
+      assert(res == 0);
+      assert(rd.statistics ().read.ops == 0);
+
+      res = rd.close ();
+      assert(res == 0);
+
+      posix::file_system_implementable<posix::tmpfs_file_system_impl> tmpfs
+        { "tmpfs", nullptr };
+
+      res = tmpfs.mount ("/tmp/");
+      assert(res == 0);
+
+      posix::io* io = posix::open ("/tmp/st", O_CREAT | O_RDWR, 0644);
+      assert(io != nullptr);
+
+      res = io->write (buff, 100);
+      assert(res == 100);
+      res = io->pread (buff, 100, 50);
+      assert(res == 50);
+
+      assert(io->statistics ().write.bytes == 100);
+      assert(io->statistics ().read.bytes == 50);
+
+      // File transfers are also added to the file system.
+      assert(tmpfs.statistics ().write.bytes == 100);
+      assert(tmpfs.statistics ().read.bytes == 50);
+      assert(tmpfs.statistics ().other.ops == 1);
+
+      tmpfs.statistics ().report ("tmpfs");
+
+      res = io->close ();
+      assert(res == 0);
+      res = tmpfs.umount ();
+      assert(res == 0);
+    }
+
+#endif /* defined(OS_INCLUDE_POSIX_IO_STATISTICS) */
+
+  printf ("\n%s - Buffered serial - C++ API.\n", test_name);
+    {
+      res = ser.open ();
+      assert(res >= 0);
+      assert(ser.isatty () == 1);
+
+      // Writable, nothing to read yet.
+      assert(ser.poll (POLLIN | POLLOUT) == POLLOUT);
+
+      // Return as soon as some bytes are available.
+      ser_drv.inject ("abc", 3);
+      assert(ser.poll (POLLIN | POLLOUT) == (POLLIN | POLLOUT));
+      res = ser.read (buff, 10);
+      assert(res == 3 && memcmp (buff, "abc", 3) == 0);
+
+      // Parse in place, without copying.
+      struct iovec iov[2];
+      ser_drv.inject ("def", 3);
+      res = ser.impl ().rx_peek (iov);
+      assert(res == 3 && iov[0].iov_len == 3 && iov[1].iov_len == 0);
+      assert(memcmp (iov[0].iov_base, "def", 3) == 0);
+      assert(ser.impl ().rx_consume (4) == -1 && errno == EINVAL);
+      assert(ser.impl ().rx_consume (1) == 0);
+      res = ser.read (buff, 10);
+      assert(res == 2 && memcmp (buff, "ef", 2) == 0);
+
+      // Non blocking, set after open.
+      res = ser.fcntl (F_SETFL, O_NONBLOCK);
+      assert(res == 0);
+      assert((ser.fcntl (F_GETFL) & O_NONBLOCK) != 0);
+      res = ser.read (buff, 10);
+      assert(res == -1 && errno == EAGAIN);
+      res = ser.impl ().rx_peek (iov);
+      assert(res == -1 && errno == EAGAIN);
+      res = ser.fcntl (F_SETFL, 0);
+      assert(res == 0);
+      assert((ser.fcntl (F_GETFL) & O_NONBLOCK) == 0);
+
+      struct termios tio;
+      res = ser.tcgetattr (&tio);
+      assert(res == 0);
+      assert(tio.c_cc[VMIN] == 1 && tio.c_cc[VTIME] == 0);
+
+      // Polling (VMIN=0, VTIME=0).
+      tio.c_cc[VMIN] = 0;
+      res = ser.tcsetattr (TCSANOW, &tio);
+      assert(res == 0);
+      res = ser.read (buff, 10);
+      assert(res == 0);
+
+      // Nothing arrived in VTIME (VMIN=0, VTIME>0).
+      tio.c_cc[VTIME] = 1;
+      res = ser.tcsetattr (TCSANOW, &tio);
+      assert(res == 0);
+      res = ser.read (buff, 10);
+      assert(res == 0);
+
+      // At least VMIN bytes, or less if the inter-byte timer expires.
+      tio.c_cc[VMIN] = 4;
+      res = ser.tcsetattr (TCSANOW, &tio);
+      assert(res == 0);
+      res = ser.tcgetattr (&tio);
+      assert(tio.c_cc[VMIN] == 4 && tio.c_cc[VTIME] == 1);
+      ser_drv.inject ("ghij", 4);
+      res = ser.read (buff, 2);
+      assert(res == 2 && memcmp (buff, "gh", 2) == 0);
+      res = ser.read (buff, 10);
+      assert(res == 2 && memcmp (buff, "ij", 2) == 0);
+
+      tio.c_cc[VMIN] = 1;
+      tio.c_cc[VTIME] = 0;
+      res = ser.tcsetattr (TCSANOW, &tio);
+      assert(res == 0);
+
+      // Decode frames in place.
+      struct frames
+      {
+        std::size_t count;
+
+        static void
+        handler (void* arg, const uint8_t*, std::size_t)
+        {
+          ++static_cast<frames*> (arg)->count;
+        }
+      } fr
+        { 0 };
+
+      uint8_t fbuf[8];
+      uint8_t enc[8];
+      posix::slip_codec slip
+        { fbuf, sizeof(fbuf), frames::handler, &fr };
+      std::size_t n = slip.encode ("ab", 2, enc, sizeof(enc));
+      ser_drv.inject (enc, n);
+      assert(ser.impl ().rx_decode (slip) == 1 && fr.count == 1);
+
+      // Without a transmit buffer, send from the user buffer.
+      res = ser.write ("xyz", 3);
+      assert(res == 3);
+      assert(ser_drv.sent_count == 3 && memcmp (ser_drv.sent, "xyz", 3) == 0);
+      assert(ser.tcdrain () == 0);
+
+      res = ser.close ();
+      assert(res == 0);
+    }
+
+  printf ("\n%s - Buffered serial circular - C++ API.\n", test_name);
+    {
+      using event = driver::serial::Event;
+
+      ser_drv.capa.receive_circular = true;
+      res = ser.open ();
+      assert(res >= 0);
+
+      struct iovec iov[2];
+      const char* in = "0123456789abcdefghijklmnopqrstuv";
+
+      // Half complete, then timeout.
+      ser_drv.inject (in, 12);
+      res = ser.impl ().rx_peek (iov);
+      assert(res == 12 && iov[0].iov_len == 12 && iov[1].iov_len == 0);
+      assert(ser.impl ().rx_consume (10) == 0);
+      assert(ser.impl ().rx_consume (3) == -1 && errno == EINVAL);
+
+      // Complete, then timeout; the bytes are split by the wrap.
+      ser_drv.inject (in + 12, 8);
+      res = ser.impl ().rx_peek (iov);
+      assert(res == 10 && iov[0].iov_len == 6 && iov[1].iov_len == 4);
+      assert(memcmp (iov[0].iov_base, "abcdef", 6) == 0);
+      assert(memcmp (iov[1].iov_base, "ghij", 4) == 0);
+      assert(ser.impl ().rx_consume (10) == 0);
+
+      // On overflow, the oldest bytes are dropped.
+      ser_drv.inject (in, 20);
+      res = ser.read (buff, 20);
+      assert(res == 16 && memcmp (buff, in + 4, 16) == 0);
+
+      // The position passed the end before the late complete event.
+      ser_drv.quiet = true;
+      ser_drv.inject (in, 14);
+      ser_drv.signal_event (event::rx_timeout);
+      ser_drv.signal_event (event::receive_complete);
+      res = ser.read (buff, 20);
+      assert(res == 14 && memcmp (buff, in, 14) == 0);
+
+      // A full buffer in a single event; the position did not move.
+      ser_drv.inject (in, 16);
+      ser_drv.signal_event (
+          event::receive_half_complete | event::receive_complete);
+      res = ser.read (buff, 20);
+      assert(res == 16 && memcmp (buff, in, 16) == 0);
+
+      // Overrun: more than a buffer before the late complete event;
+      // the ring is resynchronised with the receiver position.
+      ser_drv.inject (in, 4);
+      ser_drv.signal_event (event::rx_timeout);
+      res = ser.impl ().rx_peek (iov);
+      assert(res == 4);
+      ser_drv.inject (in + 4, 20);
+      ser_drv.signal_event (event::receive_complete);
+      assert(ser.impl ().rx_consume (4) == -1 && errno == EIO);
+      res = ser.read (buff, 20);
+      assert(res == 16 && memcmp (buff, in + 8, 16) == 0);
+      ser_drv.inject (in, 3);
+      ser_drv.signal_event (event::rx_timeout);
+      res = ser.read (buff, 20);
+      assert(res == 3 && memcmp (buff, in, 3) == 0);
+      ser_drv.quiet = false;
+
+      // An overflow drops some of the peeked bytes.
+      ser_drv.inject (in, 8);
+      res = ser.impl ().rx_peek (iov);
+      assert(res == 8);
+      ser_drv.inject (in + 8, 12);
+      assert(ser.impl ().rx_consume (8) == -1 && errno == EIO);
+      res = ser.read (buff, 20);
+      assert(res == 12 && memcmp (buff, in + 8, 12) == 0);
+
+      // Decode in place; an overflow while decoding is reported.
+      struct flood
+      {
+        std::size_t count;
+
+        static void
+        handler (void* arg, const uint8_t*, std::size_t)
+        {
+          flood* f = static_cast<flood*> (arg);
+          if (++f->count == 2)
+            {
+              ser_drv.inject ("0123456789abcdef", 16);
+            }
+        }
+      } fl
+        { 0 };
+
+      uint8_t fbuf[8];
+      uint8_t enc[8];
+      posix::slip_codec slip
+        { fbuf, sizeof(fbuf), flood::handler, &fl };
+      std::size_t n = slip.encode ("ab", 2, enc, sizeof(enc));
+      ser_drv.inject (enc, n);
+      assert(ser.impl ().rx_decode (slip) == 1);
+      ser_drv.inject (enc, n);
+      assert(ser.impl ().rx_decode (slip) == -1 && errno == EIO);
+      assert(fl.count == 2);
+      res = ser.read (buff, 20);
+      assert(res == 16 && memcmp (buff, "0123456789abcdef", 16) == 0);
+
+      res = ser.close ();
+      assert(res == 0);
+      ser_drv.capa.receive_circular = false;
     }
 
 #if defined(OS_IS_CROSS_BUILD) && !defined(OS_USE_SEMIHOSTING_SYSCALLS)